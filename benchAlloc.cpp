@@ -0,0 +1,45 @@
+/***********************************************************************
+ * Source:
+ *    BENCH ALLOC
+ * Summary:
+ *    The allocation counter for the benchmarks. This replaces the global
+ *    operator new and delete for the whole program, so it is empty unless
+ *    BENCHMARK is defined for the whole build, not just in testList.cpp:
+ *       g++ -std=c++14 -O2 -pthread -DBENCHMARK testList.cpp benchAlloc.cpp
+ *    The IDE projects always compile it; add BENCHMARK to the project's
+ *    preprocessor definitions to build the benchmarks there.
+ *    Keeping the replacements out of benchList.h also keeps them out of
+ *    the optimizer's view where new and delete are called, which is what
+ *    set off -Wmismatched-new-delete.
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#ifdef BENCHMARK
+
+#include <atomic>      // for std::atomic
+#include <cstdlib>     // for std::malloc and std::free
+#include <new>         // for std::bad_alloc
+
+/**************************************************
+ * ALLOCATION COUNTER
+ * Every call to the global operator new lands here,
+ * and so does every slot the node pool hands out
+ **************************************************/
+std::atomic<size_t> & benchAllocations()
+{
+   static std::atomic<size_t> count(0);
+   return count;
+}
+
+void * operator new(size_t size)
+{
+   benchAllocations().fetch_add(1, std::memory_order_relaxed);
+   if (void * p = std::malloc(size ? size : 1))
+      return p;
+   throw std::bad_alloc();
+}
+void operator delete(void * p) noexcept         { std::free(p); }
+void operator delete(void * p, size_t) noexcept { std::free(p); }
+
+#endif // BENCHMARK
@@ -0,0 +1,1484 @@
+/***********************************************************************
+ * Header:
+ *    BENCH LIST
+ * Summary:
+ *    Benchmarks for list. Every operation is timed for custom::list
+ *    and for std::list, std::deque, and std::vector so that each change
+ *    to list.h can be measured against the same baseline.
+ *
+ *    The results are written to stdout as CSV, one row per case:
+ *       container,type,operation,size,ns_per_op,allocs_per_op,peak_rss_kb
+ *    peak_rss_kb is the high-water mark of the process so far, so it
+ *    only grows from one row to the next.
+ *
+ *    Build an optimized binary with BENCHMARK defined, and link in
+ *    benchAlloc.cpp for the allocation counter, for example:
+ *       g++ -std=c++14 -O2 -pthread -DBENCHMARK testList.cpp benchAlloc.cpp -o benchList
+ *    Define BENCH_MAX_SIZE to stop the sizes short of ten million.
+ *    Build once more with LIST_CACHE_ALIGNED defined to compare the
+ *    ping_pong rows: they are named .../aligned in that build. Build
+ *    with LIST_POOL defined to measure custom::list with pooled nodes.
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include <atomic>      // for std::atomic
+#include <cstddef>     // for size_t
+
+/**************************************************
+ * ALLOCATION COUNTER
+ * Defined in benchAlloc.cpp. The global operator new
+ * counts one for every call, and the node pool counts
+ * one for every slot it hands out, so custom::list is
+ * charged for its nodes just as std::list is. The pool
+ * only sees the hook if this comes before it.
+ **************************************************/
+std::atomic<size_t> & benchAllocations();
+
+#ifdef POOL_COUNT_ALLOCATE
+#error "include benchList.h before the other list headers"
+#endif
+#define POOL_COUNT_ALLOCATE(num) benchAllocations().fetch_add(num, std::memory_order_relaxed)
+
+#include "list.h"
+#include "concurrentList.h"
+#include "lockFreeQueue.h"
+#include "rcuList.h"
+#include "parallelList.h"
+#include "shardedList.h"
+#include "indexedList.h"
+#include "sortedList.h"
+#include "listSimd.h"
+#include "splitList.h"
+#include <list>
+#include <deque>
+#include <vector>
+#include <string>
+#include <sstream>     // for std::stringstream
+#include <iterator>    // for std::istream_iterator
+#include <algorithm>   // for std::sort and std::shuffle
+#include <random>      // for std::mt19937
+#include <chrono>      // for std::chrono::steady_clock
+#include <mutex>       // for std::mutex
+#include <thread>      // for std::thread
+#include <iostream>    // for std::cout
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifndef BENCH_MAX_SIZE
+#define BENCH_MAX_SIZE 10000000
+#endif
+
+/**************************************************
+ * BENCH RECORD
+ * The large struct payload: 256 bytes with a key
+ **************************************************/
+struct BenchRecord
+{
+   BenchRecord() : key(0) { }
+   BenchRecord(unsigned int key) : key(key)
+   {
+      for (int i = 0; i < (int)sizeof(pad); i++)
+         pad[i] = (char)(key + i);
+   }
+   bool operator < (const BenchRecord & rhs) const { return key < rhs.key; }
+
+   unsigned int key;
+   char pad[252];
+};
+
+/**************************************************
+ * BENCH TWO LOCK QUEUE
+ * A queue over one custom::list with a lock for each
+ * end. The producer calls push_back under the tail
+ * lock and the consumer calls pop_front under the head
+ * lock, so the two threads write the front and the
+ * back of the same list at once. The consumer also
+ * takes the tail lock when fewer than two items are
+ * left, since then both ends touch the same node.
+ *
+ * Without LIST_CACHE_ALIGNED the list has one count
+ * which both ends write. Here it is written with no
+ * lock in common, so it is not to be trusted after a
+ * run; the queue keeps its own counts instead. That
+ * shared count is part of what the aligned build
+ * takes away.
+ **************************************************/
+template <typename T>
+class BenchTwoLockQueue
+{
+public:
+   BenchTwoLockQueue() : numPopped(0), numPushed(0) { }
+
+   void push_back(const T & data)
+   {
+      std::lock_guard<std::mutex> guard(tailLock);
+      items.push_back(data);
+      numPushed.store(numPushed.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_release);
+   }
+
+   bool pop_front(T & data)
+   {
+      std::lock_guard<std::mutex> guard(headLock);
+      size_t available = numPushed.load(std::memory_order_acquire) - numPopped;
+      if (available == 0)
+         return false;
+      if (available < 2)
+      {
+         std::lock_guard<std::mutex> guardTail(tailLock);
+         data = items.front();
+         items.pop_front();
+      }
+      else
+      {
+         data = items.front();
+         items.pop_front();
+      }
+      numPopped++;
+      return true;
+   }
+
+private:
+   // the queue's own state gets whole lines, so only the list's
+   // layout differs between the two builds
+   alignas(64) std::mutex headLock;    // guards the front of items
+   size_t numPopped;                   // only the consumer side
+   alignas(64) custom::list<T> items;
+   alignas(64) std::mutex tailLock;    // guards the back of items
+   std::atomic<size_t> numPushed;      // only the producer writes it
+};
+
+/**************************************************
+ * BENCH VALUE
+ * Make the i-th element. The keys are scrambled so
+ * sorting has some work to do.
+ **************************************************/
+template <typename T>
+struct BenchValue;
+
+template <>
+struct BenchValue <int>
+{
+   static const char * name() { return "int"; }
+   static int make(size_t i) { return (int)((i * 2654435761u) & 0x7fffffff); }
+};
+
+template <>
+struct BenchValue <std::string>
+{
+   static const char * name() { return "string"; }
+   static std::string make(size_t i)
+   {  // long enough to defeat the small string optimization
+      return std::to_string((i * 2654435761u) & 0x7fffffff) + "-benchmark-payload-text";
+   }
+};
+
+template <>
+struct BenchValue <BenchRecord>
+{
+   static const char * name() { return "record256"; }
+   static BenchRecord make(size_t i) { return BenchRecord((unsigned int)(i * 2654435761u)); }
+};
+
+/**************************************************
+ * BENCH TRAITS
+ * What each container can do
+ **************************************************/
+template <class Container>
+struct BenchTraits
+{
+   static const bool pushFront = true;
+   static const bool sort      = true;
+};
+
+template <typename T>
+struct BenchTraits <std::vector<T>>
+{
+   static const bool pushFront = false;
+   static const bool sort      = true;
+};
+
+template <typename T>
+struct BenchTraits <custom::list<T>>
+{
+   static const bool pushFront = true;
+   static const bool sort      = true;
+};
+
+/**************************************************
+ * BENCH LIST
+ * Time every operation on every container
+ **************************************************/
+class BenchList
+{
+public:
+   void run()
+   {
+      std::cout << "container,type,operation,size,ns_per_op,allocs_per_op,peak_rss_kb\n";
+
+      for (size_t size = 10; size <= BENCH_MAX_SIZE; size *= 10)
+      {
+         runType <int>         (size);
+         runType <std::string> (size);
+         runType <BenchRecord> (size);
+      }
+
+      // scanning a list whose nodes are scattered across the heap
+      for (size_t size = 10; size <= BENCH_MAX_SIZE; size *= 10)
+      {
+         runScattered <int>         (size);
+         runScattered <BenchRecord> (size);
+      }
+
+      // one pass over a big list, on one core and on all of them
+      for (size_t size = 100000; size <= BENCH_MAX_SIZE; size *= 10)
+      {
+         runParallel(size);
+         runParallelCopy <std::string> (size);
+         runParallelCopy <BenchRecord> (size);
+         runParallelSort <int>         (size);
+         runParallelSort <std::string> (size);
+      }
+
+      // saving a list and loading it back
+      for (size_t size = 100000; size <= BENCH_MAX_SIZE; size *= 10)
+      {
+         runSerialize <int>         (size);
+         runSerialize <std::string> (size);
+         runSerialize <BenchRecord> (size);
+         runIngest(size);
+         runExport <int>         (size);
+         runExport <std::string> (size);
+         runIndexed(size);
+         runSorted(size);
+         runFinger(size);
+         runSimd(size);
+         runSplit(size);
+      }
+
+      // many threads pushing at the back and popping at the front
+      for (int threads = 1; threads <= 64; threads *= 2)
+         runThreads(threads);
+
+      // the same, but a batch of items for every lock
+      for (int threads = 1; threads <= 64; threads *= 2)
+         runBatched(threads);
+
+      // one producer at the back and one consumer at the front
+      runPingPong();
+
+      // many threads pushing, with one drain at the end
+      for (int threads = 1; threads <= 64; threads *= 2)
+         runPushMany(threads);
+
+      // many readers scanning a list which rarely changes
+      for (int threads = 1; threads <= 64; threads *= 2)
+         runReadMostly(threads);
+
+      // nodes allocated on one thread and freed on another
+      for (int threads = 2; threads <= 64; threads *= 2)
+      {
+         runChurn <custom::list<int>> ("custom::list", threads);
+         runChurn <std::list<int>>    ("std::list",    threads);
+      }
+   }
+
+private:
+   /***************************************
+    * RUN TYPE
+    * Every container holding one type
+    ***************************************/
+   template <typename T>
+   void runType(size_t size)
+   {
+      runContainer <custom::list<T>> ("custom::list", size);
+      runContainer <std::list<T>>    ("std::list",    size);
+      runContainer <std::deque<T>>   ("std::deque",   size);
+      runContainer <std::vector<T>>  ("std::vector",  size);
+   }
+
+   /***************************************
+    * RUN SCATTERED
+    * Scan a custom::list whose nodes were
+    * allocated in random order, with and without
+    * prefetching ahead, then compact it and
+    * scan it again
+    ***************************************/
+   template <typename T>
+   void runScattered(size_t size)
+   {
+      const char * type = BenchValue<T>::name();
+      size_t reps = size < 1000000 ? 1000000 / size : 1;
+      custom::list<T> l;
+      scatter(l, size);
+
+      {
+         size_t sum = 0;
+         Timer timer;
+         for (size_t r = 0; r < reps; r++)
+            for (auto it = l.begin(); it != l.end(); ++it)
+               sum += touch(*it);
+         timer.report("custom::list", type, "scan_scattered", size, reps * size);
+         sink(sum);
+      }
+
+      static const char * names[] =
+         { "scan_prefetch_4", "scan_prefetch_8", "scan_prefetch_16", "scan_prefetch_32" };
+      for (int i = 0; i < 4; i++)
+      {
+         size_t distance = size_t(4) << i;
+         size_t sum = 0;
+         Timer timer;
+         for (size_t r = 0; r < reps; r++)
+            l.for_each_prefetch([&sum](T & value) { sum += touch(value); }, distance);
+         timer.report("custom::list", type, names[i], size, reps * size);
+         sink(sum);
+      }
+
+      // put the nodes back in order and scan again
+      {
+         Timer timer;
+         l.compact();
+         timer.report("custom::list", type, "compact", size, size);
+      }
+      {
+         size_t sum = 0;
+         Timer timer;
+         for (size_t r = 0; r < reps; r++)
+            for (auto it = l.begin(); it != l.end(); ++it)
+               sum += touch(*it);
+         timer.report("custom::list", type, "scan_compacted", size, reps * size);
+         sink(sum);
+      }
+   }
+
+   /***************************************
+    * RUN PARALLEL
+    * Sum a list on one thread, then with
+    * parallel::transform_reduce, counting the
+    * walk that builds the chunk index separately
+    ***************************************/
+   void runParallel(size_t size)
+   {
+      custom::list<int> l;
+      for (size_t i = 0; i < size; i++)
+         l.push_back((int)i);
+      std::string threads = std::to_string(custom::parallel::threadPool::instance().size());
+
+      {
+         size_t sum = 0;
+         Timer timer;
+         for (auto it = l.begin(); it != l.end(); ++it)
+            sum += touch(*it);
+         timer.report("custom::list", "int", "sum_serial", size, size);
+         sink(sum);
+      }
+      {
+         Timer timerIndex;
+         custom::parallel::chunk_index<int> index(l);
+         timerIndex.report("custom::list", "int", "chunk_index", size, size);
+
+         std::string operation = "sum_parallel_" + threads + "_threads";
+         Timer timer;
+         size_t sum = custom::parallel::transform_reduce(index, size_t(0),
+            [](size_t a, size_t b) { return a + b; },
+            [](int & value) { return touch(value); });
+         timer.report("custom::list", "int", operation.c_str(), size, size);
+         sink(sum);
+      }
+   }
+
+   /***************************************
+    * RUN PARALLEL COPY
+    * Deep copy a list with operator = and then
+    * with parallel::copy into an empty list
+    ***************************************/
+   template <typename T>
+   void runParallelCopy(size_t size)
+   {
+      const char * type = BenchValue<T>::name();
+      custom::list<T> src;
+      for (size_t i = 0; i < size; i++)
+         src.push_back(BenchValue<T>::make(i));
+      std::string operation = "copy_parallel_" +
+         std::to_string(custom::parallel::threadPool::instance().size()) + "_threads";
+
+      {
+         custom::list<T> dst;
+         Timer timer;
+         dst = src;
+         timer.report("custom::list", type, "copy_serial", size, size);
+      }
+      {
+         custom::list<T> dst;
+         Timer timer;
+         custom::parallel::copy(src, dst);
+         timer.report("custom::list", type, operation.c_str(), size, size);
+      }
+   }
+
+   /***************************************
+    * RUN SERIALIZE
+    * Save a list to a stream and load it back, first
+    * one item at a time the way callers used to, then
+    * with list::write and list::read
+    ***************************************/
+   template <typename T>
+   void runSerialize(size_t size)
+   {
+      const char * type = BenchValue<T>::name();
+      custom::list<T> src;
+      for (size_t i = 0; i < size; i++)
+         src.push_back(BenchValue<T>::make(i));
+
+      {
+         std::stringstream stream;
+         Timer timerWrite;
+         custom::io::streamSink sink(stream);
+         for (auto it = src.begin(); it != src.end(); ++it)
+            custom::list_serializer<T>::write(sink, *it);
+         timerWrite.report("custom::list", type, "write_each", size, size);
+
+         custom::list<T> dst;
+         custom::io::streamSource source(stream);
+         Timer timerRead;
+         for (size_t i = 0; i < size; i++)
+            dst.push_back(custom::list_serializer<T>::read(source));
+         timerRead.report("custom::list", type, "read_each", size, size);
+      }
+
+      {
+         std::stringstream stream;
+         Timer timerWrite;
+         src.write(stream);
+         timerWrite.report("custom::list", type, "write", size, size);
+
+         custom::list<T> dst;
+         Timer timerRead;
+         dst.read(stream);
+         timerRead.report("custom::list", type, "read", size, size);
+      }
+   }
+
+   /***************************************
+    * RUN EXPORT
+    * Get the items into a vector: by walking the
+    * list the way callers used to, with to_vector,
+    * and by moving them out with drain_to
+    ***************************************/
+   template <typename T>
+   void runExport(size_t size)
+   {
+      const char * type = BenchValue<T>::name();
+      custom::list<T> src;
+      for (size_t i = 0; i < size; i++)
+         src.push_back(BenchValue<T>::make(i));
+
+      {
+         Timer timer;
+         std::vector<T> v;
+         for (auto it = src.begin(); it != src.end(); ++it)
+            v.push_back(*it);
+         timer.report("custom::list", type, "to_vector_each", size, size);
+         sink(v.size());
+      }
+      {
+         Timer timer;
+         std::vector<T> v = src.to_vector();
+         timer.report("custom::list", type, "to_vector", size, size);
+         sink(v.size());
+      }
+      {
+         Timer timer;
+         std::vector<T> v;
+         v.reserve(src.size());
+         src.drain_to(std::back_inserter(v));
+         timer.report("custom::list", type, "drain_to", size, size);
+         sink(v.size());
+      }
+   }
+
+   /***************************************
+    * RUN INDEXED
+    * Read a page of 50 items from a random place:
+    * by walking from the front of a list, and with
+    * iterator_at on an indexed_list. Also what the
+    * tree costs on push_back and on a random insert.
+    ***************************************/
+   void runIndexed(size_t size)
+   {
+      const size_t pageSize = 50;
+      const size_t numWalks = 100;
+      const size_t numPages = 100000;
+      std::mt19937 random(232);
+      std::uniform_int_distribution<size_t> where(0, size - pageSize);
+
+      custom::list<int> l;
+      for (size_t i = 0; i < size; i++)
+         l.push_back(BenchValue<int>::make(i));
+      {
+         Timer timer;
+         long sum = 0;
+         for (size_t page = 0; page < numWalks; page++)
+         {
+            auto it = l.begin();
+            for (size_t i = where(random); i > 0; i--)
+               ++it;
+            for (size_t i = 0; i < pageSize; i++, ++it)
+               sum += *it;
+         }
+         timer.report("custom::list", "int", "page_walk", size, numWalks);
+         sink(sum);
+      }
+
+      custom::indexed_list<int> il;
+      {
+         Timer timer;
+         for (size_t i = 0; i < size; i++)
+            il.push_back(BenchValue<int>::make(i));
+         timer.report("custom::indexed_list", "int", "push_back", size, size);
+      }
+      {
+         Timer timer;
+         long sum = 0;
+         for (size_t page = 0; page < numPages; page++)
+         {
+            auto it = il.iterator_at(where(random));
+            for (size_t i = 0; i < pageSize; i++, ++it)
+               sum += *it;
+         }
+         timer.report("custom::indexed_list", "int", "page_at", size, numPages);
+         sink(sum);
+      }
+      {
+         Timer timer;
+         for (size_t i = 0; i < numPages; i++)
+            il.insert(il.iterator_at(where(random)), (int)i);
+         timer.report("custom::indexed_list", "int", "insert_at", size, numPages);
+         sink(il.size());
+      }
+   }
+
+   /***************************************
+    * RUN SORTED
+    * Look up random keys in sorted ints: by walking
+    * a sorted list from pHead, and with find on a
+    * sorted_list. Also what it costs to build the
+    * sorted_list from keys in random order.
+    ***************************************/
+   void runSorted(size_t size)
+   {
+      const size_t numScans = 100;
+      const size_t numFinds = 100000;
+      std::mt19937 random(232);
+      std::uniform_int_distribution<int> key(0, (int)size * 2);
+
+      custom::list<int> l;
+      for (size_t i = 0; i < size; i++)
+         l.push_back((int)i * 2);
+      {
+         Timer timer;
+         size_t numFound = 0;
+         for (size_t i = 0; i < numScans; i++)
+         {
+            int target = key(random);
+            auto it = l.begin();
+            while (it != l.end() && *it < target)
+               ++it;
+            numFound += (it != l.end() && *it == target);
+         }
+         timer.report("custom::list", "int", "find_scan", size, numScans);
+         sink(numFound);
+      }
+
+      std::vector<int> keys;
+      for (size_t i = 0; i < size; i++)
+         keys.push_back((int)i * 2);
+      std::shuffle(keys.begin(), keys.end(), random);
+      custom::sorted_list<int> sl;
+      {
+         Timer timer;
+         for (size_t i = 0; i < size; i++)
+            sl.insert(keys[i]);
+         timer.report("custom::sorted_list", "int", "insert", size, size);
+      }
+      {
+         Timer timer;
+         size_t numFound = 0;
+         for (size_t i = 0; i < numFinds; i++)
+            numFound += sl.contains(key(random));
+         timer.report("custom::sorted_list", "int", "find", size, numFinds);
+         sink(numFound);
+      }
+   }
+
+   /***************************************
+    * RUN FINGER
+    * Editor-style access: every position in turn,
+    * then a random walk a few lines at a time. The
+    * walk from pHead each time is what callers did
+    * before at(), so it is only timed for a few.
+    ***************************************/
+   void runFinger(size_t size)
+   {
+      const size_t numWalks = 100;
+      const size_t numSteps = 1000000;
+      std::mt19937 random(232);
+      std::uniform_int_distribution<int> step(-8, 8);
+
+      custom::list<int> l;
+      for (size_t i = 0; i < size; i++)
+         l.push_back(BenchValue<int>::make(i));
+      {
+         Timer timer;
+         long sum = 0;
+         size_t line = size / 2;
+         for (size_t i = 0; i < numWalks; i++)
+         {
+            line = (line + size + step(random)) % size;
+            auto it = l.begin();
+            for (size_t j = 0; j < line; j++)
+               ++it;
+            sum += *it;
+         }
+         timer.report("custom::list", "int", "nearby_walk_head", size, numWalks);
+         sink(sum);
+      }
+      {
+         Timer timer;
+         long sum = 0;
+         for (size_t i = 0; i < size; i++)
+            sum += l.at(i);
+         timer.report("custom::list", "int", "at_sequential", size, size);
+         sink(sum);
+      }
+      {
+         Timer timer;
+         long sum = 0;
+         size_t line = size / 2;
+         for (size_t i = 0; i < numSteps; i++)
+         {
+            line = (line + size + step(random)) % size;
+            sum += l.at(line);
+         }
+         timer.report("custom::list", "int", "at_nearby", size, numSteps);
+         sink(sum);
+      }
+   }
+
+   /***************************************
+    * RUN SIMD
+    * A filter scan (count the matches) and a sum over
+    * ints: on an array at every simd level, then on a
+    * list with a plain loop and with simd::count
+    ***************************************/
+   void runSimd(size_t size)
+   {
+      static const char * levels[] = { "scalar", "sse2", "avx2" };
+      std::vector<int> v;
+      custom::list<int> l;
+      for (size_t i = 0; i < size; i++)
+      {
+         v.push_back(BenchValue<int>::make(i) % 100);
+         l.push_back(v.back());
+      }
+
+      for (int now = custom::simd::SCALAR; now <= custom::simd::detect(); now++)
+      {
+         custom::simd::use((custom::simd::level)now);
+         std::string count = std::string("count_") + levels[now];
+         std::string sum = std::string("sum_") + levels[now];
+         {
+            Timer timer;
+            size_t num = custom::simd::count(v.data(), v.size(), 42);
+            timer.report("std::vector", "int", count.c_str(), size, size);
+            sink(num);
+         }
+         {
+            Timer timer;
+            int total = custom::simd::sum(v.data(), v.size());
+            timer.report("std::vector", "int", sum.c_str(), size, size);
+            sink(total);
+         }
+      }
+      custom::simd::use(custom::simd::AVX2);
+
+      {
+         Timer timer;
+         size_t num = 0;
+         for (auto it = l.begin(); it != l.end(); ++it)
+            num += (*it == 42);
+         timer.report("custom::list", "int", "count_loop", size, size);
+         sink(num);
+      }
+      {
+         Timer timer;
+         size_t num = custom::simd::count(l, 42);
+         timer.report("custom::list", "int", "simd::count", size, size);
+         sink(num);
+      }
+   }
+
+   /***************************************
+    * RUN SPLIT
+    * 256 byte records in list and in split_list:
+    * walks that only follow the links (counting,
+    * reversing) and a walk that reads every key
+    ***************************************/
+   void runSplit(size_t size)
+   {
+      custom::list<BenchRecord> l;
+      custom::split_list<BenchRecord> s;
+      for (size_t i = 0; i < size; i++)
+      {
+         l.push_back(BenchValue<BenchRecord>::make(i));
+         s.push_back(BenchValue<BenchRecord>::make(i));
+      }
+
+      {
+         Timer timer;
+         size_t num = 0;
+         for (auto it = l.begin(); it != l.end(); ++it)
+            num++;
+         timer.report("custom::list", "record256", "walk_links", size, size);
+         sink(num);
+      }
+      {
+         Timer timer;
+         size_t num = s.recount();
+         timer.report("custom::split_list", "record256", "walk_links", size, size);
+         sink(num);
+      }
+      {
+         Timer timer;
+         s.reverse();
+         timer.report("custom::split_list", "record256", "reverse", size, size);
+         sink(s.size());
+      }
+      {
+         Timer timer;
+         size_t sum = 0;
+         for (auto it = l.begin(); it != l.end(); ++it)
+            sum += (*it).key;
+         timer.report("custom::list", "record256", "sum_keys", size, size);
+         sink(sum);
+      }
+      {
+         Timer timer;
+         size_t sum = 0;
+         for (auto it = s.begin(); it != s.end(); ++it)
+            sum += (*it).key;
+         timer.report("custom::split_list", "record256", "sum_keys", size, size);
+         sink(sum);
+      }
+   }
+
+   /***************************************
+    * RUN INGEST
+    * Parse a list of numbers out of text, first with
+    * the iterator constructor and then with
+    * parallel::ingest reading on a second thread
+    ***************************************/
+   void runIngest(size_t size)
+   {
+      std::string text;
+      for (size_t i = 0; i < size; i++)
+         text += std::to_string(BenchValue<int>::make(i)) + ' ';
+
+      {
+         std::stringstream stream(text);
+         Timer timer;
+         custom::list<int> l(std::istream_iterator<int>(stream), (std::istream_iterator<int>()));
+         timer.report("custom::list", "int", "ingest_each", size, size);
+         sink(l.size());
+      }
+
+      {
+         std::stringstream stream(text);
+         Timer timer;
+         custom::list<int> l;
+         custom::parallel::ingest(l, std::istream_iterator<int>(stream), std::istream_iterator<int>());
+         timer.report("custom::list", "int", "ingest_pipeline", size, size);
+         sink(l.size());
+      }
+   }
+
+   /***************************************
+    * RUN PARALLEL SORT
+    * Sort the same shuffled list with list::sort and
+    * then with parallel::sort cut into 1, 2, 4 ...
+    * pieces, up to one per thread in the pool. No
+    * more than one thread works on a piece, so the
+    * pieces are the number of cores in use.
+    ***************************************/
+   template <typename T>
+   void runParallelSort(size_t size)
+   {
+      const char * type = BenchValue<T>::name();
+      custom::list<T> src;
+      for (size_t i = 0; i < size; i++)
+         src.push_back(BenchValue<T>::make(i));
+
+      // every copy is compacted first so they all start from the same layout
+      {
+         custom::list<T> l(src);
+         l.compact();
+         Timer timer;
+         l.sort();
+         timer.report("custom::list", type, "sort", size, size);
+      }
+
+      size_t threads = custom::parallel::threadPool::instance().size();
+      for (size_t pieces = 1; pieces <= threads; pieces *= 2)
+      {
+         custom::list<T> l(src);
+         l.compact();
+         std::string operation = "sort_parallel_" + std::to_string(pieces) + "_threads";
+         Timer timer;
+         custom::parallel::sort(l, std::less<T>(), pieces);
+         timer.report("custom::list", type, operation.c_str(), size, size);
+      }
+   }
+
+   /***************************************
+    * RUN THREADS
+    * Every thread pushes at the back and pops at
+    * the front. custom::list needs one mutex around
+    * every call; concurrent_list locks per node and
+    * lockfree_queue takes no locks at all.
+    ***************************************/
+   void runThreads(int threads)
+   {
+      const size_t opsPerThread = 200000;
+      std::string operation = "push_pop_" + std::to_string(threads) + "_threads";
+
+      {
+         custom::list<int> l;
+         std::mutex lock;
+         Timer timer;
+         inThreads(threads, [&]()
+         {
+            for (size_t i = 0; i < opsPerThread; i++)
+            {
+               {
+                  std::lock_guard<std::mutex> guard(lock);
+                  l.push_back((int)i);
+               }
+               std::lock_guard<std::mutex> guard(lock);
+               if (!l.empty())
+                  l.pop_front();
+            }
+         });
+         timer.report("custom::list+mutex", "int", operation.c_str(),
+                      threads * opsPerThread, threads * opsPerThread * 2);
+      }
+
+      {
+         custom::concurrent_list<int> l;
+         Timer timer;
+         inThreads(threads, [&]()
+         {
+            int data;
+            for (size_t i = 0; i < opsPerThread; i++)
+            {
+               l.push_back((int)i);
+               l.pop_front(data);
+            }
+         });
+         timer.report("custom::concurrent_list", "int", operation.c_str(),
+                      threads * opsPerThread, threads * opsPerThread * 2);
+      }
+
+      {
+         custom::lockfree_queue<int> q;
+         Timer timer;
+         inThreads(threads, [&]()
+         {
+            int data;
+            for (size_t i = 0; i < opsPerThread; i++)
+            {
+               q.push_back((int)i);
+               q.pop_front(data);
+            }
+         });
+         timer.report("custom::lockfree_queue", "int", operation.c_str(),
+                      threads * opsPerThread, threads * opsPerThread * 2);
+      }
+   }
+
+   /***************************************
+    * RUN BATCHED
+    * Like runThreads, but every thread pushes and
+    * pops a batch at a time, so a lock is taken once
+    * per batch rather than once per item.
+    ***************************************/
+   void runBatched(int threads)
+   {
+      const size_t batchSize = 256;
+      const size_t opsPerThread = batchSize * 800;
+      std::string operation = "push_pop_batch_" + std::to_string(threads) + "_threads";
+
+      {
+         custom::list<int> l;
+         std::mutex lock;
+         Timer timer;
+         inThreads(threads, [&]()
+         {
+            std::vector<int> batch(batchSize);
+            std::vector<int> out(batchSize);
+            for (size_t i = 0; i < opsPerThread; i += batchSize)
+            {
+               {
+                  std::lock_guard<std::mutex> guard(lock);
+                  l.push_back_bulk(batch.begin(), batch.end());
+               }
+               std::lock_guard<std::mutex> guard(lock);
+               l.pop_front_bulk(out.begin(), batchSize);
+            }
+         });
+         timer.report("custom::list+mutex", "int", operation.c_str(),
+                      threads * opsPerThread, threads * opsPerThread * 2);
+      }
+
+      {
+         custom::concurrent_list<int> l;
+         Timer timer;
+         inThreads(threads, [&]()
+         {
+            std::vector<int> batch(batchSize);
+            std::vector<int> out(batchSize);
+            for (size_t i = 0; i < opsPerThread; i += batchSize)
+            {
+               l.push_back_bulk(batch.begin(), batch.end());
+               l.pop_front_bulk(out.begin(), batchSize);
+            }
+         });
+         timer.report("custom::concurrent_list", "int", operation.c_str(),
+                      threads * opsPerThread, threads * opsPerThread * 2);
+      }
+   }
+
+   /***************************************
+    * RUN PING PONG
+    * One thread pushes at the back while another
+    * pops at the front, each end under its own lock.
+    * This is where the head and the tail sharing a
+    * cache line hurts, so the rows say which layout
+    * was built.
+    ***************************************/
+   void runPingPong()
+   {
+      const size_t items = 1000000;
+#ifdef LIST_CACHE_ALIGNED
+      const char * layout = "/aligned";
+#else
+      const char * layout = "";
+#endif // LIST_CACHE_ALIGNED
+
+      {
+         BenchTwoLockQueue<int> q;
+         Timer timer;
+         std::thread consumer([&]()
+         {
+            int data;
+            for (size_t popped = 0; popped < items; )
+               if (q.pop_front(data))
+                  popped++;
+         });
+         for (size_t i = 0; i < items; i++)
+            q.push_back((int)i);
+         consumer.join();
+         timer.report((std::string("custom::list+two_locks") + layout).c_str(), "int",
+                      "ping_pong", items, items);
+      }
+
+      {
+         custom::concurrent_list<int> l;
+         Timer timer;
+         std::thread consumer([&]()
+         {
+            int data;
+            for (size_t popped = 0; popped < items; )
+               if (l.pop_front(data))
+                  popped++;
+         });
+         for (size_t i = 0; i < items; i++)
+            l.push_back((int)i);
+         consumer.join();
+         timer.report((std::string("custom::concurrent_list") + layout).c_str(), "int",
+                      "ping_pong", items, items);
+      }
+   }
+
+   /***************************************
+    * RUN PUSH MANY
+    * Every thread pushes to one shared collection,
+    * and then everything is drained into one list.
+    * The drain is inside the timing.
+    ***************************************/
+   void runPushMany(int threads)
+   {
+      const size_t opsPerThread = 200000;
+      std::string operation = "push_" + std::to_string(threads) + "_threads";
+
+      {
+         custom::list<int> l;
+         std::mutex lock;
+         Timer timer;
+         inThreads(threads, [&]()
+         {
+            for (size_t i = 0; i < opsPerThread; i++)
+            {
+               std::lock_guard<std::mutex> guard(lock);
+               l.push_back((int)i);
+            }
+         });
+         custom::list<int> all(std::move(l));
+         timer.report("custom::list+mutex", "int", operation.c_str(),
+                      threads * opsPerThread, threads * opsPerThread);
+         sink(all.size());
+      }
+
+      {
+         custom::sharded_list<int> l;
+         Timer timer;
+         inThreads(threads, [&]()
+         {
+            for (size_t i = 0; i < opsPerThread; i++)
+               l.push_back((int)i);
+         });
+         custom::list<int> all = l.drain();
+         timer.report("custom::sharded_list", "int", operation.c_str(),
+                      threads * opsPerThread, threads * opsPerThread);
+         sink(all.size());
+      }
+   }
+
+   /***************************************
+    * RUN READ MOSTLY
+    * Every thread scans a 1000 item list over and
+    * over while one more thread changes it now and
+    * then. custom::list needs the mutex for every
+    * scan; rcu_list readers take no lock.
+    ***************************************/
+   void runReadMostly(int threads)
+   {
+      const size_t size = 1000;
+      const size_t scansPerThread = 2000;
+      std::string operation = "read_scan_" + std::to_string(threads) + "_threads";
+
+      {
+         custom::list<int> l;
+         std::mutex lock;
+         for (size_t i = 0; i < size; i++)
+            l.push_back((int)i);
+         std::atomic<bool> done(false);
+         std::thread writer([&]()
+         {
+            for (int i = 0; !done; i++)
+            {
+               {
+                  std::lock_guard<std::mutex> guard(lock);
+                  l.push_back(i);
+                  l.pop_front();
+               }
+               std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+         });
+         Timer timer;
+         inThreads(threads, [&]()
+         {
+            size_t sum = 0;
+            for (size_t r = 0; r < scansPerThread; r++)
+            {
+               std::lock_guard<std::mutex> guard(lock);
+               for (auto it = l.begin(); it != l.end(); ++it)
+                  sum += *it;
+            }
+            sink(sum);
+         });
+         timer.report("custom::list+mutex", "int", operation.c_str(),
+                      size, threads * scansPerThread * size);
+         done = true;
+         writer.join();
+      }
+
+      {
+         custom::rcu_list<int> l;
+         for (size_t i = 0; i < size; i++)
+            l.push_back((int)i);
+         std::atomic<bool> done(false);
+         std::thread writer([&]()
+         {
+            for (int i = 0; !done; i++)
+            {
+               l.push_back((int)size + i);
+               l.remove(i);
+               std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+         });
+         Timer timer;
+         inThreads(threads, [&]()
+         {
+            size_t sum = 0;
+            for (size_t r = 0; r < scansPerThread; r++)
+               l.for_each([&sum](const int & value) { sum += value; });
+            sink(sum);
+         });
+         timer.report("custom::rcu_list", "int", operation.c_str(),
+                      size, threads * scansPerThread * size);
+         done = true;
+         writer.join();
+      }
+   }
+
+   /***************************************
+    * RUN CHURN
+    * Half the threads are producers and half are
+    * consumers, in pairs sharing one list and one
+    * mutex. Every node is allocated by a producer
+    * and freed by its consumer, so the pairs only
+    * contend with each other in the allocator.
+    ***************************************/
+   template <class Container>
+   void runChurn(const char * container, int threads)
+   {
+      const size_t opsPerPair = 200000;
+      int pairs = threads / 2;
+      std::string operation = "churn_" + std::to_string(threads) + "_threads";
+
+      std::vector<Container> lists(pairs);
+      std::vector<std::mutex> locks(pairs);
+      std::atomic<int> next(0);
+      Timer timer;
+      inThreads(threads, [&]()
+      {
+         int id = next++;
+         Container & l = lists[id / 2];
+         std::mutex & lock = locks[id / 2];
+         if (id % 2 == 0)
+         {
+            for (size_t i = 0; i < opsPerPair; i++)
+            {
+               std::lock_guard<std::mutex> guard(lock);
+               l.push_back((int)i);
+            }
+         }
+         else
+         {
+            for (size_t popped = 0; popped < opsPerPair; )
+            {
+               {
+                  std::lock_guard<std::mutex> guard(lock);
+                  if (!l.empty())
+                  {
+                     l.pop_front();
+                     popped++;
+                     continue;
+                  }
+               }
+               std::this_thread::yield();
+            }
+         }
+      });
+      timer.report(container, "int", operation.c_str(),
+                   pairs * opsPerPair, pairs * opsPerPair * 2);
+   }
+
+   // run f on this many threads at once and wait for them all
+   template <class Function>
+   static void inThreads(int threads, Function f)
+   {
+      std::vector<std::thread> workers;
+      for (int t = 0; t < threads; t++)
+         workers.emplace_back(f);
+      for (auto & worker : workers)
+         worker.join();
+   }
+
+   /***************************************
+    * RUN CONTAINER
+    * Every operation on one container
+    ***************************************/
+   template <class Container>
+   void runContainer(const char * container, size_t size)
+   {
+      typedef typename std::decay<decltype(*Container().begin())>::type T;
+      typedef BenchValue<T> Value;
+      const char * type = Value::name();
+
+      // small sizes are repeated so each row times about a million operations
+      size_t reps = size < 1000000 ? 1000000 / size : 1;
+
+      // a few operations in the middle of a full container
+      size_t few = std::max(size_t(1), std::min(size / 2, size_t(1000)));
+
+      // push_back and push_front into an empty container
+      {
+         Timer timer;
+         for (size_t r = 0; r < reps; r++)
+         {
+            Container c;
+            for (size_t i = 0; i < size; i++)
+               c.push_back(Value::make(i));
+         }
+         timer.report(container, type, "push_back", size, reps * size);
+      }
+      pushFront(container, type, size, reps,
+                std::integral_constant<bool, BenchTraits<Container>::pushFront>(),
+                (Container *)nullptr);
+
+      // insert through an iterator in the middle
+      {
+         Timer timer(false);
+         for (size_t r = 0; r < reps; r++)
+         {
+            Container c;
+            fill(c, size);
+            auto it = middle(c, size);
+            timer.start();
+            for (size_t i = 0; i < few; i++)
+               it = c.insert(it, Value::make(i));
+            timer.stop();
+         }
+         timer.report(container, type, "insert_middle", size, reps * few);
+      }
+
+      // erase through an iterator in the middle
+      {
+         Timer timer(false);
+         for (size_t r = 0; r < reps; r++)
+         {
+            Container c;
+            fill(c, size);
+            auto it = middle(c, size);
+            timer.start();
+            for (size_t i = 0; i < few; i++)
+               it = c.erase(it);
+            timer.stop();
+         }
+         timer.report(container, type, "erase_middle", size, reps * few);
+      }
+
+      // traverse, copy, move, and clear all share one source
+      Container c;
+      fill(c, size);
+      {
+         size_t sum = 0;
+         Timer timer;
+         for (size_t r = 0; r < reps; r++)
+            for (auto it = c.begin(); it != c.end(); ++it)
+               sum += touch(*it);
+         timer.report(container, type, "traverse", size, reps * size);
+         sink(sum);
+      }
+      {
+         Timer timer(false);
+         for (size_t r = 0; r < reps; r++)
+         {
+            timer.start();
+            Container copy(c);
+            timer.stop();
+         }
+         timer.report(container, type, "copy", size, reps * size);
+      }
+      {
+         Timer timer(false);
+         for (size_t r = 0; r < reps; r++)
+         {
+            Container from(c);
+            timer.start();
+            Container to(std::move(from));
+            timer.stop();
+         }
+         timer.report(container, type, "move", size, reps);
+      }
+      {
+         Timer timer(false);
+         for (size_t r = 0; r < reps; r++)
+         {
+            Container copy(c);
+            timer.start();
+            copy.clear();
+            timer.stop();
+         }
+         timer.report(container, type, "clear", size, reps * size);
+      }
+      sort(container, type, size, reps, c,
+           std::integral_constant<bool, BenchTraits<Container>::sort>());
+   }
+
+   /***************************************
+    * TIMER
+    * Accumulate time and allocations between
+    * start() and stop(), then write one row
+    ***************************************/
+   class Timer
+   {
+   public:
+      Timer(bool running = true) : ns(0), allocations(0), running(false)
+      {
+         if (running)
+            start();
+      }
+      void start()
+      {
+         running = true;
+         allocationsStart = benchAllocations().load();
+         begin = std::chrono::steady_clock::now();
+      }
+      void stop()
+      {
+         auto end = std::chrono::steady_clock::now();
+         running = false;
+         ns += std::chrono::duration<double, std::nano>(end - begin).count();
+         allocations += benchAllocations().load() - allocationsStart;
+      }
+      void report(const char * container, const char * type, const char * operation,
+                  size_t size, size_t ops)
+      {
+         if (ops == 0)
+            return;
+         if (running)
+            stop();
+         std::cout << container << ',' << type << ',' << operation << ','
+                   << size << ','
+                   << ns / (double)ops << ','
+                   << (double)allocations / (double)ops << ','
+                   << peakRssKb() << '\n';
+         std::cout.flush();
+      }
+   private:
+      std::chrono::steady_clock::time_point begin;
+      double ns;
+      size_t allocations;
+      size_t allocationsStart;
+      bool running;
+   };
+
+   /***************************************
+    * HELPERS
+    ***************************************/
+   template <class Container>
+   static void fill(Container & c, size_t size)
+   {
+      typedef typename std::decay<decltype(*c.begin())>::type T;
+      for (size_t i = 0; i < size; i++)
+         c.push_back(BenchValue<T>::make(i));
+   }
+
+   // fill a list whose nodes sit in random order in memory: build a
+   // list, free its nodes in shuffled order, then build another one
+   // out of the freed nodes
+   template <typename T>
+   static void scatter(custom::list<T> & l, size_t size)
+   {
+      custom::list<T> donor;
+      fill(donor, size);
+      std::vector<typename custom::list<T>::iterator> nodes;
+      nodes.reserve(size);
+      for (auto it = donor.begin(); it != donor.end(); ++it)
+         nodes.push_back(it);
+      std::shuffle(nodes.begin(), nodes.end(), std::mt19937(232));
+      for (size_t i = 0; i < nodes.size(); i++)
+         donor.erase(nodes[i]);
+      fill(l, size);
+   }
+
+   template <class Container>
+   static typename Container::iterator middle(Container & c, size_t size)
+   {
+      auto it = c.begin();
+      for (size_t i = 0; i < size / 2; i++)
+         ++it;
+      return it;
+   }
+
+   template <class Container>
+   void pushFront(const char * container, const char * type, size_t size, size_t reps,
+                  std::true_type, Container *)
+   {
+      typedef typename std::decay<decltype(*Container().begin())>::type T;
+      Timer timer;
+      for (size_t r = 0; r < reps; r++)
+      {
+         Container c;
+         for (size_t i = 0; i < size; i++)
+            c.push_front(BenchValue<T>::make(i));
+      }
+      timer.report(container, type, "push_front", size, reps * size);
+   }
+
+   template <class Container>
+   void pushFront(const char *, const char *, size_t, size_t, std::false_type, Container *) { }
+
+   template <typename T>
+   void sortOne(std::list<T> & c)   { c.sort(); }
+   template <typename T>
+   void sortOne(custom::list<T> & c) { c.sort(); }
+   template <class Container>
+   void sortOne(Container & c)      { std::sort(c.begin(), c.end()); }
+
+   template <class Container>
+   void sort(const char * container, const char * type, size_t size, size_t reps,
+             Container & c, std::true_type)
+   {
+      Timer timer(false);
+      for (size_t r = 0; r < reps; r++)
+      {
+         Container copy(c);
+         timer.start();
+         sortOne(copy);
+         timer.stop();
+      }
+      timer.report(container, type, "sort", size, reps * size);
+   }
+
+   template <class Container>
+   void sort(const char *, const char *, size_t, size_t, Container &, std::false_type) { }
+
+   static size_t touch(int value)                   { return (size_t)value;  }
+   static size_t touch(const std::string & value)   { return value.size();   }
+   static size_t touch(const BenchRecord & value)   { return value.key;      }
+
+   // keep the optimizer from discarding a traversal
+   static void sink(size_t value)
+   {
+      static volatile size_t result;
+      result = result + value;
+   }
+
+   /***************************************
+    * PEAK RSS
+    * The high-water mark of the process in KB
+    ***************************************/
+   static long peakRssKb()
+   {
+#ifdef _WIN32
+      PROCESS_MEMORY_COUNTERS counters;
+      if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+         return (long)(counters.PeakWorkingSetSize / 1024);
+      return 0;
+#else
+      struct rusage usage;
+      getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+      return usage.ru_maxrss / 1024;   // macOS reports bytes
+#else
+      return usage.ru_maxrss;          // Linux reports kilobytes
+#endif
+#endif
+   }
+};
+
+#endif // BENCHMARK
@@ -0,0 +1,494 @@
+/***********************************************************************
+ * Header:
+ *    CONCURRENT LIST
+ * Summary:
+ *    A list which many threads can use at once. Every node has its own
+ *    lock, and there is one lock for the head and one for the tail, so
+ *    producers at the back and consumers at the front do not wait on
+ *    each other. Traversals lock hand-over-hand: the next node is locked
+ *    before the current one is let go.
+ *
+ *    The list always starts with a dummy node which holds no item.
+ *    pop_front() turns the first real node into the new dummy, so popping
+ *    never has to touch the tail.
+ *
+ *    Locks are always taken in this order, which is what keeps the list
+ *    free of deadlock:
+ *        head lock, tail lock, then node locks from front to back
+ *
+ *    This will contain the class definition of:
+ *        concurrent_list : A thread-safe singly linked list
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+#include <atomic>      // for std::atomic
+#include <cstddef>     // for ptrdiff_t
+#include <mutex>       // for std::mutex
+#include <new>         // for placement new
+#include <utility>     // for std::move
+#include "nodePool.h"  // for custom::pool
+
+class TestConcurrentList;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/**************************************************
+ * CONCURRENT LIST
+ * A list with fine-grained locking
+ **************************************************/
+template <typename T>
+class concurrent_list
+{
+   friend class ::TestConcurrentList; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   concurrent_list();
+   concurrent_list(const concurrent_list &) = delete;
+   concurrent_list & operator = (const concurrent_list &) = delete;
+  ~concurrent_list();
+
+   //
+   // Insert
+   //
+
+   void push_front(const T &  data) { linkFront(new Node(data));            }
+   void push_front(      T && data) { linkFront(new Node(std::move(data))); }
+   void push_back (const T &  data) { linkBack (new Node(data));            }
+   void push_back (      T && data) { linkBack (new Node(std::move(data))); }
+   template <class Iterator>
+   void push_back_bulk(Iterator first, Iterator last);
+
+   //
+   // Remove
+   //
+
+   bool pop_front(T & data);
+   template <class OutputIterator>
+   size_t pop_front_bulk(OutputIterator out, size_t max_n);
+
+   //
+   // Traverse
+   //
+
+   template <class Function>
+   void for_each(Function f);
+   template <class Predicate>
+   bool find_if(Predicate pred, T & data);
+   bool contains(const T & data);
+
+   //
+   // Status
+   //
+
+   size_t size()  const;
+   bool   empty() const { return size() == 0;                                 }
+
+private:
+   class Node;
+
+   void linkFront(Node * pNew);
+   void linkBack (Node * pNew);
+   void linkBack (Node * pFirst, Node * pLast, size_t num);
+   static void deleteUpTo(Node * pFirst, Node * pStop);
+
+   // The count is kept in two halves so that pushing at the back and
+   // popping at the front never write the same variable: the head side
+   // counts push_front less pop_front, the tail side counts push_back.
+   // With LIST_CACHE_ALIGNED the two sides also sit on their own cache
+   // lines.
+#ifdef LIST_CACHE_ALIGNED
+   char padFront[64];
+#endif // LIST_CACHE_ALIGNED
+   std::mutex headLock;              // guards pHead
+   Node * pHead;                     // the dummy node
+   std::atomic<ptrdiff_t> numHead;   // items pushed at the front less items popped
+#ifdef LIST_CACHE_ALIGNED
+   char padMiddle[64];
+#endif // LIST_CACHE_ALIGNED
+   std::mutex tailLock;              // guards pTail
+   Node * pTail;                     // the last node, or the dummy if empty
+   std::atomic<size_t> numTail;      // items pushed at the back
+#ifdef LIST_CACHE_ALIGNED
+   char padBack[64];
+#endif // LIST_CACHE_ALIGNED
+};
+
+/*************************************************
+ * CONCURRENT LIST NODE
+ * The item lives in raw storage so the dummy node
+ * does not need one
+ *************************************************/
+template <typename T>
+class concurrent_list <T> :: Node
+{
+public:
+   Node()                   : pNext(nullptr), hasData(false) { }
+   Node(const T & data)     : pNext(nullptr), hasData(true)  { new (storage) T(data);            }
+   Node(T && data)          : pNext(nullptr), hasData(true)  { new (storage) T(std::move(data)); }
+  ~Node()                   { if (hasData) this->data().~T();                                     }
+
+   T & data()               { return *reinterpret_cast<T *>(storage); }
+
+   // give up the item, turning this node into a dummy
+   T release()
+   {
+      T data(std::move(this->data()));
+      this->data().~T();
+      hasData = false;
+      return data;
+   }
+
+   static void * operator new   (size_t)      { return pool<sizeof(Node), alignof(Node)>::allocate(); }
+   static void   operator delete(void * p)    { pool<sizeof(Node), alignof(Node)>::free(p);           }
+
+   Node * pNext;       // pointer to next node, guarded by lock
+   std::mutex lock;    // guards pNext and the item
+   bool hasData;       // false for the dummy
+   alignas(T) unsigned char storage[sizeof(T)];
+};
+
+/*****************************************
+ * CONCURRENT LIST :: DEFAULT CONSTRUCTOR
+ * Start with just the dummy
+ ****************************************/
+template <typename T>
+concurrent_list <T> :: concurrent_list() : pHead(new Node), numHead(0), pTail(nullptr), numTail(0)
+{
+   pTail = pHead;
+}
+
+/*********************************************
+ * CONCURRENT LIST :: SIZE
+ * The head side is read first. Every item it has seen
+ * popped was counted on its way in before it could be
+ * popped, so the sum never goes below zero.
+ *    INPUT  :
+ *    OUTPUT : the number of items
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+size_t concurrent_list <T> :: size() const
+{
+   ptrdiff_t head = numHead.load(std::memory_order_acquire);
+   size_t    tail = numTail.load(std::memory_order_acquire);
+   return tail + head;
+}
+
+/*****************************************
+ * CONCURRENT LIST :: DESTRUCTOR
+ * Nobody else may be using the list by now
+ ****************************************/
+template <typename T>
+concurrent_list <T> :: ~concurrent_list()
+{
+   while (pHead)
+   {
+      Node * pDelete = pHead;
+      pHead = pHead->pNext;
+      delete pDelete;
+   }
+}
+
+/*********************************************
+ * CONCURRENT LIST :: LINK BACK
+ * Add an item to the end. Only the tail lock and the
+ * last node are held, so this runs alongside pop_front.
+ *    INPUT  : a node holding the item
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void concurrent_list <T> :: linkBack(Node * pNew)
+{
+   // count it first so a racing pop_front can never take the size below zero
+   numTail.fetch_add(1, std::memory_order_release);
+
+   std::lock_guard<std::mutex> guardTail(tailLock);
+   {
+      std::lock_guard<std::mutex> guardNode(pTail->lock);
+      pTail->pNext = pNew;
+   }
+   pTail = pNew;
+}
+
+/*********************************************
+ * CONCURRENT LIST :: LINK BACK - CHAIN
+ * Add a whole chain to the end while holding the tail
+ * lock just once
+ *    INPUT  : the ends of a chain and how many nodes it has
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void concurrent_list <T> :: linkBack(Node * pFirst, Node * pLast, size_t num)
+{
+   numTail.fetch_add(num, std::memory_order_release);
+
+   std::lock_guard<std::mutex> guardTail(tailLock);
+   {
+      std::lock_guard<std::mutex> guardNode(pTail->lock);
+      pTail->pNext = pFirst;
+   }
+   pTail = pLast;
+}
+
+/*********************************************
+ * CONCURRENT LIST :: PUSH BACK BULK
+ * Add a range of items to the end. The nodes are built
+ * before any lock is taken, so the other threads only
+ * wait for one relink however long the range is.
+ *    INPUT  : the range of items to add
+ *    OUTPUT :
+ *    COST   : O(n) with respect to the range
+ *********************************************/
+template <typename T>
+template <class Iterator>
+void concurrent_list <T> :: push_back_bulk(Iterator first, Iterator last)
+{
+   Node * pFirst = nullptr;
+   Node * pLast = nullptr;
+   size_t num = 0;
+   try
+   {
+      for (; first != last; ++first, num++)
+      {
+         Node * pNew = new Node(*first);
+         if (pLast)
+            pLast->pNext = pNew;
+         else
+            pFirst = pNew;
+         pLast = pNew;
+      }
+   }
+   catch (...)
+   {
+      while (pFirst)
+      {
+         Node * pDelete = pFirst;
+         pFirst = pFirst->pNext;
+         delete pDelete;
+      }
+      throw;
+   }
+
+   if (num)
+      linkBack(pFirst, pLast, num);
+}
+
+/*********************************************
+ * CONCURRENT LIST :: LINK FRONT
+ * Add an item right after the dummy. If the list is
+ * empty the new node is also the tail, so we need the
+ * tail lock, which must be taken before any node lock.
+ *    INPUT  : a node holding the item
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void concurrent_list <T> :: linkFront(Node * pNew)
+{
+   numHead.fetch_add(1, std::memory_order_release);
+
+   std::lock_guard<std::mutex> guardHead(headLock);
+   std::unique_lock<std::mutex> guardNode(pHead->lock);
+
+   if (pHead->pNext == nullptr)
+   {
+      guardNode.unlock();
+      std::lock_guard<std::mutex> guardTail(tailLock);
+      guardNode.lock();
+
+      // a push_back may have beaten us to it
+      pNew->pNext = pHead->pNext;
+      pHead->pNext = pNew;
+      if (pNew->pNext == nullptr)
+         pTail = pNew;
+   }
+   else
+   {
+      pNew->pNext = pHead->pNext;
+      pHead->pNext = pNew;
+   }
+}
+
+/*********************************************
+ * CONCURRENT LIST :: POP FRONT
+ * Take the first item out. The first node becomes the
+ * new dummy before its item is moved out, so if writing
+ * the item throws the list is still well formed. The
+ * old dummy is freed either way.
+ *    INPUT  : where to put the item
+ *    OUTPUT : false if the list was empty
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+bool concurrent_list <T> :: pop_front(T & data)
+{
+   Node * pDelete = nullptr;
+   try
+   {
+      std::lock_guard<std::mutex> guardHead(headLock);
+      std::lock_guard<std::mutex> guardDummy(pHead->lock);
+      Node * pFirst = pHead->pNext;
+      if (pFirst == nullptr)
+         return false;
+
+      // the old dummy has a next node so it is not the tail, and every
+      // traversal locks it while holding the head lock, so once we let
+      // go nobody can be waiting for it
+      std::lock_guard<std::mutex> guardFirst(pFirst->lock);
+      pDelete = pHead;
+      pHead = pFirst;
+      numHead.fetch_sub(1, std::memory_order_release);
+      data = pFirst->release();
+   }
+   catch (...)
+   {
+      delete pDelete;
+      throw;
+   }
+   delete pDelete;
+   return true;
+}
+
+/*********************************************
+ * CONCURRENT LIST :: POP FRONT BULK
+ * Take up to max_n items out while holding the head
+ * lock just once. Each node is locked on the way, hand
+ * over hand, so we never pass a traversal. Every node
+ * taken becomes the dummy before its item is moved
+ * out, so if writing an item throws the list is still
+ * well formed. The old dummies are freed at the end.
+ *    INPUT  : where to put the items, and at most how many
+ *    OUTPUT : how many were taken
+ *    COST   : O(max_n)
+ *********************************************/
+template <typename T>
+template <class OutputIterator>
+size_t concurrent_list <T> :: pop_front_bulk(OutputIterator out, size_t max_n)
+{
+   Node * pDelete = nullptr;
+   Node * pDummy = nullptr;
+   size_t num = 0;
+   try
+   {
+      std::lock_guard<std::mutex> guardHead(headLock);
+      std::unique_lock<std::mutex> guardCurrent(pHead->lock);
+      pDelete = pDummy = pHead;
+      while (num < max_n && pDummy->pNext)
+      {
+         std::unique_lock<std::mutex> guardNext(pDummy->pNext->lock);
+         guardCurrent.swap(guardNext);
+         guardNext.unlock();
+         pHead = pDummy = pDummy->pNext;
+         num++;
+         *out = pDummy->release();
+         ++out;
+      }
+   }
+   catch (...)
+   {
+      numHead.fetch_sub(num, std::memory_order_release);
+      deleteUpTo(pDelete, pDummy);
+      throw;
+   }
+   numHead.fetch_sub(num, std::memory_order_release);
+   deleteUpTo(pDelete, pDummy);
+   return num;
+}
+
+/*********************************************
+ * CONCURRENT LIST :: DELETE UP TO
+ * Free the old dummies a bulk pop left behind
+ *    INPUT  : the first node to free, and the node to stop at
+ *    OUTPUT :
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+void concurrent_list <T> :: deleteUpTo(Node * pFirst, Node * pStop)
+{
+   while (pFirst != pStop)
+   {
+      Node * pNext = pFirst->pNext;
+      delete pFirst;
+      pFirst = pNext;
+   }
+}
+
+/*********************************************
+ * CONCURRENT LIST :: FOR EACH
+ * Call f on every item from front to back. Each item
+ * is locked while f looks at it, and the next one is
+ * locked before the current one is released.
+ *    INPUT  : the function to call
+ *    OUTPUT :
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+template <class Function>
+void concurrent_list <T> :: for_each(Function f)
+{
+   std::unique_lock<std::mutex> guardHead(headLock);
+   Node * p = pHead;
+   std::unique_lock<std::mutex> guardCurrent(p->lock);
+   guardHead.unlock();
+
+   while (Node * pNext = p->pNext)
+   {
+      std::unique_lock<std::mutex> guardNext(pNext->lock);
+      guardCurrent.swap(guardNext);
+      guardNext.unlock();
+      p = pNext;
+      f(p->data());
+   }
+}
+
+/*********************************************
+ * CONCURRENT LIST :: FIND IF
+ * Find the first item pred accepts, walking
+ * hand-over-hand like for_each
+ *    INPUT  : the predicate and where to copy the item
+ *    OUTPUT : whether one was found
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+template <class Predicate>
+bool concurrent_list <T> :: find_if(Predicate pred, T & data)
+{
+   std::unique_lock<std::mutex> guardHead(headLock);
+   Node * p = pHead;
+   std::unique_lock<std::mutex> guardCurrent(p->lock);
+   guardHead.unlock();
+
+   while (Node * pNext = p->pNext)
+   {
+      std::unique_lock<std::mutex> guardNext(pNext->lock);
+      guardCurrent.swap(guardNext);
+      guardNext.unlock();
+      p = pNext;
+      if (pred(p->data()))
+      {
+         data = p->data();
+         return true;
+      }
+   }
+   return false;
+}
+
+/*********************************************
+ * CONCURRENT LIST :: CONTAINS
+ *********************************************/
+template <typename T>
+bool concurrent_list <T> :: contains(const T & data)
+{
+   T found(data);
+   return find_if([&data](const T & item) { return item == data; }, found);
+}
+
+}; // namespace custom
@@ -0,0 +1,483 @@
+/***********************************************************************
+ * Header:
+ *    INDEXED LIST
+ * Summary:
+ *    A list which can also find its i-th item, or the position of an
+ *    item, in O(log n). The nodes are linked front to back like any
+ *    list, and the same nodes also form a balanced binary tree ordered
+ *    by position. Every tree node counts the nodes under it, so the
+ *    i-th node is found by walking down from the root, and the
+ *    position of a node by walking up to it.
+ *
+ *    The tree is a treap: every node draws a random priority and sits
+ *    below any node with a higher one, which keeps the expected depth
+ *    at O(log n) without any rebalancing rules. A new node is hung
+ *    where its position says, then rotated up past parents with a
+ *    lower priority; a node to be erased is rotated down until it has
+ *    at most one child, then cut out.
+ *
+ *    Walking the list with ++ and -- never touches the tree, so it
+ *    costs the same as in list.
+ *
+ *    This will contain the class definition of:
+ *        indexed_list : A list with positional access in O(log n)
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+#include <cstdint>     // for uint32_t
+#include <utility>     // for std::move
+#include "nodePool.h"  // for custom::pool
+
+class TestIndexedList;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/**************************************************
+ * INDEXED LIST
+ * A list with an order-statistic tree over its nodes
+ **************************************************/
+template <typename T>
+class indexed_list
+{
+   friend class ::TestIndexedList; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   indexed_list() : pHead(nullptr), pTail(nullptr), pRoot(nullptr), seed(2463534242u) { }
+   indexed_list(const indexed_list & rhs);
+   indexed_list & operator = (const indexed_list &) = delete;
+  ~indexed_list() { clear(); }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin()  { return iterator(pHead); }
+   iterator rbegin() { return iterator(pTail); }
+   iterator end()    { return iterator();      }
+
+   //
+   // Access
+   //
+
+   T & front();
+   T & back();
+   T & at(size_t index);
+   iterator iterator_at(size_t index);
+   size_t index_of(const iterator & it) const;
+
+   //
+   // Insert
+   //
+
+   void push_front(const T & data) { insert(begin(), data); }
+   void push_back (const T & data) { insert(end(),   data); }
+   iterator insert(iterator it, const T & data);
+   iterator insert(iterator it,       T && data);
+
+   //
+   // Remove
+   //
+
+   void pop_front() { erase(begin());  }
+   void pop_back()  { erase(rbegin()); }
+   void clear();
+   iterator erase(const iterator & it);
+
+   //
+   // Status
+   //
+
+   bool   empty() const { return pRoot == nullptr;   }
+   size_t size()  const { return count(pRoot);       }
+
+private:
+   class Node;
+
+   static size_t count(const Node * p) { return p ? p->count : 0; }
+   Node * nodeAt(size_t index) const;
+   iterator link(iterator it, Node * pNew);
+   void rotateUp(Node * p);
+   void rotate(Node * p);
+   void replaceChild(Node * pParent, Node * pOld, Node * pNew);
+   uint32_t nextPriority();
+
+   Node * pHead;    // the first node in list order
+   Node * pTail;    // the last node in list order
+   Node * pRoot;    // the top of the tree
+   uint32_t seed;   // for the priorities
+};
+
+/*************************************************
+ * INDEXED LIST NODE
+ * A list node and a tree node at once
+ *************************************************/
+template <typename T>
+class indexed_list <T> :: Node
+{
+public:
+   Node(const T & data) : data(data)            { }
+   Node(T && data)      : data(std::move(data)) { }
+
+   static void * operator new   (size_t)      { return pool<sizeof(Node), alignof(Node)>::allocate(); }
+   static void   operator delete(void * p)    { pool<sizeof(Node), alignof(Node)>::free(p);           }
+
+   T data;
+   Node * pNext = nullptr;     // list order
+   Node * pPrev = nullptr;
+   Node * pLeft = nullptr;     // the tree
+   Node * pRight = nullptr;
+   Node * pParent = nullptr;
+   size_t count = 1;           // nodes in this subtree, counting this one
+   uint32_t priority = 0;      // higher is nearer the root
+};
+
+/*************************************************
+ * INDEXED LIST ITERATOR
+ * Walks the list links, just like list's iterator
+ *************************************************/
+template <typename T>
+class indexed_list <T> :: iterator
+{
+   friend class ::TestIndexedList;
+   template <typename TT>
+   friend class custom::indexed_list;
+public:
+   iterator()         : p(nullptr) { }
+   iterator(Node * p) : p(p)       { }
+
+   bool operator == (const iterator & rhs) const { return p == rhs.p; }
+   bool operator != (const iterator & rhs) const { return p != rhs.p; }
+
+   T & operator * ()
+   {
+      if (p)
+         return p->data;
+      else
+         throw "ERROR: unable to access data from an empty list";
+   }
+
+   iterator & operator ++ ()           { if (p) p = p->pNext; return *this; }
+   iterator   operator ++ (int postfix) { iterator old(*this); ++(*this); return old; }
+   iterator & operator -- ()           { if (p) p = p->pPrev; return *this; }
+   iterator   operator -- (int postfix) { iterator old(*this); --(*this); return old; }
+
+private:
+   Node * p;
+};
+
+/*****************************************
+ * INDEXED LIST :: COPY CONSTRUCTOR
+ ****************************************/
+template <typename T>
+indexed_list <T> :: indexed_list(const indexed_list & rhs) :
+   pHead(nullptr), pTail(nullptr), pRoot(nullptr), seed(rhs.seed)
+{
+   for (const Node * p = rhs.pHead; p; p = p->pNext)
+      push_back(p->data);
+}
+
+/*********************************************
+ * INDEXED LIST :: FRONT and BACK
+ *********************************************/
+template <typename T>
+T & indexed_list <T> :: front()
+{
+   if (pHead == nullptr)
+      throw "ERROR: unable to access data from an empty list";
+   return pHead->data;
+}
+
+template <typename T>
+T & indexed_list <T> :: back()
+{
+   if (pTail == nullptr)
+      throw "ERROR: unable to access data from an empty list";
+   return pTail->data;
+}
+
+/*********************************************
+ * INDEXED LIST :: NODE AT
+ * Walk down from the root, steering by the counts
+ *    INPUT  : a position
+ *    OUTPUT : the node there, or nullptr past the end
+ *    COST   : O(log n)
+ *********************************************/
+template <typename T>
+typename indexed_list <T> :: Node * indexed_list <T> :: nodeAt(size_t index) const
+{
+   Node * p = pRoot;
+   while (p)
+   {
+      size_t numLeft = count(p->pLeft);
+      if (index < numLeft)
+         p = p->pLeft;
+      else if (index == numLeft)
+         return p;
+      else
+      {
+         index -= numLeft + 1;
+         p = p->pRight;
+      }
+   }
+   return nullptr;
+}
+
+/*********************************************
+ * INDEXED LIST :: AT and ITERATOR AT
+ *    INPUT  : a position
+ *    OUTPUT : the item there, or an iterator to it (end() past the end)
+ *    COST   : O(log n)
+ *********************************************/
+template <typename T>
+T & indexed_list <T> :: at(size_t index)
+{
+   Node * p = nodeAt(index);
+   if (p == nullptr)
+      throw "ERROR: index out of range";
+   return p->data;
+}
+
+template <typename T>
+typename indexed_list <T> :: iterator indexed_list <T> :: iterator_at(size_t index)
+{
+   return iterator(nodeAt(index));
+}
+
+/*********************************************
+ * INDEXED LIST :: INDEX OF
+ * Walk up from the node, adding up everything which
+ * comes before it
+ *    INPUT  : an iterator
+ *    OUTPUT : its position, or size() for end()
+ *    COST   : O(log n)
+ *********************************************/
+template <typename T>
+size_t indexed_list <T> :: index_of(const iterator & it) const
+{
+   if (it.p == nullptr)
+      return size();
+
+   size_t index = count(it.p->pLeft);
+   for (const Node * p = it.p; p->pParent; p = p->pParent)
+      if (p == p->pParent->pRight)
+         index += count(p->pParent->pLeft) + 1;
+   return index;
+}
+
+/*********************************************
+ * INDEXED LIST :: INSERT
+ * Add an item just before it, or at the end if it is
+ * end()
+ *    INPUT  : where to put it and the item
+ *    OUTPUT : an iterator to the new item
+ *    COST   : O(log n)
+ *********************************************/
+template <typename T>
+typename indexed_list <T> :: iterator indexed_list <T> :: insert(iterator it, const T & data)
+{
+   return link(it, new Node(data));
+}
+
+template <typename T>
+typename indexed_list <T> :: iterator indexed_list <T> :: insert(iterator it, T && data)
+{
+   return link(it, new Node(std::move(data)));
+}
+
+/*********************************************
+ * INDEXED LIST :: LINK
+ * Put a new node into the list and the tree. In the
+ * tree it goes in the only free spot between its two
+ * list neighbors: the left child of the node after it
+ * if that is free, or else the right child of the node
+ * before it, which is always free.
+ *    INPUT  : where to put it and the node
+ *    OUTPUT : an iterator to the node
+ *    COST   : O(log n)
+ *********************************************/
+template <typename T>
+typename indexed_list <T> :: iterator indexed_list <T> :: link(iterator it, Node * pNew)
+{
+   Node * pAfter = it.p;
+   Node * pBefore = pAfter ? pAfter->pPrev : pTail;
+
+   // the list
+   pNew->pNext = pAfter;
+   pNew->pPrev = pBefore;
+   if (pBefore)
+      pBefore->pNext = pNew;
+   else
+      pHead = pNew;
+   if (pAfter)
+      pAfter->pPrev = pNew;
+   else
+      pTail = pNew;
+
+   // the tree
+   pNew->priority = nextPriority();
+   if (pRoot == nullptr)
+      pRoot = pNew;
+   else
+   {
+      if (pAfter && pAfter->pLeft == nullptr)
+         pAfter->pLeft = pNew, pNew->pParent = pAfter;
+      else
+         pBefore->pRight = pNew, pNew->pParent = pBefore;
+      for (Node * p = pNew->pParent; p; p = p->pParent)
+         p->count++;
+      rotateUp(pNew);
+   }
+   return iterator(pNew);
+}
+
+/*********************************************
+ * INDEXED LIST :: ERASE
+ * Rotate the node down until it has at most one child,
+ * then let that child take its place
+ *    INPUT  : the item to remove
+ *    OUTPUT : an iterator to the item after it
+ *    COST   : O(log n)
+ *********************************************/
+template <typename T>
+typename indexed_list <T> :: iterator indexed_list <T> :: erase(const iterator & it)
+{
+   Node * p = it.p;
+   if (p == nullptr)
+      return end();
+   Node * pNext = p->pNext;
+
+   // the tree
+   while (p->pLeft && p->pRight)
+   {
+      Node * pChild = (p->pLeft->priority > p->pRight->priority) ? p->pLeft : p->pRight;
+      rotate(pChild);
+   }
+   Node * pChild = p->pLeft ? p->pLeft : p->pRight;
+   if (pChild)
+      pChild->pParent = p->pParent;
+   replaceChild(p->pParent, p, pChild);
+   for (Node * pUp = p->pParent; pUp; pUp = pUp->pParent)
+      pUp->count--;
+
+   // the list
+   if (p->pPrev)
+      p->pPrev->pNext = p->pNext;
+   else
+      pHead = p->pNext;
+   if (p->pNext)
+      p->pNext->pPrev = p->pPrev;
+   else
+      pTail = p->pPrev;
+
+   delete p;
+   return iterator(pNext);
+}
+
+/*********************************************
+ * INDEXED LIST :: CLEAR
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+void indexed_list <T> :: clear()
+{
+   while (pHead)
+   {
+      Node * pDelete = pHead;
+      pHead = pHead->pNext;
+      delete pDelete;
+   }
+   pTail = pRoot = nullptr;
+}
+
+/*********************************************
+ * INDEXED LIST :: ROTATE UP
+ * Lift a new node past every parent with a lower
+ * priority
+ *    INPUT  : the new node
+ *    OUTPUT :
+ *    COST   : O(log n)
+ *********************************************/
+template <typename T>
+void indexed_list <T> :: rotateUp(Node * p)
+{
+   while (p->pParent && p->priority > p->pParent->priority)
+      rotate(p);
+}
+
+/*********************************************
+ * INDEXED LIST :: ROTATE
+ * Swap p with its parent, keeping the order of the
+ * nodes and fixing the two counts which change
+ *        pParent              p
+ *        /     \            /  \
+ *       p       c   ->     a   pParent
+ *      / \                      /    \
+ *     a   b                    b      c
+ *    INPUT  : a node with a parent
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void indexed_list <T> :: rotate(Node * p)
+{
+   Node * pParent = p->pParent;
+   Node * pGrand = pParent->pParent;
+   if (p == pParent->pLeft)
+   {
+      pParent->pLeft = p->pRight;
+      if (p->pRight)
+         p->pRight->pParent = pParent;
+      p->pRight = pParent;
+   }
+   else
+   {
+      pParent->pRight = p->pLeft;
+      if (p->pLeft)
+         p->pLeft->pParent = pParent;
+      p->pLeft = pParent;
+   }
+   pParent->pParent = p;
+   p->pParent = pGrand;
+   replaceChild(pGrand, pParent, p);
+
+   pParent->count = count(pParent->pLeft) + count(pParent->pRight) + 1;
+   p->count = count(p->pLeft) + count(p->pRight) + 1;
+}
+
+/*********************************************
+ * INDEXED LIST :: REPLACE CHILD
+ * Point whatever pointed at pOld at pNew instead
+ *********************************************/
+template <typename T>
+void indexed_list <T> :: replaceChild(Node * pParent, Node * pOld, Node * pNew)
+{
+   if (pParent == nullptr)
+      pRoot = pNew;
+   else if (pParent->pLeft == pOld)
+      pParent->pLeft = pNew;
+   else
+      pParent->pRight = pNew;
+}
+
+/*********************************************
+ * INDEXED LIST :: NEXT PRIORITY
+ * A xorshift generator: quick, and random enough
+ * to keep the tree balanced
+ *********************************************/
+template <typename T>
+uint32_t indexed_list <T> :: nextPriority()
+{
+   seed ^= seed << 13;
+   seed ^= seed >> 17;
+   seed ^= seed << 5;
+   return seed;
+}
+
+}; // namespace custom
@@ -14,22 +14,297 @@
  *    This will contain the class definition of:
  *        List         : A class that represents a List
  *        ListIterator : An iterator through List
+ *
+ *    Define LIST_CACHE_ALIGNED to put pHead and a count of the items
+ *    added and removed at the front on one cache line and pTail and a
+ *    count of the rest on another. It costs about 200 bytes a
+ *    list and only helps when one thread works at the front while
+ *    another works at the back.
+ *
+ *    Define LIST_POOL to take nodes from custom::pool instead of the
+ *    global new. Copies, binary reads, and compact() then get runs of
+ *    adjacent nodes, and most pushes and pops take no lock. But the
+ *    pool never gives memory back: a list which grows to ten million
+ *    nodes and is then cleared keeps those nodes until the program
+ *    ends, for reuse by any list with nodes of the same size.
  * Author
  *    Joel Jossie, Gergo Medveczky
  ************************************************************************/
 
 #pragma once
 #include <cassert>     // for ASSERT
+#include <cstddef>     // for std::max_align_t
 #include <iostream>    // for nullptr
 #include <new>         // std::bad_alloc
 #include <memory>      // for std::allocator
+#include <type_traits> // for std::is_trivially_copyable
+#include <functional>  // for std::less
+#include <cstdint>     // for uint32_t and uint64_t
+#include <cstring>     // for std::memcpy
+#include <string>      // for std::string
+#include <utility>     // for std::swap
+#include <vector>      // for std::vector
+#ifdef LIST_POOL
+#include "nodePool.h"  // for custom::pool
+#endif // LIST_POOL
+#ifdef LIST_STATS
+#include <atomic>      // for std::atomic
+#endif // LIST_STATS
+#ifdef LIST_TRACE
+#include "listTrace.h" // for custom::listTrace
+#endif // LIST_TRACE
+#ifdef _MSC_VER
+#include <xmmintrin.h> // for _mm_prefetch
+#define LIST_PREFETCH(p)  _mm_prefetch((const char *)(p), _MM_HINT_T0)
+#else
+#define LIST_PREFETCH(p)  __builtin_prefetch(p)
+#endif
  
 class TestList;        // forward declaration for unit tests
 class TestHash;
+class TestParallelList;
+class TestShardedList;
 
 namespace custom
 {
 
+template <typename T>
+class list;
+
+// parallelList.h builds lists directly from their nodes
+namespace parallel
+{
+   template <typename T>
+   class chunk_index;
+   template <typename T>
+   void copy(const chunk_index <T> & index, list <T> & dst);
+   template <typename T, class Compare>
+   void sort(list <T> & l, Compare comp, size_t pieces);
+};
+
+#ifdef LIST_STATS
+/**************************************************
+ * LIST STATS
+ * Counts the nodes allocated and freed by every list
+ * of one type, and which operation asked for them.
+ * Define LIST_STATS to turn the counting on; without
+ * it none of this exists.
+ **************************************************/
+struct listStats
+{
+   // the operations we charge allocations to
+   enum Op { OTHER, PUSH, INSERT, COPY_ASSIGN, FILL_CONSTRUCT, NUM_OPS, NONE = NUM_OPS };
+
+   listStats() { reset(); }
+
+   std::atomic<size_t> allocations;          // nodes ever allocated
+   std::atomic<size_t> frees;                // nodes ever freed
+   std::atomic<size_t> nodesLive;            // nodes allocated but not yet freed
+   std::atomic<size_t> nodesPeak;            // the most nodes ever live at once
+   std::atomic<size_t> bytesLive;            // the memory held by the live nodes
+   std::atomic<size_t> allocationsByOp[NUM_OPS];
+
+   void reset()
+   {
+      allocations.store(0, std::memory_order_relaxed);
+      frees      .store(0, std::memory_order_relaxed);
+      nodesLive  .store(0, std::memory_order_relaxed);
+      nodesPeak  .store(0, std::memory_order_relaxed);
+      bytesLive  .store(0, std::memory_order_relaxed);
+      for (int op = 0; op < NUM_OPS; op++)
+         allocationsByOp[op].store(0, std::memory_order_relaxed);
+   }
+
+   // Nothing is published through the counters, so relaxed is
+   // enough and no fence goes on the hot path
+   void allocate(size_t num, size_t bytes)
+   {
+      Op op = current();
+      allocations.fetch_add(num, std::memory_order_relaxed);
+      allocationsByOp[op == NONE ? OTHER : op].fetch_add(num, std::memory_order_relaxed);
+      bytesLive.fetch_add(num * bytes, std::memory_order_relaxed);
+      size_t live = nodesLive.fetch_add(num, std::memory_order_relaxed) + num;
+      size_t peak = nodesPeak.load(std::memory_order_relaxed);
+      while (live > peak && !nodesPeak.compare_exchange_weak(peak, live,
+                                                             std::memory_order_relaxed))
+         ;
+   }
+
+   void free(size_t num, size_t bytes)
+   {
+      frees.fetch_add(num, std::memory_order_relaxed);
+      nodesLive.fetch_sub(num, std::memory_order_relaxed);
+      bytesLive.fetch_sub(num * bytes, std::memory_order_relaxed);
+   }
+
+   // the operation this thread is in the middle of
+   static Op & current()
+   {
+      static thread_local Op op = NONE;
+      return op;
+   }
+
+   // charge allocations to op for the life of the scope. The
+   // outermost operation wins, so the push_backs inside a fill
+   // constructor are charged to the fill constructor.
+   class Scope
+   {
+   public:
+      Scope(Op op) : previous(current())
+      {
+         if (previous == NONE)
+            current() = op;
+      }
+     ~Scope() { current() = previous; }
+   private:
+      Op previous;
+   };
+};
+
+#define LIST_STATS_OP(op)         listStats::Scope listStatsScope(listStats::op)
+#define LIST_STATS_ALLOCATE(num)  list::stats().allocate(num, sizeof(Node))
+#define LIST_STATS_FREE(num)      list::stats().free(num, sizeof(Node))
+#else
+// the counts are still evaluated, so a count kept only for these is not unused
+#define LIST_STATS_OP(op)
+#define LIST_STATS_ALLOCATE(num)  ((void)(num))
+#define LIST_STATS_FREE(num)      ((void)(num))
+#endif // LIST_STATS
+
+#ifdef LIST_TRACE
+#define LIST_TRACE_OP(op)         listTrace::Scope listTraceScope(listTrace::op)
+#else
+#define LIST_TRACE_OP(op)
+#endif // LIST_TRACE
+
+/**************************************************
+ * LIST IO
+ * Where list::write puts its bytes and list::read
+ * gets them: a stream or a block of memory. A read
+ * that runs out of bytes throws.
+ **************************************************/
+namespace io
+{
+   class streamSink
+   {
+   public:
+      streamSink(std::ostream & out) : out(out) { }
+      void write(const void * p, size_t num)
+      {
+         if (!out.write(static_cast<const char *>(p), num))
+            throw "ERROR: unable to write the list";
+      }
+   private:
+      std::ostream & out;
+   };
+
+   class bufferSink
+   {
+   public:
+      bufferSink(std::vector<char> & buffer) : buffer(buffer) { }
+      void write(const void * p, size_t num)
+      {
+         const char * pBytes = static_cast<const char *>(p);
+         buffer.insert(buffer.end(), pBytes, pBytes + num);
+      }
+      void reserve(size_t num) { buffer.reserve(buffer.size() + num); }
+   private:
+      std::vector<char> & buffer;
+   };
+
+   class streamSource
+   {
+   public:
+      streamSource(std::istream & in) : in(in) { }
+      void read(void * p, size_t num)
+      {
+         if (!in.read(static_cast<char *>(p), num))
+            throw "ERROR: the list ended early";
+      }
+   private:
+      std::istream & in;
+   };
+
+   class bufferSource
+   {
+   public:
+      bufferSource(const char * p, size_t size) : p(p), pEnd(p + size) { }
+      void read(void * pTo, size_t num)
+      {
+         if ((size_t)(pEnd - p) < num)
+            throw "ERROR: the list ended early";
+         std::memcpy(pTo, p, num);
+         p += num;
+      }
+      const char * position() const { return p; }
+   private:
+      const char * p;
+      const char * pEnd;
+   };
+}
+
+/**************************************************
+ * LIST SERIALIZER
+ * How list::write and list::read store one item.
+ * Trivially copyable items are stored as their bytes,
+ * and list writes those in large blocks without ever
+ * asking this. Any other type needs a specialization
+ * with the same two members; std::string has one.
+ **************************************************/
+template <typename T>
+struct list_serializer
+{
+   static_assert(std::is_trivially_copyable<T>::value,
+                 "specialize list_serializer to read and write this type");
+
+   template <class Sink>
+   static void write(Sink & out, const T & item) { out.write(&item, sizeof(T)); }
+
+   template <class Source>
+   static T read(Source & in)
+   {
+      alignas(T) unsigned char bytes[sizeof(T)];
+      in.read(bytes, sizeof(T));
+      return *reinterpret_cast<T *>(bytes);
+   }
+};
+
+// a string is its length followed by its characters
+template <>
+struct list_serializer <std::string>
+{
+   // A damaged input can claim any length at all, so the string grows
+   // a piece at a time as its characters arrive. Input cut short then
+   // fails after at most one piece more than it holds.
+   static const size_t pieceBytes = 64 * 1024;
+
+   template <class Sink>
+   static void write(Sink & out, const std::string & item)
+   {
+      uint64_t length = item.size();
+      out.write(&length, sizeof(length));
+      out.write(item.data(), item.size());
+   }
+
+   template <class Source>
+   static std::string read(Source & in)
+   {
+      uint64_t length;
+      in.read(&length, sizeof(length));
+      std::string item;
+      if (length > item.max_size())
+         throw "ERROR: the saved string is too long";
+      while (item.size() < length)
+      {
+         size_t start = item.size();
+         size_t num = length - start < pieceBytes ? (size_t)(length - start) : pieceBytes;
+         item.resize(start + num);
+         in.read(&item[start], num);
+      }
+      return item;
+   }
+};
+
 /**************************************************
  * LIST
  * Just like std::list
@@ -39,7 +314,13 @@ class list
 {
    friend class ::TestList; // give unit tests access to the privates
    friend class ::TestHash;
+   friend class ::TestParallelList;
+   friend class ::TestShardedList;
    friend void swap(list& lhs, list& rhs);
+   template <typename U>
+   friend void parallel::copy(const parallel::chunk_index <U> & index, list <U> & dst);
+   template <typename U, class Compare>
+   friend void parallel::sort(list <U> & l, Compare comp, size_t pieces);
 public:  
    // 
    // Construct
@@ -73,12 +354,21 @@ public:
    iterator rbegin() { return iterator(pTail); }
    iterator end()    { return iterator(); }
 
+   //
+   // Traverse
+   //
+
+   template <class Function>
+   void for_each_prefetch(Function f, size_t distance = 8);
+
    //
    // Access
    //
 
    T& front();
    T& back();
+   T& at(size_t index);
+   iterator iterator_at(size_t index);
 
    //
    // Insert
@@ -90,6 +380,9 @@ public:
    void push_back (      T&& data);
    iterator insert(iterator it, const T& data);
    iterator insert(iterator it, T&& data);
+   void splice(iterator it, list <T> & rhs);
+   template <class Iterator>
+   void push_back_bulk(Iterator first, Iterator last);
 
    //
    // Remove
@@ -99,23 +392,159 @@ public:
    void pop_front();
    void clear();
    iterator erase(const iterator& it);
+   template <class OutputIterator>
+   size_t pop_front_bulk(OutputIterator out, size_t max_n);
+   void drain_into(list <T> & rhs) { rhs.splice(rhs.end(), *this); }
+
+   //
+   // Export
+   //
+
+   T * copy_to(T * out) const;
+   std::vector<T> to_vector() const;
+   template <class OutputIterator>
+   OutputIterator drain_to(OutputIterator out);
+
+   //
+   // Serialize
+   //
+
+   void   write(std::ostream & out) const;
+   void   write(std::vector<char> & buffer) const;
+   void   read (std::istream & in);
+   size_t read (const char * buffer, size_t size);
+
+   //
+   // Layout
+   //
+
+   void compact();
+
+   //
+   // Order
+   //
+
+   void sort()                { sort(std::less<T>()); }
+   template <class Compare>
+   void sort(Compare comp);
 
    // 
    // Status
    //
 
    bool empty()  const { return (size() == 0); }
+#ifdef LIST_CACHE_ALIGNED
+   size_t size() const { return numHead + numTail; }
+#else
    size_t size() const { return numElements;   }
+#endif // LIST_CACHE_ALIGNED
+
+#ifdef LIST_STATS
+   // the allocation counts shared by every list of this type
+   static listStats & stats()
+   {
+      static listStats * pStats = new listStats;
+      return *pStats;
+   }
+#endif // LIST_STATS
 
 
 private:
    // nested linked list class
    class Node;
 
+   // bulk node management
+   static void copyChain(const Node * pSrc, size_t num, Node * & pFirst, Node * & pLast)
+   {
+      copyChain(pSrc, num, pFirst, pLast, std::is_trivially_copyable<T>());
+   }
+   static void copyChain(const Node * pSrc, size_t num, Node * & pFirst, Node * & pLast, std::true_type);
+   static void copyChain(const Node * pSrc, size_t num, Node * & pFirst, Node * & pLast, std::false_type);
+   static Node * copyRun(const Node * pSrc, size_t num, void * pRun);
+   static void deleteChain(Node * pFirst);
+   Node * detachFront(size_t num);
+
+   // keeping count: an item added or removed at the front, at the back
+   // (or in the middle), or a whole new count
+#ifdef LIST_CACHE_ALIGNED
+   void countFront(ptrdiff_t num) { numHead += (size_t)num;        }
+   void countBack (ptrdiff_t num) { numTail += (size_t)num;        }
+   void setCount  (size_t num)    { numHead = 0; numTail = num;    }
+#else
+   void countFront(ptrdiff_t num) { numElements += (size_t)num;    }
+   void countBack (ptrdiff_t num) { numElements += (size_t)num;    }
+   void setCount  (size_t num)    { numElements = num;             }
+#endif // LIST_CACHE_ALIGNED
+
+   // positional access
+   Node * nodeAt(size_t index);
+   void forgetFinger() { pFinger = nullptr; }
+   void moveFingerForInsert(const Node * pBefore);
+   void moveFingerForErase(const Node * pErase);
+
+   // the binary format: a header, then every item
+   struct Header
+   {
+      char     magic[4];   // "CLST"
+      uint32_t itemSize;   // sizeof(T) for raw items, 0 for list_serializer
+      uint64_t numItems;
+   };
+   static const size_t ioBlockBytes = 64 * 1024;
+   template <class Sink>
+   void writeTo(Sink & out) const;
+   template <class Source>
+   void readFrom(Source & in);
+   template <class Sink>
+   void writeItems(Sink & out, std::true_type) const;
+   template <class Sink>
+   void writeItems(Sink & out, std::false_type) const;
+   template <class Source>
+   void readItems(Source & in, size_t num, std::true_type);
+   template <class Source>
+   void readItems(Source & in, size_t num, std::false_type);
+
+   // the ends of a detached, null-terminated chain linked both ways
+   struct Chain
+   {
+      Node * pFirst;
+      Node * pLast;
+   };
+   template <class Compare>
+   static void sortChain(Chain & chain, Compare & comp);
+   template <class Compare>
+   static void mergeChains(Chain & a, Chain & b, Compare & comp);
+   static void joinChains(Chain & a, Chain & b);
+
    // member variables
-   size_t numElements; // though we could count, it is faster to keep a variable
+   // pFinger and fingerIndex are the node at() or iterator_at() last
+   // found, and where it is, so the next lookup nearby walks from here.
+   // Every change to the list either keeps fingerIndex right or forgets
+   // the finger.
+
+#ifdef LIST_CACHE_ALIGNED
+   // The front and the back each get a cache line of their own, so a
+   // thread working at one end does not keep stealing the line from a
+   // thread working at the other. As in concurrent_list the count is
+   // kept in two halves, one written only at each end, and size() adds
+   // them up; either half may wrap below zero. push_front and pop_front
+   // move the finger, so it goes with the front. The pads are whole
+   // lines because a list need not start on a line boundary.
+   char padFront[64];
+   Node * pHead;           // pointer to the beginning of the list
+   size_t numHead = 0;     // items added at the front less those removed there
+   Node * pFinger = nullptr;
+   size_t fingerIndex = 0;
+   char padMiddle[64];
+   Node * pTail;           // pointer to the ending of the list
+   size_t numTail = 0;     // items added elsewhere less those removed elsewhere
+   char padBack[64];
+#else
+   size_t numElements = 0; // though we could count, it is faster to keep a variable
    Node * pHead;    // pointer to the beginning of the list
    Node * pTail;    // pointer to the ending of the list
+   Node * pFinger = nullptr;
+   size_t fingerIndex = 0;
+#endif // LIST_CACHE_ALIGNED
 };
 
 /*************************************************
@@ -136,6 +565,162 @@ public:
    Node(const T& data) : pNext(nullptr), pPrev(nullptr), data(data)             { }
    Node(T&& data)      : data(std::move(data)), pNext(nullptr), pPrev(nullptr)  { }
 
+   //
+   // Allocate: with LIST_POOL, nodes come from a pool shared by all
+   // nodes of this size; otherwise each one is its own allocation
+   //
+
+   static void * operator new(size_t)
+   {
+      void * p = newSlot();
+      LIST_STATS_ALLOCATE(1);
+      return p;
+   }
+   static void operator delete(void * p)
+   {
+      if (p == nullptr)
+         return;
+      deleteSlot(p);
+      LIST_STATS_FREE(1);
+   }
+   static void * operator new   (size_t, void * p) { return p; }
+   static void   operator delete(void *, void *)    {           }
+
+   // uninitialized storage for num nodes, chained through their first word
+   static void * allocate(size_t num)
+   {
+#ifdef LIST_POOL
+      void * p = pool<sizeof(Node), alignof(Node)>::allocate(num);
+#else
+      void * p = nullptr;
+      try
+      {
+         for (size_t i = 0; i < num; i++)
+         {
+            void * pSlot = newSlot();
+            *static_cast<void **>(pSlot) = p;
+            p = pSlot;
+         }
+      }
+      catch (...)
+      {
+         freeSlots(p);
+         throw;
+      }
+#endif // LIST_POOL
+      LIST_STATS_ALLOCATE(num);
+      return p;
+   }
+
+   // uninitialized storage for num nodes, chained through their first
+   // word in address order. With LIST_POOL they are adjacent in memory.
+   static void * allocateRun(size_t num)
+   {
+#ifdef LIST_POOL
+      static_assert(pool<sizeof(Node), alignof(Node)>::stride == sizeof(Node),
+                    "a run of nodes must be indexable as an array");
+      Node * pRun = static_cast<Node *>(pool<sizeof(Node), alignof(Node)>::allocateRun(num));
+      for (size_t i = 0; i < num; i++)
+         *reinterpret_cast<Node **>(pRun + i) = (i == num - 1 ? nullptr : pRun + i + 1);
+      LIST_STATS_ALLOCATE(num);
+      return pRun;
+#else
+      // allocated one at a time, in order, which is the best we can do
+      void * pFirst = nullptr;
+      void ** ppLink = &pFirst;
+      try
+      {
+         for (size_t i = 0; i < num; i++)
+         {
+            *ppLink = newSlot();
+            ppLink = static_cast<void **>(*ppLink);
+         }
+         *ppLink = nullptr;
+      }
+      catch (...)
+      {
+         *ppLink = nullptr;
+         freeSlots(pFirst);
+         throw;
+      }
+      LIST_STATS_ALLOCATE(num);
+      return pFirst;
+#endif // LIST_POOL
+   }
+
+   // return num destroyed nodes, already chained through their first word
+   static void release(Node * pFirst, Node * pLast, size_t num)
+   {
+#ifdef LIST_POOL
+      pool<sizeof(Node), alignof(Node)>::free(pFirst, pLast);
+#else
+      *reinterpret_cast<void **>(pLast) = nullptr;
+      freeSlots(pFirst);
+#endif // LIST_POOL
+      LIST_STATS_FREE(num);
+   }
+
+#ifdef LIST_POOL
+   // The pool keeps every slab until the program ends: freed nodes are
+   // reused by lists of the same node size, but never given back.
+   static void * newSlot()             { return pool<sizeof(Node), alignof(Node)>::allocate(); }
+   static void   deleteSlot(void * p)  { pool<sizeof(Node), alignof(Node)>::free(p);           }
+#else
+   // The aligned global new gives an over-aligned node what it needs.
+   // Without it, over-allocate, round the start up, and keep the raw
+   // pointer in the word just before the node to free it by.
+#if defined(__cpp_aligned_new)
+   static const bool overAligned = alignof(Node) > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+#else
+   static const bool overAligned = alignof(Node) > alignof(std::max_align_t);
+#endif
+   static void * newSlot()
+   {
+#if defined(__cpp_aligned_new)
+      if (overAligned)
+         return ::operator new(sizeof(Node), std::align_val_t(alignof(Node)));
+#else
+      if (overAligned)
+      {
+         char * pRaw = static_cast<char *>(::operator new(sizeof(Node) + alignof(Node) - 1 + sizeof(void *)));
+         char * p = pRaw + sizeof(void *);
+         p += (alignof(Node) - reinterpret_cast<std::uintptr_t>(p) % alignof(Node)) % alignof(Node);
+         reinterpret_cast<void **>(p)[-1] = pRaw;
+         return p;
+      }
+#endif
+      return ::operator new(sizeof(Node));
+   }
+   static void deleteSlot(void * p)
+   {
+#if defined(__cpp_aligned_new)
+      if (overAligned)
+      {
+         ::operator delete(p, std::align_val_t(alignof(Node)));
+         return;
+      }
+#else
+      if (overAligned)
+      {
+         ::operator delete(static_cast<void **>(p)[-1]);
+         return;
+      }
+#endif
+      ::operator delete(p);
+   }
+
+   // free a null-terminated chain of slots linked through their first word
+   static void freeSlots(void * p)
+   {
+      while (p)
+      {
+         void * pNext = *static_cast<void **>(p);
+         deleteSlot(p);
+         p = pNext;
+      }
+   }
+#endif // LIST_POOL
+
 
    //
    // Data
@@ -155,8 +740,12 @@ class list <T> :: iterator
 {
    friend class ::TestList; // give unit tests access to the privates
    friend class ::TestHash;
+   friend class ::TestParallelList;
+   friend class ::TestShardedList;
    template <typename TT>
    friend class custom::list;
+   template <typename U>
+   friend void parallel::copy(const parallel::chunk_index <U> & index, list <U> & dst);
 public:
    // constructors, destructors, and assignment operator
    iterator()                      : p(nullptr) {}
@@ -228,8 +817,9 @@ private:
  * Create a list initialized to a value
  ****************************************/
 template <typename T>
-list <T> ::list(size_t num, const T & t) : numElements(0), pHead(nullptr), pTail(nullptr)
+list <T> ::list(size_t num, const T & t) : pHead(nullptr), pTail(nullptr)
 {
+   LIST_STATS_OP(FILL_CONSTRUCT);
    for (int i = 0; i < num; i++)
       push_back(t);
 }
@@ -240,8 +830,9 @@ list <T> ::list(size_t num, const T & t) : numElements(0), pHead(nullptr), pTail
  ****************************************/
 template <typename T>
 template <class Iterator>
-list <T> ::list(Iterator first, Iterator last) : pHead(nullptr), pTail(nullptr), numElements(0)
+list <T> ::list(Iterator first, Iterator last) : pHead(nullptr), pTail(nullptr)
 {
+   LIST_STATS_OP(OTHER);
    for (auto it = first; it != last; it++)
       push_back(*it);
 }
@@ -251,8 +842,9 @@ list <T> ::list(Iterator first, Iterator last) : pHead(nullptr), pTail(nullptr),
  * Create a list initialized to a set of values
  ****************************************/
 template <typename T>
-list <T> ::list(const std::initializer_list<T>& il) : pHead(nullptr), pTail(nullptr), numElements(0)
+list <T> ::list(const std::initializer_list<T>& il) : pHead(nullptr), pTail(nullptr)
 {
+   LIST_STATS_OP(OTHER);
    for (auto it = il.begin(); it != il.end(); it++)
       push_back(*it);
 }
@@ -262,8 +854,9 @@ list <T> ::list(const std::initializer_list<T>& il) : pHead(nullptr), pTail(null
  * Create a list initialized to a value
  ****************************************/
 template <typename T>
-list <T> ::list(size_t num) : numElements(0), pHead(nullptr), pTail(nullptr)
+list <T> ::list(size_t num) : pHead(nullptr), pTail(nullptr)
 {
+   LIST_STATS_OP(FILL_CONSTRUCT);
    for (int i = 0; i < num; i++)
       push_back(T());
 }
@@ -272,13 +865,13 @@ list <T> ::list(size_t num) : numElements(0), pHead(nullptr), pTail(nullptr)
  * LIST :: DEFAULT constructors
  ****************************************/
 template <typename T>
-list <T> ::list() : pHead(nullptr), pTail(nullptr), numElements(0) { }
+list <T> ::list() : pHead(nullptr), pTail(nullptr) { }
 
 /*****************************************
  * LIST :: COPY constructors
  ****************************************/
 template <typename T>
-list <T> ::list(list& rhs) : pHead(nullptr), pTail(nullptr), numElements(0)
+list <T> ::list(list& rhs) : pHead(nullptr), pTail(nullptr)
 {
    *this = rhs;
 }
@@ -288,10 +881,14 @@ list <T> ::list(list& rhs) : pHead(nullptr), pTail(nullptr), numElements(0)
  * Steal the values from the RHS
  ****************************************/
 template <typename T>
-list <T> ::list(list <T>&& rhs)  : pHead(rhs.pHead), pTail(rhs.pTail), numElements(rhs.numElements)
+list <T> ::list(list <T>&& rhs)  : pHead(rhs.pHead), pTail(rhs.pTail)
 {
+   pFinger = rhs.pFinger;
+   fingerIndex = rhs.fingerIndex;
+   setCount(rhs.size());
    rhs.pHead = rhs.pTail = nullptr;
-   rhs.numElements = 0;
+   rhs.setCount(0);
+   rhs.forgetFinger();
 }
 
 /**********************************************
@@ -304,6 +901,8 @@ list <T> ::list(list <T>&& rhs)  : pHead(rhs.pHead), pTail(rhs.pTail), numElemen
 template <typename T>
 list <T>& list <T> :: operator = (list <T> && rhs)
 {
+   LIST_TRACE_OP(MOVE_ASSIGN);
+   LIST_STATS_OP(OTHER);
    // Create iterators for side-by-side lists
    auto itRhs = rhs.begin();
    auto itLhs = begin();
@@ -339,7 +938,9 @@ list <T>& list <T> :: operator = (list <T> && rhs)
 
 /**********************************************
  * LIST :: assignment operator
- * Copy one list onto another
+ * Copy one list onto another. The nodes we already have
+ * are reused; any more we need are allocated as one run
+ * and linked onto the end in a single step.
  *     INPUT  : a list to be copied
  *     OUTPUT :
  *     COST   : O(n) with respect to the number of nodes
@@ -347,33 +948,48 @@ list <T>& list <T> :: operator = (list <T> && rhs)
 template <typename T>
 list <T> & list <T> :: operator = (list <T> & rhs)
 {
-   // Create iterators for side-by-side lists
-   auto itRhs = rhs.begin();
-   auto itLhs = begin();
-   // Copy rhs to lhs until one list is empty
-   while (itRhs != rhs.end() && itLhs != end())
+   LIST_TRACE_OP(COPY_ASSIGN);
+   LIST_STATS_OP(COPY_ASSIGN);
+   // Copy rhs onto the nodes lhs already has
+   Node * pLhs = pHead;
+   Node * pRhs = rhs.pHead;
+   while (pRhs && pLhs)
    {
-      *itLhs = *itRhs;
-      ++itLhs;
-      ++itRhs;
+      pLhs->data = pRhs->data;
+      pLhs = pLhs->pNext;
+      pRhs = pRhs->pNext;
    }
-   // If rhs is longer than lhs, create new nodes on lhs
-   if (itRhs != rhs.end())
+
+   // If rhs is longer than lhs, copy the rest as one chain
+   if (pRhs)
    {
-      while (itRhs != rhs.end())
+      Node * pFirst;
+      Node * pLast;
+      copyChain(pRhs, rhs.size() - size(), pFirst, pLast);
+      if (pTail)
       {
-         push_back(*itRhs);
-         ++itRhs;
+         pTail->pNext = pFirst;
+         pFirst->pPrev = pTail;
       }
-      
+      else
+         pHead = pFirst;
+      pTail = pLast;
+      setCount(rhs.size());
    }
+
    // If lhs is longer than rhs, delete extra nodes
-   else if(rhs.empty())
+   else if (rhs.empty())
       clear();
-   
-   else if (itLhs != end())
-      while (itLhs.p)
-         itLhs = erase(itLhs);
+
+   else if (pLhs)
+   {
+      pTail = pLhs->pPrev;
+      pTail->pNext = nullptr;
+      deleteChain(pLhs);
+      setCount(rhs.size());
+      if (fingerIndex >= size())
+         forgetFinger();
+   }
    return *this;
 }
 
@@ -387,6 +1003,8 @@ list <T> & list <T> :: operator = (list <T> & rhs)
 template <typename T>
 list <T>& list <T> :: operator = (const std::initializer_list<T>& rhs)
 {
+   LIST_TRACE_OP(INIT_ASSIGN);
+   LIST_STATS_OP(OTHER);
    auto itLhs = begin();
    // Loop through rhs list
    for (auto item : rhs)
@@ -421,129 +1039,893 @@ list <T>& list <T> :: operator = (const std::initializer_list<T>& rhs)
 template <typename T>
 void list <T> :: clear()
 {
-   while (pHead != nullptr)
-   {
-      auto pDelete = pHead;
-      pHead = pHead->pNext;
-      delete pDelete;
-      numElements--;
-   }
-   pTail = nullptr;
-   
+   LIST_TRACE_OP(CLEAR);
+   deleteChain(pHead);
+   pHead = pTail = nullptr;
+   setCount(0);
+   forgetFinger();
 }
 
-/*********************************************
- * LIST :: PUSH BACK
- * add an item to the end of the list
- *    INPUT  : data to be added to the list
- *    OUTPUT :
- *    COST   : O(1)
+/**********************************************
+ * LIST :: COPY TO
+ * Copy every item, in order, into an array
+ *     INPUT  : the array, with room for size() items
+ *     OUTPUT : just past the last item written
+ *     COST   : O(n)
  *********************************************/
 template <typename T>
-void list <T> :: push_back(const T & data)
+T * list <T> :: copy_to(T * out) const
 {
-   if(pHead == nullptr)
-   {
-      pHead = pTail = new list <T> ::Node(data);
-   }
-   else
-   {
-      auto newElement = new list <T> ::Node(data);
-      newElement->pPrev = pTail;
-      pTail->pNext = newElement;
-      pTail = newElement;
-   }
-   numElements++;
-   
+   for (const Node * p = pHead; p; p = p->pNext)
+      *out++ = p->data;
+   return out;
 }
 
+/**********************************************
+ * LIST :: TO VECTOR
+ * Copy every item, in order, into a vector which is
+ * sized exactly once
+ *     INPUT  :
+ *     OUTPUT : the vector
+ *     COST   : O(n)
+ *********************************************/
 template <typename T>
-void list <T> ::push_back(T && data)
+std::vector<T> list <T> :: to_vector() const
 {
-   if(pHead == nullptr)
-   {
-      pHead = pTail = new list <T> ::Node(data);
-   }
-   else
-   {
-      auto newElement = new list <T> ::Node(data);
-      newElement->pPrev = pTail;
-      pTail->pNext = newElement;
-      pTail = newElement;
-   }
-   numElements++;
-   
-   
+   std::vector<T> items;
+   items.reserve(size());
+   for (const Node * p = pHead; p; p = p->pNext)
+      items.push_back(p->data);
+   return items;
 }
 
-/*********************************************
- * LIST :: PUSH FRONT
- * add an item to the head of the list
- *     INPUT  : data to be added to the list
- *     OUTPUT :
- *     COST   : O(1)
+/**********************************************
+ * LIST :: DRAIN TO
+ * Move every item out, in order, and free all of the
+ * nodes with one trip to the pool. If writing an item
+ * throws, the items already written are taken off and
+ * the rest stay in the list.
+ *     INPUT  : where to put the items
+ *     OUTPUT : just past the last item written
+ *     COST   : O(n)
  *********************************************/
 template <typename T>
-void list <T> :: push_front(const T & data)
+template <class OutputIterator>
+OutputIterator list <T> :: drain_to(OutputIterator out)
 {
-   if(pTail == nullptr)
+   LIST_TRACE_OP(DRAIN);
+   size_t num = 0;
+   try
    {
-      pHead = pTail = new list <T> ::Node(data);
+      for (Node * p = pHead; p; p = p->pNext, num++)
+      {
+         *out = std::move(p->data);
+         ++out;
+      }
    }
-   else
+   catch (...)
    {
-      auto newElement = new list <T> ::Node(data);
-      newElement->pNext = pHead;
-      pHead->pPrev = newElement;
-      pHead = newElement;
+      deleteChain(detachFront(num));
+      throw;
    }
-   numElements++;
+   deleteChain(detachFront(num));
+   return out;
 }
 
+/**********************************************
+ * LIST :: WRITE
+ * Save every item in a compact binary form: a 16 byte
+ * header with the number of items, then the items. Both
+ * ends must agree on byte order and on sizeof(T); the
+ * header lets read() notice when sizeof(T) differs.
+ *     INPUT  : a stream, or a buffer to append to
+ *     OUTPUT :
+ *     COST   : O(n)
+ *********************************************/
 template <typename T>
-void list <T> ::push_front(T && data)
+void list <T> :: write(std::ostream & out) const
 {
-   if(pTail == nullptr)
-   {
-      pHead = pTail = new list <T> ::Node(data);
-   }
-   else
-   {
-      auto newElement = new list <T> ::Node(data);
-      newElement->pNext = pHead;
-      pHead->pPrev = newElement;
-      pHead = newElement;
-   }
-   numElements++;
+   io::streamSink sink(out);
+   writeTo(sink);
 }
 
-
-/*********************************************
- * LIST :: POP BACK
- * remove an item from the end of the list
- *    INPUT  : 
- *    OUTPUT :
- *    COST   : O(1)
- *********************************************/
 template <typename T>
-void list <T> ::pop_back()
+void list <T> :: write(std::vector<char> & buffer) const
 {
-   erase(iterator(pTail));
+   io::bufferSink sink(buffer);
+   if (std::is_trivially_copyable<T>::value)
+      sink.reserve(sizeof(Header) + size() * sizeof(T));
+   writeTo(sink);
 }
 
-/*********************************************
- * LIST :: POP FRONT
- * remove an item from the front of the list
- *    INPUT  :
- *    OUTPUT :
- *    COST   : O(1)
+/**********************************************
+ * LIST :: READ
+ * Replace the items with ones saved by write(). If the
+ * input is cut short or is not a list of T, this
+ * throws and the list is left as it was.
+ *     INPUT  : a stream, or a buffer and its size
+ *     OUTPUT : for a buffer, how many bytes were used
+ *     COST   : O(n)
  *********************************************/
 template <typename T>
-void list <T> ::pop_front()
+void list <T> :: read(std::istream & in)
 {
+   io::streamSource source(in);
+   readFrom(source);
+}
+
+template <typename T>
+size_t list <T> :: read(const char * buffer, size_t size)
+{
+   io::bufferSource source(buffer, size);
+   readFrom(source);
+   return source.position() - buffer;
+}
+
+/**********************************************
+ * LIST :: WRITE TO
+ *     INPUT  : where to put the bytes
+ *     OUTPUT :
+ *     COST   : O(n)
+ *********************************************/
+template <typename T>
+template <class Sink>
+void list <T> :: writeTo(Sink & out) const
+{
+   Header header = { { 'C', 'L', 'S', 'T' },
+                     std::is_trivially_copyable<T>::value ? (uint32_t)sizeof(T) : 0,
+                     size() };
+   out.write(&header, sizeof(header));
+   writeItems(out, std::is_trivially_copyable<T>());
+}
+
+/**********************************************
+ * LIST :: WRITE ITEMS - TRIVIALLY COPYABLE
+ * Gather the items into a block and write the whole
+ * block at once
+ *     INPUT  : where to put the bytes
+ *     OUTPUT :
+ *     COST   : O(n) with one write per block
+ *********************************************/
+template <typename T>
+template <class Sink>
+void list <T> :: writeItems(Sink & out, std::true_type) const
+{
+   const size_t blockItems = ioBlockBytes / sizeof(T) ? ioBlockBytes / sizeof(T) : 1;
+   std::vector<char> block(sizeof(T) * (size() < blockItems ? size() : blockItems));
+   const Node * p = pHead;
+   while (p)
+   {
+      size_t num = 0;
+      for (; p && num < blockItems; p = p->pNext, num++)
+         std::memcpy(block.data() + num * sizeof(T), &p->data, sizeof(T));
+      out.write(block.data(), num * sizeof(T));
+   }
+}
+
+/**********************************************
+ * LIST :: WRITE ITEMS
+ * Every item goes through list_serializer
+ *     INPUT  : where to put the bytes
+ *     OUTPUT :
+ *     COST   : O(n)
+ *********************************************/
+template <typename T>
+template <class Sink>
+void list <T> :: writeItems(Sink & out, std::false_type) const
+{
+   for (const Node * p = pHead; p; p = p->pNext)
+      list_serializer<T>::write(out, p->data);
+}
+
+/**********************************************
+ * LIST :: READ FROM
+ * Check the header, build the new items into a list
+ * of their own, and only then take its nodes
+ *     INPUT  : where to get the bytes
+ *     OUTPUT :
+ *     COST   : O(n)
+ *********************************************/
+template <typename T>
+template <class Source>
+void list <T> :: readFrom(Source & in)
+{
+   Header header;
+   in.read(&header, sizeof(header));
+   if (std::memcmp(header.magic, "CLST", 4) != 0)
+      throw "ERROR: this is not a saved list";
+   if (header.itemSize != (std::is_trivially_copyable<T>::value ? sizeof(T) : 0))
+      throw "ERROR: the saved list holds a different type";
+
+   list <T> items;
+   items.readItems(in, (size_t)header.numItems, std::is_trivially_copyable<T>());
+   swap(items);
+}
+
+/**********************************************
+ * LIST :: READ ITEMS - TRIVIALLY COPYABLE
+ * Read a block of items at a time, then build their
+ * nodes in one run of slots, adjacent with LIST_POOL.
+ * The block is read before the slots are taken, so a
+ * short input never leaves half-built nodes behind.
+ *     INPUT  : where to get the bytes, and how many items
+ *     OUTPUT :
+ *     COST   : O(n) with one read and one trip to the pool per block
+ *********************************************/
+template <typename T>
+template <class Source>
+void list <T> :: readItems(Source & in, size_t num, std::true_type)
+{
+   const size_t blockItems = ioBlockBytes / sizeof(T) ? ioBlockBytes / sizeof(T) : 1;
+   std::vector<char> block(sizeof(T) * (num < blockItems ? num : blockItems));
+   while (num)
+   {
+      size_t numBlock = num < blockItems ? num : blockItems;
+      in.read(block.data(), numBlock * sizeof(T));
+
+      void * pSlots = Node::allocateRun(numBlock);
+      for (size_t i = 0; i < numBlock; i++)
+      {
+         void * pSlot = pSlots;
+         pSlots = *static_cast<void **>(pSlot);
+         Node * pNew = new (pSlot) Node(*reinterpret_cast<const T *>(block.data() + i * sizeof(T)));
+         pNew->pPrev = pTail;
+         if (pTail)
+            pTail->pNext = pNew;
+         else
+            pHead = pNew;
+         pTail = pNew;
+      }
+      countBack(numBlock);
+      num -= numBlock;
+   }
+}
+
+/**********************************************
+ * LIST :: READ ITEMS
+ * Every item comes through list_serializer
+ *     INPUT  : where to get the bytes, and how many items
+ *     OUTPUT :
+ *     COST   : O(n)
+ *********************************************/
+template <typename T>
+template <class Source>
+void list <T> :: readItems(Source & in, size_t num, std::false_type)
+{
+   for (; num; num--)
+   {
+      Node * pNew = new Node(list_serializer<T>::read(in));
+      pNew->pPrev = pTail;
+      if (pTail)
+         pTail->pNext = pNew;
+      else
+         pHead = pNew;
+      pTail = pNew;
+      countBack(1);
+   }
+}
+
+/**********************************************
+ * LIST :: COMPACT
+ * Move every item into one block of adjacent nodes, in
+ * list order, so a traversal walks straight through
+ * memory. A list which is already laid out that way is
+ * left alone. Without LIST_POOL the new nodes are only
+ * allocated in list order, which is as close as the
+ * global new lets us get.
+ *
+ * Every iterator into the list is invalidated: the old
+ * nodes are freed. If moving an item can throw, the items
+ * are copied instead, and if that throws the list is left
+ * as it was.
+ *     INPUT  :
+ *     OUTPUT :
+ *     COST   : O(n) with respect to the number of nodes
+ *********************************************/
+template <typename T>
+void list <T> :: compact()
+{
+   LIST_TRACE_OP(COMPACT);
+   LIST_STATS_OP(OTHER);
+
+   // nothing to do if every node is already followed by its neighbor
+   bool inOrder = true;
+   for (Node * p = pHead; p && p->pNext && inOrder; p = p->pNext)
+      inOrder = (p->pNext == p + 1);
+   if (inOrder)
+      return;
+
+   void * pSlots = Node::allocateRun(size());
+   void * pSlot = nullptr;
+   Node * pFirst = nullptr;
+   Node * pLast = nullptr;
+   try
+   {
+      for (Node * p = pHead; p; p = p->pNext)
+      {
+         pSlot = pSlots;
+         pSlots = *static_cast<void **>(pSlot);
+         Node * pNew = new (pSlot) Node(std::move_if_noexcept(p->data));
+         pSlot = nullptr;
+         pNew->pPrev = pLast;
+         if (pLast)
+            pLast->pNext = pNew;
+         else
+            pFirst = pNew;
+         pLast = pNew;
+      }
+   }
+   catch (...)
+   {
+      // the nodes we finished, then the slot that threw, then the rest
+      deleteChain(pFirst);
+      Node::operator delete(pSlot);
+      while (pSlots)
+      {
+         void * pFree = pSlots;
+         pSlots = *static_cast<void **>(pSlots);
+         Node::operator delete(pFree);
+      }
+      throw;
+   }
+
+   deleteChain(pHead);
+   pHead = pFirst;
+   pTail = pLast;
+   forgetFinger();
+}
+
+/**********************************************
+ * LIST :: SORT
+ * Put the items in order by relinking the nodes. No
+ * item is copied or moved and nothing is allocated, so
+ * iterators stay valid and follow their items. Equal
+ * items keep their order. If comp throws, every item
+ * is still in the list, but in no particular order.
+ *     INPUT  : how to compare two items
+ *     OUTPUT :
+ *     COST   : O(n log n)
+ *********************************************/
+template <typename T>
+template <class Compare>
+void list <T> :: sort(Compare comp)
+{
+   LIST_TRACE_OP(SORT);
+   if (size() < 2)
+      return;
+
+   Chain chain = { pHead, pTail };
+   forgetFinger();
+   try
+   {
+      sortChain(chain, comp);
+   }
+   catch (...)
+   {
+      pHead = chain.pFirst;
+      pTail = chain.pLast;
+      throw;
+   }
+   pHead = chain.pFirst;
+   pTail = chain.pLast;
+}
+
+/**********************************************
+ * LIST :: SORT CHAIN
+ * Bottom-up merge sort. Bin i holds a sorted chain of
+ * 2^i nodes, or nothing. Each node is carried in like
+ * adding one to a binary counter, merging full bins
+ * on the way. Earlier nodes are always on the left of
+ * a merge, which keeps the sort stable.
+ *
+ * If comp throws, the bins, the carry and the nodes not
+ * yet reached are joined back into chain before the
+ * exception goes on.
+ *     INPUT  : a detached, null-terminated chain and how to compare
+ *     OUTPUT : the same nodes in order, linked both ways
+ *     COST   : O(n log n)
+ *********************************************/
+template <typename T>
+template <class Compare>
+void list <T> :: sortChain(Chain & chain, Compare & comp)
+{
+   Chain bins[64] = {};
+   int numBins = 0;
+   Chain carry = { nullptr, nullptr };
+   Node * pFirst = chain.pFirst;   // the first node not reached yet
+
+   try
+   {
+      while (pFirst)
+      {
+         carry.pFirst = carry.pLast = pFirst;
+         pFirst = pFirst->pNext;
+         carry.pFirst->pNext = nullptr;
+         carry.pFirst->pPrev = nullptr;
+
+         int i = 0;
+         for (; i < numBins && bins[i].pFirst; i++)
+         {
+            mergeChains(bins[i], carry, comp);
+            std::swap(bins[i], carry);
+         }
+         std::swap(bins[i], carry);
+         if (i == numBins)
+            numBins++;
+      }
+
+      // the higher bins hold the earlier nodes
+      for (int i = 0; i < numBins; i++)
+      {
+         mergeChains(bins[i], carry, comp);
+         std::swap(bins[i], carry);
+      }
+   }
+   catch (...)
+   {
+      Chain rest = { pFirst, pFirst ? chain.pLast : nullptr };
+      chain.pFirst = chain.pLast = nullptr;
+      for (int i = numBins - 1; i >= 0; i--)
+         joinChains(chain, bins[i]);
+      joinChains(chain, carry);
+      joinChains(chain, rest);
+      throw;
+   }
+   chain = carry;
+}
+
+/**********************************************
+ * LIST :: MERGE CHAINS
+ * Merge sorted chain b into sorted chain a, leaving b
+ * empty. On a tie the node from a goes first. If comp
+ * throws, a still ends up with every node of both,
+ * though not in order.
+ *     INPUT  : two sorted chains and how to compare
+ *     OUTPUT : a holds one sorted chain, linked both ways
+ *     COST   : O(n)
+ *********************************************/
+template <typename T>
+template <class Compare>
+void list <T> :: mergeChains(Chain & a, Chain & b, Compare & comp)
+{
+   if (a.pFirst == nullptr)
+      std::swap(a, b);
+   if (b.pFirst == nullptr)
+      return;
+
+   Node * pA = a.pFirst;
+   Node * pB = b.pFirst;
+   Chain merged = { nullptr, nullptr };
+   try
+   {
+      while (pA && pB)
+      {
+         Node * p;
+         if (comp(pB->data, pA->data))
+         {
+            p = pB;
+            pB = pB->pNext;
+         }
+         else
+         {
+            p = pA;
+            pA = pA->pNext;
+         }
+         p->pPrev = merged.pLast;
+         if (merged.pLast)
+            merged.pLast->pNext = p;
+         else
+            merged.pFirst = p;
+         merged.pLast = p;
+      }
+   }
+   catch (...)
+   {
+      // what was merged, then the rest of each
+      Chain restA = { pA, a.pLast };
+      Chain restB = { pB, b.pLast };
+      joinChains(merged, restA);
+      joinChains(merged, restB);
+      a = merged;
+      b.pFirst = b.pLast = nullptr;
+      throw;
+   }
+
+   // whatever is left is already in order
+   Node * pRest = pA ? pA : pB;
+   merged.pLast->pNext = pRest;
+   pRest->pPrev = merged.pLast;
+   merged.pLast = pA ? a.pLast : b.pLast;
+   a = merged;
+   b.pFirst = b.pLast = nullptr;
+}
+
+/**********************************************
+ * LIST :: JOIN CHAINS
+ * Put chain b on the end of chain a, leaving b empty
+ *     INPUT  : two chains
+ *     OUTPUT : a holds both, linked both ways
+ *     COST   : O(1)
+ *********************************************/
+template <typename T>
+void list <T> :: joinChains(Chain & a, Chain & b)
+{
+   if (b.pFirst == nullptr)
+      return;
+   b.pFirst->pPrev = a.pLast;
+   if (a.pLast)
+      a.pLast->pNext = b.pFirst;
+   else
+      a.pFirst = b.pFirst;
+   a.pLast = b.pLast;
+   b.pFirst = b.pLast = nullptr;
+}
+
+/**********************************************
+ * LIST :: COPY CHAIN
+ * Copy num nodes starting at pSrc into one run of
+ * nodes, adjacent with LIST_POOL. The items are only
+ * bytes, so they are copied with memcpy, which can not
+ * throw, and the links are set in the same pass.
+ *     INPUT  : the first node to copy and how many
+ *     OUTPUT : the ends of the new, detached chain
+ *     COST   : O(n) with one trip to the pool
+ *********************************************/
+template <typename T>
+void list <T> :: copyChain(const Node * pSrc, size_t num, Node * & pFirst, Node * & pLast, std::true_type)
+{
+   assert(num > 0);
+   void * pSlots = Node::allocateRun(num);
+   pFirst = pLast = nullptr;
+   for (; num; num--, pSrc = pSrc->pNext)
+   {
+      // take the link to the next slot before the item covers it
+      Node * pNew = static_cast<Node *>(pSlots);
+      pSlots = *static_cast<void **>(pSlots);
+      std::memcpy(static_cast<void *>(&pNew->data), &pSrc->data, sizeof(T));
+      pNew->pPrev = pLast;
+      pNew->pNext = nullptr;
+      if (pLast)
+         pLast->pNext = pNew;
+      else
+         pFirst = pNew;
+      pLast = pNew;
+   }
+}
+
+/**********************************************
+ * LIST :: COPY CHAIN
+ * Copy num nodes starting at pSrc into nodes which are
+ * all allocated at once, linked front to back
+ *     INPUT  : the first node to copy and how many
+ *     OUTPUT : the ends of the new, detached chain
+ *     COST   : O(n) with one trip to the pool
+ *********************************************/
+template <typename T>
+void list <T> :: copyChain(const Node * pSrc, size_t num, Node * & pFirst, Node * & pLast, std::false_type)
+{
+   assert(num > 0);
+   pFirst = copyRun(pSrc, num, Node::allocate(num));
+
+   // one pass to link the chain in both directions
+   Node * pPrev = nullptr;
+   for (Node * p = pFirst; p; p = p->pNext)
+   {
+      p->pPrev = pPrev;
+      pPrev = p;
+   }
+   pLast = pPrev;
+}
+
+/**********************************************
+ * LIST :: COPY RUN
+ * Copy construct the data into the slots. If one of
+ * the copies throws, destroy what we built and give
+ * every slot back.
+ *     INPUT  : the first node to copy, how many, and the slots
+ *     OUTPUT : the first new node, linked forward
+ *     COST   : O(n)
+ *********************************************/
+template <typename T>
+typename list <T> :: Node * list <T> :: copyRun(const Node * pSrc, size_t num, void * pRun)
+{
+   Node * pFirst = nullptr;
+   Node ** ppLink = &pFirst;
+   void * pSlot = nullptr;
+   try
+   {
+      for (; num; num--, pSrc = pSrc->pNext)
+      {
+         pSlot = pRun;
+         pRun = *static_cast<void **>(pRun);
+         *ppLink = new (pSlot) Node(pSrc->data);
+         ppLink = &(*ppLink)->pNext;
+      }
+   }
+   catch (...)
+   {
+      // the nodes we finished, then the slot that threw, then the rest
+      *ppLink = nullptr;
+      while (pFirst)
+      {
+         Node * pDelete = pFirst;
+         pFirst = pFirst->pNext;
+         delete pDelete;
+      }
+      Node::operator delete(pSlot);
+      while (pRun)
+      {
+         void * pFree = pRun;
+         pRun = *static_cast<void **>(pRun);
+         Node::operator delete(pFree);
+      }
+      throw;
+   }
+   return pFirst;
+}
+
+/**********************************************
+ * LIST :: DELETE CHAIN
+ * Destroy a detached, null-terminated chain of nodes and
+ * free them all together, in one trip with LIST_POOL
+ *     INPUT  : the first node of the chain
+ *     OUTPUT :
+ *     COST   : O(n) with respect to the number of nodes
+ *********************************************/
+template <typename T>
+void list <T> :: deleteChain(Node * pFirst)
+{
+   if (pFirst == nullptr)
+      return;
+
+   // each destroyed node points to the next through its first word
+   Node * pDelete = pFirst;
+   Node * pLast;
+   size_t num = 0;
+   do
+   {
+      Node * pNext = pDelete->pNext;
+      pDelete->~Node();
+      *reinterpret_cast<Node **>(pDelete) = pNext;
+      pLast = pDelete;
+      pDelete = pNext;
+      num++;
+   }
+   while (pDelete);
+
+   Node::release(pFirst, pLast, num);
+}
+
+/*********************************************
+ * LIST :: PUSH BACK
+ * add an item to the end of the list
+ *    INPUT  : data to be added to the list
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void list <T> :: push_back(const T & data)
+{
+   LIST_TRACE_OP(PUSH_BACK);
+   LIST_STATS_OP(PUSH);
+   if(pHead == nullptr)
+   {
+      pHead = pTail = new list <T> ::Node(data);
+   }
+   else
+   {
+      auto newElement = new list <T> ::Node(data);
+      newElement->pPrev = pTail;
+      pTail->pNext = newElement;
+      pTail = newElement;
+   }
+   countBack(1);
+   
+}
+
+template <typename T>
+void list <T> ::push_back(T && data)
+{
+   LIST_TRACE_OP(PUSH_BACK);
+   LIST_STATS_OP(PUSH);
+   if(pHead == nullptr)
+   {
+      pHead = pTail = new list <T> ::Node(data);
+   }
+   else
+   {
+      auto newElement = new list <T> ::Node(data);
+      newElement->pPrev = pTail;
+      pTail->pNext = newElement;
+      pTail = newElement;
+   }
+   countBack(1);
+   
+   
+}
+
+/*********************************************
+ * LIST :: PUSH BACK BULK
+ * Add a range of items to the end. The new nodes are
+ * built into a detached chain first and then linked on
+ * with one relink, so if a copy throws the list is left
+ * as it was.
+ *    INPUT  : the range of items to add
+ *    OUTPUT :
+ *    COST   : O(n) with respect to the range
+ *********************************************/
+template <typename T>
+template <class Iterator>
+void list <T> :: push_back_bulk(Iterator first, Iterator last)
+{
+   LIST_TRACE_OP(PUSH_BACK_BULK);
+   LIST_STATS_OP(PUSH);
+   list <T> chain;
+   try
+   {
+      Node ** ppLink = &chain.pHead;
+      for (; first != last; ++first)
+      {
+         Node * pNew = new Node(*first);
+         pNew->pPrev = chain.pTail;
+         *ppLink = chain.pTail = pNew;
+         ppLink = &pNew->pNext;
+         chain.countBack(1);
+      }
+   }
+   catch (...)
+   {
+      deleteChain(chain.pHead);
+      chain.pHead = chain.pTail = nullptr;
+      chain.setCount(0);
+      throw;
+   }
+   splice(end(), chain);
+}
+
+/*********************************************
+ * LIST :: PUSH FRONT
+ * add an item to the head of the list
+ *     INPUT  : data to be added to the list
+ *     OUTPUT :
+ *     COST   : O(1)
+ *********************************************/
+template <typename T>
+void list <T> :: push_front(const T & data)
+{
+   LIST_TRACE_OP(PUSH_FRONT);
+   LIST_STATS_OP(PUSH);
+   if(pTail == nullptr)
+   {
+      pHead = pTail = new list <T> ::Node(data);
+   }
+   else
+   {
+      auto newElement = new list <T> ::Node(data);
+      newElement->pNext = pHead;
+      pHead->pPrev = newElement;
+      pHead = newElement;
+   }
+   countFront(1);
+   fingerIndex++;
+}
+
+template <typename T>
+void list <T> ::push_front(T && data)
+{
+   LIST_TRACE_OP(PUSH_FRONT);
+   LIST_STATS_OP(PUSH);
+   if(pTail == nullptr)
+   {
+      pHead = pTail = new list <T> ::Node(data);
+   }
+   else
+   {
+      auto newElement = new list <T> ::Node(data);
+      newElement->pNext = pHead;
+      pHead->pPrev = newElement;
+      pHead = newElement;
+   }
+   countFront(1);
+   fingerIndex++;
+}
+
+
+/*********************************************
+ * LIST :: POP BACK
+ * remove an item from the end of the list
+ *    INPUT  : 
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void list <T> ::pop_back()
+{
+   LIST_TRACE_OP(POP_BACK);
+   erase(iterator(pTail));
+}
+
+/*********************************************
+ * LIST :: POP FRONT
+ * remove an item from the front of the list
+ *    INPUT  :
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void list <T> ::pop_front()
+{
+   LIST_TRACE_OP(POP_FRONT);
    erase(iterator(pHead));
 }
 
+/*********************************************
+ * LIST :: POP FRONT BULK
+ * Move up to max_n items from the front into out, then
+ * cut their nodes off with one relink and free them
+ * with one trip to the pool. If writing an item throws,
+ * the items already written are still taken off, so
+ * the list holds exactly what was not delivered.
+ *    INPUT  : where to put the items, and at most how many
+ *    OUTPUT : how many were taken
+ *    COST   : O(max_n)
+ *********************************************/
+template <typename T>
+template <class OutputIterator>
+size_t list <T> :: pop_front_bulk(OutputIterator out, size_t max_n)
+{
+   LIST_TRACE_OP(POP_FRONT_BULK);
+   size_t num = 0;
+   try
+   {
+      for (Node * p = pHead; p && num < max_n; p = p->pNext, num++)
+      {
+         *out = std::move(p->data);
+         ++out;
+      }
+   }
+   catch (...)
+   {
+      deleteChain(detachFront(num));
+      throw;
+   }
+   deleteChain(detachFront(num));
+   return num;
+}
+
+/*********************************************
+ * LIST :: DETACH FRONT
+ * Cut the first num nodes off the list
+ *    INPUT  : how many, no more than size()
+ *    OUTPUT : the detached, null-terminated chain
+ *    COST   : O(num)
+ *********************************************/
+template <typename T>
+typename list <T> :: Node * list <T> :: detachFront(size_t num)
+{
+   assert(num <= size());
+   if (num == 0)
+      return nullptr;
+
+   Node * pFirst = pHead;
+   Node * pLast = pHead;
+   for (size_t i = 1; i < num; i++)
+      pLast = pLast->pNext;
+
+   pHead = pLast->pNext;
+   if (pHead)
+      pHead->pPrev = nullptr;
+   else
+      pTail = nullptr;
+   pLast->pNext = nullptr;
+   countFront(-(ptrdiff_t)num);
+   if (fingerIndex < num)
+      forgetFinger();
+   else
+      fingerIndex -= num;
+   return pFirst;
+}
+
 /*********************************************
  * LIST :: FRONT
  * retrieves the first element in the list
@@ -576,6 +1958,178 @@ T & list <T> :: back()
       throw "ERROR: unable to access data from an empty list";
 }
 
+/*********************************************
+ * LIST :: AT
+ * The item at a position
+ *     INPUT  : the position
+ *     OUTPUT : the item there
+ *     COST   : O(distance) from the head, the tail or
+ *              the last position looked up
+ *********************************************/
+template <typename T>
+T & list <T> :: at(size_t index)
+{
+   Node * p = nodeAt(index);
+   if (p)
+      return p->data;
+   else
+      throw "ERROR: index out of range";
+}
+
+/*********************************************
+ * LIST :: ITERATOR AT
+ * An iterator to the item at a position
+ *     INPUT  : the position
+ *     OUTPUT : the iterator, or end() past the end
+ *     COST   : O(distance) from the head, the tail or
+ *              the last position looked up
+ *********************************************/
+template <typename T>
+typename list <T> :: iterator list <T> :: iterator_at(size_t index)
+{
+   return iterator(nodeAt(index));
+}
+
+/*********************************************
+ * LIST :: NODE AT
+ * Walk to a position from whichever is nearest: the
+ * head, the tail, or the finger. The node found becomes
+ * the finger, so reading lines 500, 501, 502... costs
+ * one step each rather than 500.
+ *     INPUT  : the position
+ *     OUTPUT : the node there, or nullptr past the end
+ *     COST   : O(distance)
+ *********************************************/
+template <typename T>
+typename list <T> :: Node * list <T> :: nodeAt(size_t index)
+{
+   if (index >= size())
+      return nullptr;
+
+   Node * p = pHead;
+   size_t position = 0;
+   size_t distance = index;
+   if (size() - 1 - index < distance)
+   {
+      p = pTail;
+      position = size() - 1;
+      distance = size() - 1 - index;
+   }
+   if (pFinger)
+   {
+      size_t fromFinger = index > fingerIndex ? index - fingerIndex : fingerIndex - index;
+      if (fromFinger < distance)
+      {
+         p = pFinger;
+         position = fingerIndex;
+      }
+   }
+
+   for (; position < index; position++)
+      p = p->pNext;
+   for (; position > index; position--)
+      p = p->pPrev;
+
+   pFinger = p;
+   fingerIndex = index;
+   return p;
+}
+
+/*********************************************
+ * LIST :: MOVE FINGER FOR INSERT
+ * A node is about to go in just before pBefore. Keep
+ * the finger's position right if we can tell cheaply
+ * which side of it the node lands on, else forget it.
+ *     INPUT  : the node the new one goes in front of
+ *     OUTPUT :
+ *     COST   : O(1)
+ *********************************************/
+template <typename T>
+void list <T> :: moveFingerForInsert(const Node * pBefore)
+{
+   if (pFinger == nullptr)
+      return;
+   if (pBefore == pFinger || pBefore == pHead)
+      fingerIndex++;
+   else if (pBefore != pFinger->pNext)
+      forgetFinger();
+}
+
+/*********************************************
+ * LIST :: MOVE FINGER FOR ERASE
+ * A node is about to be erased. If it is the finger,
+ * the finger moves to a neighbor; otherwise keep the
+ * position right if we can tell cheaply which side the
+ * node is on, else forget it.
+ *     INPUT  : the node going away
+ *     OUTPUT :
+ *     COST   : O(1)
+ *********************************************/
+template <typename T>
+void list <T> :: moveFingerForErase(const Node * pErase)
+{
+   if (pFinger == nullptr)
+      return;
+   if (pErase == pFinger)
+   {
+      if (pFinger->pNext)
+         pFinger = pFinger->pNext;
+      else if (pFinger->pPrev)
+      {
+         pFinger = pFinger->pPrev;
+         fingerIndex--;
+      }
+      else
+         forgetFinger();
+   }
+   else if (pErase == pFinger->pPrev || pErase == pHead)
+      fingerIndex--;
+   else if (pErase != pFinger->pNext && pErase != pTail)
+      forgetFinger();
+}
+
+/*********************************************
+ * LIST :: FOR EACH PREFETCH
+ * Call f on every item, front to back, while asking
+ * the CPU to fetch the node distance steps ahead. The
+ * walk ahead is still one pointer at a time, but its
+ * misses now overlap with the work f does.
+ *    INPUT  : the function and how far ahead to fetch
+ *    OUTPUT :
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+template <class Function>
+void list <T> :: for_each_prefetch(Function f, size_t distance)
+{
+   // start the look-ahead distance nodes in
+   Node * pAhead = (distance ? pHead : nullptr);
+   for (size_t i = 0; i < distance && pAhead; i++)
+   {
+      pAhead = pAhead->pNext;
+      if (pAhead)
+      {
+         LIST_PREFETCH(pAhead);
+         LIST_PREFETCH(&pAhead->pNext);
+      }
+   }
+
+   for (Node * p = pHead; p; p = p->pNext)
+   {
+      // pAhead was fetched on an earlier trip through the loop
+      if (pAhead)
+      {
+         pAhead = pAhead->pNext;
+         if (pAhead)
+         {
+            LIST_PREFETCH(pAhead);
+            LIST_PREFETCH(&pAhead->pNext);
+         }
+      }
+      f(p->data);
+   }
+}
+
 /******************************************
  * LIST :: REMOVE
  * remove an item from the middle of the list
@@ -586,8 +2140,10 @@ T & list <T> :: back()
 template <typename T>
 typename list <T> :: iterator  list <T> :: erase(const list <T> :: iterator & it)
 {
+   LIST_TRACE_OP(ERASE);
    if (it.p == nullptr)
       return nullptr;
+   moveFingerForErase(it.p);
 
    if (it.p->pPrev)           // Take care of the previous node
       it.p->pPrev->pNext = it.p->pNext;
@@ -614,8 +2170,11 @@ typename list <T> :: iterator  list <T> :: erase(const list <T> :: iterator & it
    else
       pReturn = nullptr;
 
+   if (it.p->pPrev == nullptr)
+      countFront(-1);
+   else
+      countBack(-1);
    delete it.p;
-   numElements--;
    return pReturn;
 }
 
@@ -631,10 +2190,12 @@ template <typename T>
 typename list <T> :: iterator list <T> :: insert(list <T> :: iterator it,
                                                  const T & data) 
 {
+   LIST_TRACE_OP(INSERT);
+   LIST_STATS_OP(INSERT);
    // Inserting if empty
    if (empty()) {
       pHead = pTail = new list<T>::Node(data);
-      numElements = 1;
+      setCount(1);
       return begin();
    }
 
@@ -646,40 +2207,40 @@ typename list <T> :: iterator list <T> :: insert(list <T> :: iterator it,
       pTail->pNext = pNew;
       pNew->pPrev = pTail;
       pTail = pNew;
-      numElements++;
+      countBack(1);
       return iterator(pNew);
    }
 
    // Inserting at the beginning or middle
-   else if (it != end())
-   {
-      auto pNew = new list<T>::Node(data);
-      pNew->pPrev = it.p->pPrev;
-      pNew->pNext = it.p;
+   auto pNew = new list<T>::Node(data);
+   moveFingerForInsert(it.p);
+   pNew->pPrev = it.p->pPrev;
+   pNew->pNext = it.p;
 
-      if (pNew->pPrev)
-         pNew->pPrev->pNext = pNew;
-      else
-         pHead = pNew;
+   if (pNew->pPrev)
+      pNew->pPrev->pNext = pNew;
+   else
+      pHead = pNew;
 
-      if (pNew->pNext)
-         pNew->pNext->pPrev = pNew;
-      else
-         pTail = pNew;
+   if (pNew->pNext)
+      pNew->pNext->pPrev = pNew;
+   else
+      pTail = pNew;
 
-      numElements++;
-      return iterator(pNew);
-   }
+   countBack(1);
+   return iterator(pNew);
 }
 
 template <typename T>
 typename list <T> :: iterator list <T> :: insert(list <T> :: iterator it,
    T && data)
 {
+   LIST_TRACE_OP(INSERT);
+   LIST_STATS_OP(INSERT);
    // Inserting if empty
    if (empty()) {
       pHead = pTail = new list<T>::Node(std::move(data));
-      numElements = 1;
+      setCount(1);
       return begin();
    }
 
@@ -691,30 +2252,74 @@ typename list <T> :: iterator list <T> :: insert(list <T> :: iterator it,
       pTail->pNext = pNew;
       pNew->pPrev = pTail;
       pTail = pNew;
-      numElements++;
+      countBack(1);
       return iterator(pNew);
    }
 
    // Inserting at the beginning or middle
-   else if (it != end())
-   {
-      auto pNew = new list<T>::Node(std::move(data));
-      pNew->pPrev = it.p->pPrev;
-      pNew->pNext = it.p;
+   auto pNew = new list<T>::Node(std::move(data));
+   moveFingerForInsert(it.p);
+   pNew->pPrev = it.p->pPrev;
+   pNew->pNext = it.p;
 
-      if (pNew->pPrev)
-         pNew->pPrev->pNext = pNew;
-      else
-         pHead = pNew;
+   if (pNew->pPrev)
+      pNew->pPrev->pNext = pNew;
+   else
+      pHead = pNew;
 
-      if (pNew->pNext)
-         pNew->pNext->pPrev = pNew;
-      else
-         pTail = pNew;
+   if (pNew->pNext)
+      pNew->pNext->pPrev = pNew;
+   else
+      pTail = pNew;
 
-      numElements++;
-      return iterator(pNew);
-   }
+   countBack(1);
+   return iterator(pNew);
+}
+
+/******************************************
+ * LIST :: SPLICE
+ * Move every node of rhs into this list, in front of
+ * it, without copying an item. Iterators into rhs
+ * now point into this list.
+ *     INPUT  : where to put them, and the list to take them from
+ *     OUTPUT : rhs is left empty
+ *     COST   : O(1)
+ ******************************************/
+template <typename T>
+void list <T> :: splice(iterator it, list <T> & rhs)
+{
+   LIST_TRACE_OP(SPLICE);
+   if (&rhs == this || rhs.empty())
+      return;
+
+   Node * pBefore = it.p ? it.p->pPrev : pTail;
+   Node * pAfter  = it.p;
+
+   // nodes going in at the front push the finger along
+   if (pBefore == nullptr)
+      fingerIndex += rhs.size();
+   else if (pAfter)
+      forgetFinger();
+
+   rhs.pHead->pPrev = pBefore;
+   if (pBefore)
+      pBefore->pNext = rhs.pHead;
+   else
+      pHead = rhs.pHead;
+
+   rhs.pTail->pNext = pAfter;
+   if (pAfter)
+      pAfter->pPrev = rhs.pTail;
+   else
+      pTail = rhs.pTail;
+
+   if (pBefore == nullptr)
+      countFront(rhs.size());
+   else
+      countBack(rhs.size());
+   rhs.pHead = rhs.pTail = nullptr;
+   rhs.setCount(0);
+   rhs.forgetFinger();
 }
 
 /**********************************************
@@ -729,7 +2334,11 @@ void swap(list <T> & lhs, list <T> & rhs)
 {
    std::swap(lhs.pHead, rhs.pHead);
    std::swap(lhs.pTail, rhs.pTail);
-   std::swap(lhs.numElements, rhs.numElements);
+   size_t num = lhs.size();
+   lhs.setCount(rhs.size());
+   rhs.setCount(num);
+   std::swap(lhs.pFinger, rhs.pFinger);
+   std::swap(lhs.fingerIndex, rhs.fingerIndex);
 }
 
 template <typename T>
@@ -737,7 +2346,11 @@ void list<T>::swap(list <T>& rhs)
 {
    std::swap(pHead, rhs.pHead);
    std::swap(pTail, rhs.pTail);
-   std::swap(numElements, rhs.numElements);
+   size_t num = size();
+   setCount(rhs.size());
+   rhs.setCount(num);
+   std::swap(pFinger, rhs.pFinger);
+   std::swap(fingerIndex, rhs.fingerIndex);
 }
 
 //#endif
@@ -0,0 +1,699 @@
+/***********************************************************************
+ * Header:
+ *    LIST SIMD
+ * Summary:
+ *    find, count, contains, min, max and sum for lists and arrays of
+ *    numbers, using SSE2 or AVX2 where the processor has them. Which
+ *    one is picked once, at run time, so one binary runs everywhere.
+ *    int and float have vector kernels; every other arithmetic type,
+ *    and any processor which is not x86, gets the plain loop.
+ *
+ *    The vector kernels need the items side by side in memory, and a
+ *    list keeps one item per node. So the kernels run on arrays, and
+ *    the list versions give the same answers with one walk over the
+ *    nodes. A caller which scans the same list many times should take
+ *    a to_vector() or copy_to() once and scan that.
+ *
+ *    Sums of int wrap around on overflow instead of being undefined.
+ *    Sums of float are added in a different order than a plain loop
+ *    would, so the last bits may differ. min and max of float are
+ *    unspecified if there is a NaN.
+ *
+ *    This will contain the definitions of:
+ *        find, count, contains, min, max, sum : over a list or an array
+ *        use : limit the kernels to an instruction set, for testing
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+#include <cstddef>      // for size_t
+#include <type_traits>  // for std::is_arithmetic
+#include "list.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIST_SIMD_X86
+#define LIST_SIMD_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define LIST_SIMD_X86
+#define LIST_SIMD_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace custom
+{
+namespace simd
+{
+
+/**************************************************
+ * LEVEL
+ * The instruction sets we have kernels for, from
+ * least to most capable
+ **************************************************/
+enum level { SCALAR, SSE2, AVX2 };
+
+/*********************************************
+ * DETECT
+ * The best level this processor and operating
+ * system support
+ *********************************************/
+inline level detect()
+{
+#if defined(LIST_SIMD_X86) && defined(__GNUC__)
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))
+      return AVX2;
+   if (__builtin_cpu_supports("sse2"))
+      return SSE2;
+   return SCALAR;
+#elif defined(LIST_SIMD_X86)
+   int info[4];
+   __cpuid(info, 0);
+   int numIds = info[0];
+   __cpuid(info, 1);
+   bool sse2 = (info[3] & (1 << 26)) != 0;
+   bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+   if (numIds >= 7 && osSavesYmm)
+   {
+      __cpuidex(info, 7, 0);
+      if (info[1] & (1 << 5))
+         return AVX2;
+   }
+   return sse2 ? SSE2 : SCALAR;
+#else
+   return SCALAR;
+#endif
+}
+
+/*********************************************
+ * USE and ACTIVE
+ * The level the kernels run at: the best one the
+ * processor has, unless use() asked for less
+ *********************************************/
+inline level & limit()
+{
+   static level limit = AVX2;
+   return limit;
+}
+
+inline void use(level most) { limit() = most; }
+
+inline level active()
+{
+   static const level best = detect();
+   return best < limit() ? best : limit();
+}
+
+/**************************************************
+ * KERNELS
+ * The plain loops, for every arithmetic type. find
+ * returns num when there is no match.
+ **************************************************/
+template <typename T>
+struct kernels
+{
+   static size_t find(const T * p, size_t num, T value)
+   {
+      size_t i = 0;
+      while (i < num && !(p[i] == value))
+         i++;
+      return i;
+   }
+
+   static size_t count(const T * p, size_t num, T value)
+   {
+      size_t numFound = 0;
+      for (size_t i = 0; i < num; i++)
+         numFound += (p[i] == value);
+      return numFound;
+   }
+
+   // num must be at least 1
+   static T min(const T * p, size_t num)
+   {
+      T m = p[0];
+      for (size_t i = 1; i < num; i++)
+         if (p[i] < m)
+            m = p[i];
+      return m;
+   }
+
+   static T max(const T * p, size_t num)
+   {
+      T m = p[0];
+      for (size_t i = 1; i < num; i++)
+         if (m < p[i])
+            m = p[i];
+      return m;
+   }
+
+   static T sum(const T * p, size_t num)
+   {
+      T total = T();
+      for (size_t i = 0; i < num; i++)
+         total += p[i];
+      return total;
+   }
+};
+
+// int adds as unsigned so that overflow wraps the way the vector adds do
+template <>
+inline int kernels <int> :: sum(const int * p, size_t num)
+{
+   unsigned int total = 0;
+   for (size_t i = 0; i < num; i++)
+      total += (unsigned int)p[i];
+   return (int)total;
+}
+
+#ifdef LIST_SIMD_X86
+
+// the position of the lowest set bit of a non-zero mask
+inline size_t lowestBit(unsigned int mask)
+{
+   size_t bit = 0;
+   while (!(mask & 1))
+   {
+      mask >>= 1;
+      bit++;
+   }
+   return bit;
+}
+
+// the lanes of a vector, for the final horizontal step
+union lanes128 { __m128i i; __m128 f; int ints[4];   float floats[4]; };
+union lanes256 { __m256i i; __m256 f; int ints[8];   float floats[8]; };
+
+/**************************************************
+ * SSE2 KERNELS
+ * Four ints or floats at a time. SSE2 has no min or
+ * max for ints, so those pick with a compare.
+ **************************************************/
+struct sse2
+{
+   static size_t find(const int * p, size_t num, int value)
+   {
+      __m128i v = _mm_set1_epi32(value);
+      size_t i = 0;
+      for (; i + 4 <= num; i += 4)
+      {
+         int mask = _mm_movemask_ps(_mm_castsi128_ps(
+            _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(p + i)), v)));
+         if (mask)
+            return i + lowestBit(mask);
+      }
+      return i + kernels<int>::find(p + i, num - i, value);
+   }
+
+   static size_t find(const float * p, size_t num, float value)
+   {
+      __m128 v = _mm_set1_ps(value);
+      size_t i = 0;
+      for (; i + 4 <= num; i += 4)
+      {
+         int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(p + i), v));
+         if (mask)
+            return i + lowestBit(mask);
+      }
+      return i + kernels<float>::find(p + i, num - i, value);
+   }
+
+   // a match is -1 in its lane, so subtracting the compare counts it.
+   // The lanes are emptied before they could overflow.
+   static size_t count(const int * p, size_t num, int value)
+   {
+      __m128i v = _mm_set1_epi32(value);
+      size_t numFound = 0;
+      size_t i = 0;
+      while (i + 4 <= num)
+      {
+         lanes128 counts;
+         counts.i = _mm_setzero_si128();
+         for (size_t iStop = (num - i > (1u << 30)) ? i + (1u << 30) : num; i + 4 <= iStop; i += 4)
+            counts.i = _mm_sub_epi32(counts.i,
+               _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(p + i)), v));
+         for (int lane = 0; lane < 4; lane++)
+            numFound += (unsigned int)counts.ints[lane];
+      }
+      return numFound + kernels<int>::count(p + i, num - i, value);
+   }
+
+   static size_t count(const float * p, size_t num, float value)
+   {
+      __m128 v = _mm_set1_ps(value);
+      size_t numFound = 0;
+      size_t i = 0;
+      while (i + 4 <= num)
+      {
+         lanes128 counts;
+         counts.i = _mm_setzero_si128();
+         for (size_t iStop = (num - i > (1u << 30)) ? i + (1u << 30) : num; i + 4 <= iStop; i += 4)
+            counts.i = _mm_sub_epi32(counts.i,
+               _mm_castps_si128(_mm_cmpeq_ps(_mm_loadu_ps(p + i), v)));
+         for (int lane = 0; lane < 4; lane++)
+            numFound += (unsigned int)counts.ints[lane];
+      }
+      return numFound + kernels<float>::count(p + i, num - i, value);
+   }
+
+   static int min(const int * p, size_t num)
+   {
+      if (num < 4)
+         return kernels<int>::min(p, num);
+      lanes128 m;
+      m.i = _mm_loadu_si128((const __m128i *)p);
+      size_t i = 4;
+      for (; i + 4 <= num; i += 4)
+      {
+         __m128i x = _mm_loadu_si128((const __m128i *)(p + i));
+         __m128i less = _mm_cmplt_epi32(x, m.i);
+         m.i = _mm_or_si128(_mm_and_si128(less, x), _mm_andnot_si128(less, m.i));
+      }
+      int result = kernels<int>::min(m.ints, 4);
+      if (i < num)
+      {
+         int rest = kernels<int>::min(p + i, num - i);
+         result = rest < result ? rest : result;
+      }
+      return result;
+   }
+
+   static int max(const int * p, size_t num)
+   {
+      if (num < 4)
+         return kernels<int>::max(p, num);
+      lanes128 m;
+      m.i = _mm_loadu_si128((const __m128i *)p);
+      size_t i = 4;
+      for (; i + 4 <= num; i += 4)
+      {
+         __m128i x = _mm_loadu_si128((const __m128i *)(p + i));
+         __m128i more = _mm_cmpgt_epi32(x, m.i);
+         m.i = _mm_or_si128(_mm_and_si128(more, x), _mm_andnot_si128(more, m.i));
+      }
+      int result = kernels<int>::max(m.ints, 4);
+      if (i < num)
+      {
+         int rest = kernels<int>::max(p + i, num - i);
+         result = rest > result ? rest : result;
+      }
+      return result;
+   }
+
+   static float min(const float * p, size_t num)
+   {
+      if (num < 4)
+         return kernels<float>::min(p, num);
+      lanes128 m;
+      m.f = _mm_loadu_ps(p);
+      size_t i = 4;
+      for (; i + 4 <= num; i += 4)
+         m.f = _mm_min_ps(m.f, _mm_loadu_ps(p + i));
+      float result = kernels<float>::min(m.floats, 4);
+      if (i < num)
+      {
+         float rest = kernels<float>::min(p + i, num - i);
+         result = rest < result ? rest : result;
+      }
+      return result;
+   }
+
+   static float max(const float * p, size_t num)
+   {
+      if (num < 4)
+         return kernels<float>::max(p, num);
+      lanes128 m;
+      m.f = _mm_loadu_ps(p);
+      size_t i = 4;
+      for (; i + 4 <= num; i += 4)
+         m.f = _mm_max_ps(m.f, _mm_loadu_ps(p + i));
+      float result = kernels<float>::max(m.floats, 4);
+      if (i < num)
+      {
+         float rest = kernels<float>::max(p + i, num - i);
+         result = rest > result ? rest : result;
+      }
+      return result;
+   }
+
+   static int sum(const int * p, size_t num)
+   {
+      lanes128 total;
+      total.i = _mm_setzero_si128();
+      size_t i = 0;
+      for (; i + 4 <= num; i += 4)
+         total.i = _mm_add_epi32(total.i, _mm_loadu_si128((const __m128i *)(p + i)));
+      return (int)((unsigned int)kernels<int>::sum(total.ints, 4) +
+                   (unsigned int)kernels<int>::sum(p + i, num - i));
+   }
+
+   static float sum(const float * p, size_t num)
+   {
+      lanes128 total;
+      total.f = _mm_setzero_ps();
+      size_t i = 0;
+      for (; i + 4 <= num; i += 4)
+         total.f = _mm_add_ps(total.f, _mm_loadu_ps(p + i));
+      return kernels<float>::sum(total.floats, 4) + kernels<float>::sum(p + i, num - i);
+   }
+};
+
+/**************************************************
+ * AVX2 KERNELS
+ * Eight ints or floats at a time. These are built
+ * for AVX2 whatever the compiler flags say, and only
+ * called once detect() has found it.
+ **************************************************/
+struct avx2
+{
+   LIST_SIMD_AVX2 static size_t find(const int * p, size_t num, int value)
+   {
+      __m256i v = _mm256_set1_epi32(value);
+      size_t i = 0;
+      for (; i + 8 <= num; i += 8)
+      {
+         int mask = _mm256_movemask_ps(_mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(p + i)), v)));
+         if (mask)
+            return i + lowestBit(mask);
+      }
+      return i + kernels<int>::find(p + i, num - i, value);
+   }
+
+   LIST_SIMD_AVX2 static size_t find(const float * p, size_t num, float value)
+   {
+      __m256 v = _mm256_set1_ps(value);
+      size_t i = 0;
+      for (; i + 8 <= num; i += 8)
+      {
+         int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p + i), v, _CMP_EQ_OQ));
+         if (mask)
+            return i + lowestBit(mask);
+      }
+      return i + kernels<float>::find(p + i, num - i, value);
+   }
+
+   LIST_SIMD_AVX2 static size_t count(const int * p, size_t num, int value)
+   {
+      __m256i v = _mm256_set1_epi32(value);
+      size_t numFound = 0;
+      size_t i = 0;
+      while (i + 8 <= num)
+      {
+         lanes256 counts;
+         counts.i = _mm256_setzero_si256();
+         for (size_t iStop = (num - i > (1u << 30)) ? i + (1u << 30) : num; i + 8 <= iStop; i += 8)
+            counts.i = _mm256_sub_epi32(counts.i,
+               _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(p + i)), v));
+         for (int lane = 0; lane < 8; lane++)
+            numFound += (unsigned int)counts.ints[lane];
+      }
+      return numFound + kernels<int>::count(p + i, num - i, value);
+   }
+
+   LIST_SIMD_AVX2 static size_t count(const float * p, size_t num, float value)
+   {
+      __m256 v = _mm256_set1_ps(value);
+      size_t numFound = 0;
+      size_t i = 0;
+      while (i + 8 <= num)
+      {
+         lanes256 counts;
+         counts.i = _mm256_setzero_si256();
+         for (size_t iStop = (num - i > (1u << 30)) ? i + (1u << 30) : num; i + 8 <= iStop; i += 8)
+            counts.i = _mm256_sub_epi32(counts.i,
+               _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(p + i), v, _CMP_EQ_OQ)));
+         for (int lane = 0; lane < 8; lane++)
+            numFound += (unsigned int)counts.ints[lane];
+      }
+      return numFound + kernels<float>::count(p + i, num - i, value);
+   }
+
+   LIST_SIMD_AVX2 static int min(const int * p, size_t num)
+   {
+      if (num < 8)
+         return kernels<int>::min(p, num);
+      lanes256 m;
+      m.i = _mm256_loadu_si256((const __m256i *)p);
+      size_t i = 8;
+      for (; i + 8 <= num; i += 8)
+         m.i = _mm256_min_epi32(m.i, _mm256_loadu_si256((const __m256i *)(p + i)));
+      int result = kernels<int>::min(m.ints, 8);
+      if (i < num)
+      {
+         int rest = kernels<int>::min(p + i, num - i);
+         result = rest < result ? rest : result;
+      }
+      return result;
+   }
+
+   LIST_SIMD_AVX2 static int max(const int * p, size_t num)
+   {
+      if (num < 8)
+         return kernels<int>::max(p, num);
+      lanes256 m;
+      m.i = _mm256_loadu_si256((const __m256i *)p);
+      size_t i = 8;
+      for (; i + 8 <= num; i += 8)
+         m.i = _mm256_max_epi32(m.i, _mm256_loadu_si256((const __m256i *)(p + i)));
+      int result = kernels<int>::max(m.ints, 8);
+      if (i < num)
+      {
+         int rest = kernels<int>::max(p + i, num - i);
+         result = rest > result ? rest : result;
+      }
+      return result;
+   }
+
+   LIST_SIMD_AVX2 static float min(const float * p, size_t num)
+   {
+      if (num < 8)
+         return kernels<float>::min(p, num);
+      lanes256 m;
+      m.f = _mm256_loadu_ps(p);
+      size_t i = 8;
+      for (; i + 8 <= num; i += 8)
+         m.f = _mm256_min_ps(m.f, _mm256_loadu_ps(p + i));
+      float result = kernels<float>::min(m.floats, 8);
+      if (i < num)
+      {
+         float rest = kernels<float>::min(p + i, num - i);
+         result = rest < result ? rest : result;
+      }
+      return result;
+   }
+
+   LIST_SIMD_AVX2 static float max(const float * p, size_t num)
+   {
+      if (num < 8)
+         return kernels<float>::max(p, num);
+      lanes256 m;
+      m.f = _mm256_loadu_ps(p);
+      size_t i = 8;
+      for (; i + 8 <= num; i += 8)
+         m.f = _mm256_max_ps(m.f, _mm256_loadu_ps(p + i));
+      float result = kernels<float>::max(m.floats, 8);
+      if (i < num)
+      {
+         float rest = kernels<float>::max(p + i, num - i);
+         result = rest > result ? rest : result;
+      }
+      return result;
+   }
+
+   LIST_SIMD_AVX2 static int sum(const int * p, size_t num)
+   {
+      lanes256 total;
+      total.i = _mm256_setzero_si256();
+      size_t i = 0;
+      for (; i + 8 <= num; i += 8)
+         total.i = _mm256_add_epi32(total.i, _mm256_loadu_si256((const __m256i *)(p + i)));
+      return (int)((unsigned int)kernels<int>::sum(total.ints, 8) +
+                   (unsigned int)kernels<int>::sum(p + i, num - i));
+   }
+
+   LIST_SIMD_AVX2 static float sum(const float * p, size_t num)
+   {
+      lanes256 total;
+      total.f = _mm256_setzero_ps();
+      size_t i = 0;
+      for (; i + 8 <= num; i += 8)
+         total.f = _mm256_add_ps(total.f, _mm256_loadu_ps(p + i));
+      return kernels<float>::sum(total.floats, 8) + kernels<float>::sum(p + i, num - i);
+   }
+};
+
+/**************************************************
+ * DISPATCH
+ * int and float go to the best kernel active() allows
+ **************************************************/
+template <typename T>
+struct dispatch
+{
+   static size_t find (const T * p, size_t num, T value)
+   {
+      level now = active();
+      return now == AVX2 ? avx2::find(p, num, value) :
+             now == SSE2 ? sse2::find(p, num, value) : kernels<T>::find(p, num, value);
+   }
+   static size_t count(const T * p, size_t num, T value)
+   {
+      level now = active();
+      return now == AVX2 ? avx2::count(p, num, value) :
+             now == SSE2 ? sse2::count(p, num, value) : kernels<T>::count(p, num, value);
+   }
+   static T min(const T * p, size_t num)
+   {
+      level now = active();
+      return now == AVX2 ? avx2::min(p, num) :
+             now == SSE2 ? sse2::min(p, num) : kernels<T>::min(p, num);
+   }
+   static T max(const T * p, size_t num)
+   {
+      level now = active();
+      return now == AVX2 ? avx2::max(p, num) :
+             now == SSE2 ? sse2::max(p, num) : kernels<T>::max(p, num);
+   }
+   static T sum(const T * p, size_t num)
+   {
+      level now = active();
+      return now == AVX2 ? avx2::sum(p, num) :
+             now == SSE2 ? sse2::sum(p, num) : kernels<T>::sum(p, num);
+   }
+};
+
+template <typename T> struct best            { typedef kernels  <T>     type; };
+template <>           struct best <int>      { typedef dispatch <int>   type; };
+template <>           struct best <float>    { typedef dispatch <float> type; };
+
+#else
+
+template <typename T> struct best            { typedef kernels  <T>     type; };
+
+#endif // LIST_SIMD_X86
+
+/*********************************************
+ * ARRAY VERSIONS
+ * Over num items side by side in memory
+ *    INPUT  : the items, and what to look for
+ *    OUTPUT : find gives the first match or p + num;
+ *             min and max throw when num is 0
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+const T * find(const T * p, size_t num, T value)
+{
+   static_assert(std::is_arithmetic<T>::value, "simd works on numbers");
+   return p + best<T>::type::find(p, num, value);
+}
+
+template <typename T>
+size_t count(const T * p, size_t num, T value)
+{
+   static_assert(std::is_arithmetic<T>::value, "simd works on numbers");
+   return best<T>::type::count(p, num, value);
+}
+
+template <typename T>
+bool contains(const T * p, size_t num, T value)
+{
+   return find(p, num, value) != p + num;
+}
+
+template <typename T>
+T min(const T * p, size_t num)
+{
+   static_assert(std::is_arithmetic<T>::value, "simd works on numbers");
+   if (num == 0)
+      throw "ERROR: unable to access data from an empty list";
+   return best<T>::type::min(p, num);
+}
+
+template <typename T>
+T max(const T * p, size_t num)
+{
+   static_assert(std::is_arithmetic<T>::value, "simd works on numbers");
+   if (num == 0)
+      throw "ERROR: unable to access data from an empty list";
+   return best<T>::type::max(p, num);
+}
+
+template <typename T>
+T sum(const T * p, size_t num)
+{
+   static_assert(std::is_arithmetic<T>::value, "simd works on numbers");
+   return best<T>::type::sum(p, num);
+}
+
+/*********************************************
+ * LIST VERSIONS
+ * The same answers for a list. These walk the nodes
+ * and compare in the same pass: copying blocks of
+ * items into a buffer for the vector kernels was
+ * measured slower, because following pNext costs far
+ * more than the compare it would speed up.
+ *    INPUT  : the list, and what to look for
+ *    OUTPUT : find gives the first match or end();
+ *             min and max throw when the list is empty
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+typename list <T> :: iterator find(list <T> & l, const T & value)
+{
+   auto it = l.begin();
+   while (it != l.end() && !(*it == value))
+      ++it;
+   return it;
+}
+
+template <typename T>
+size_t count(list <T> & l, const T & value)
+{
+   size_t numFound = 0;
+   for (auto it = l.begin(); it != l.end(); ++it)
+      numFound += (*it == value);
+   return numFound;
+}
+
+template <typename T>
+bool contains(list <T> & l, const T & value)
+{
+   return find(l, value) != l.end();
+}
+
+template <typename T>
+T min(list <T> & l)
+{
+   T result = l.front();
+   for (auto it = l.begin(); it != l.end(); ++it)
+      if (*it < result)
+         result = *it;
+   return result;
+}
+
+template <typename T>
+T max(list <T> & l)
+{
+   T result = l.front();
+   for (auto it = l.begin(); it != l.end(); ++it)
+      if (result < *it)
+         result = *it;
+   return result;
+}
+
+template <typename T>
+T sum(list <T> & l)
+{
+   T total = T();
+   for (auto it = l.begin(); it != l.end(); ++it)
+   {
+      T pair[2] = { total, *it };
+      total = kernels<T>::sum(pair, 2);   // so an int wraps here too
+   }
+   return total;
+}
+
+}; // namespace simd
+}; // namespace custom
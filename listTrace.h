@@ -0,0 +1,374 @@
+/***********************************************************************
+ * Header:
+ *    LIST TRACE
+ * Summary:
+ *    Latency histograms for the hot operations of list. Each operation
+ *    is timed in CPU ticks and counted in a log-linear histogram which
+ *    belongs to the calling thread, so recording takes no locks. The
+ *    histograms of every thread are added together when they are read.
+ *
+ *    Only list.h includes this, and only when LIST_TRACE is defined.
+ *
+ *    This will contain the class definition of:
+ *        listTrace    : The histograms and the API to read them
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+#include <atomic>      // for std::atomic
+#include <chrono>      // for std::chrono::steady_clock
+#include <cstdint>     // for uint64_t
+#include <mutex>       // for std::mutex
+#include <vector>      // for std::vector
+#include <ostream>     // for std::ostream
+#if defined(_MSC_VER)
+#include <intrin.h>    // for __rdtsc
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // for __rdtsc
+#endif
+
+namespace custom
+{
+
+/**************************************************
+ * LIST TRACE
+ * Per-thread histograms of operation latency
+ **************************************************/
+class listTrace
+{
+public:
+   // the operations we time
+   enum Op { PUSH_BACK, PUSH_FRONT, INSERT, ERASE, POP_BACK, POP_FRONT,
+             CLEAR, COPY_ASSIGN, MOVE_ASSIGN, INIT_ASSIGN, COMPACT, SORT, SPLICE,
+             PUSH_BACK_BULK, POP_FRONT_BULK, DRAIN, NUM_OPS };
+
+   // every power of two is split into 16 linear buckets
+   static const int SUB_BITS    = 4;
+   static const int SUB_BUCKETS = 1 << SUB_BITS;
+   static const int NUM_BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+   static const char * name(Op op);
+   static uint64_t ticks();
+   static void record(Op op, uint64_t elapsed);
+
+   // read the histograms of every thread, live or finished
+   static uint64_t count(Op op);
+   static uint64_t percentile(Op op, double fraction);
+   static void     dump(std::ostream & out);
+   static void     reset();
+
+   /*************************************************
+    * SCOPE
+    * Time one operation. Operations called from inside
+    * another, such as the erase inside pop_back, are
+    * charged to the outermost one only.
+    *************************************************/
+   class Scope
+   {
+   public:
+      Scope(Op op) : op(op), outermost(depth()++ == 0), start(outermost ? ticks() : 0) { }
+     ~Scope()
+      {
+         if (outermost)
+            record(op, ticks() - start);
+         depth()--;
+      }
+   private:
+      static int & depth()
+      {
+         static thread_local int value = 0;
+         return value;
+      }
+      Op op;
+      bool outermost;
+      uint64_t start;
+   };
+
+   static int bucket(uint64_t value);
+   static uint64_t bucketValue(int bucket);
+
+private:
+   // the counts of one thread. Only the owner writes them.
+   struct Histograms
+   {
+      Histograms()   { clear(); }
+      void clear()
+      {
+         for (int op = 0; op < NUM_OPS; op++)
+            for (int b = 0; b < NUM_BUCKETS; b++)
+               counts[op][b].store(0, std::memory_order_relaxed);
+      }
+      std::atomic<uint64_t> counts[NUM_OPS][NUM_BUCKETS];
+   };
+
+   // every thread's histograms, plus those of threads which are done
+   struct Registry
+   {
+      std::mutex lock;
+      std::vector<Histograms *> live;
+      Histograms retired;
+   };
+
+   // the calling thread's histograms. This has no destructor so it can
+   // still be read after the thread's Local has run, which is when a
+   // static list may be clearing its nodes.
+   struct Current
+   {
+      Histograms * p;   // null until the first operation, and once done
+      bool done;        // the Local has run; count into the retired ones
+   };
+
+   // registers the calling thread's histograms and folds them into
+   // the retired counts when the thread ends
+   struct Local
+   {
+      Local();
+     ~Local();
+   };
+
+   static Registry & registry()
+   {
+      static Registry * pRegistry = new Registry;
+      return *pRegistry;
+   }
+
+   static Current & current()
+   {
+      static thread_local Current c = { nullptr, false };
+      return c;
+   }
+
+   // this thread's histograms, or null once the thread is ending
+   static Histograms * local()
+   {
+      Current & c = current();
+      if (c.p == nullptr && !c.done)
+      {
+         static thread_local Local l;
+         (void)l;
+      }
+      return c.p;
+   }
+
+   static void sum(Op op, uint64_t counts[NUM_BUCKETS]);
+};
+
+/*********************************************
+ * LIST TRACE :: LOCAL
+ * Give a new thread its own histograms
+ *********************************************/
+inline listTrace :: Local :: Local()
+{
+   Histograms * p = new Histograms;
+   Registry & r = registry();
+   std::lock_guard<std::mutex> guard(r.lock);
+   r.live.push_back(p);
+   current().p = p;
+}
+
+inline listTrace :: Local :: ~Local()
+{
+   Current & c = current();
+   Registry & r = registry();
+   std::lock_guard<std::mutex> guard(r.lock);
+   for (int op = 0; op < NUM_OPS; op++)
+      for (int b = 0; b < NUM_BUCKETS; b++)
+         r.retired.counts[op][b].fetch_add(c.p->counts[op][b].load(std::memory_order_relaxed),
+                                           std::memory_order_relaxed);
+   for (size_t i = 0; i < r.live.size(); i++)
+      if (r.live[i] == c.p)
+      {
+         r.live[i] = r.live.back();
+         r.live.pop_back();
+         break;
+      }
+   delete c.p;
+   c.p = nullptr;
+   c.done = true;
+}
+
+/*********************************************
+ * LIST TRACE :: NAME
+ *********************************************/
+inline const char * listTrace :: name(Op op)
+{
+   static const char * names[NUM_OPS] =
+   {
+      "push_back", "push_front", "insert", "erase", "pop_back", "pop_front",
+      "clear", "copy_assign", "move_assign", "init_assign", "compact", "sort", "splice",
+      "push_back_bulk", "pop_front_bulk", "drain"
+   };
+   return names[op];
+}
+
+/*********************************************
+ * LIST TRACE :: TICKS
+ * The time stamp counter where we have one, or else
+ * nanoseconds from the steady clock
+ *********************************************/
+inline uint64_t listTrace :: ticks()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+   return __rdtsc();
+#else
+   return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/*********************************************
+ * LIST TRACE :: BUCKET
+ * Values under 16 get a bucket each. After that, the
+ * position of the top bit picks the power of two and
+ * the next four bits pick one of its 16 buckets.
+ *    INPUT  : a number of ticks
+ *    OUTPUT : the bucket it is counted in
+ *    COST   : O(1)
+ *********************************************/
+inline int listTrace :: bucket(uint64_t value)
+{
+   if (value < (uint64_t)SUB_BUCKETS)
+      return (int)value;
+
+   int top = 63;
+   while (!(value >> top))
+      top--;
+
+   int sub = (int)(value >> (top - SUB_BITS)) & (SUB_BUCKETS - 1);
+   return (top - SUB_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+/*********************************************
+ * LIST TRACE :: BUCKET VALUE
+ * The smallest value counted in a bucket
+ *********************************************/
+inline uint64_t listTrace :: bucketValue(int bucket)
+{
+   if (bucket < SUB_BUCKETS)
+      return (uint64_t)bucket;
+
+   int top = bucket / SUB_BUCKETS + SUB_BITS - 1;
+   uint64_t sub = (uint64_t)(bucket % SUB_BUCKETS);
+   return (SUB_BUCKETS + sub) << (top - SUB_BITS);
+}
+
+/*********************************************
+ * LIST TRACE :: RECORD
+ * Count one operation in this thread's histogram.
+ * No other thread writes it, so a relaxed load and
+ * store is enough. Once the thread's histograms are
+ * folded away, as when a static list is destroyed
+ * at exit, count straight into the retired ones.
+ *********************************************/
+inline void listTrace :: record(Op op, uint64_t elapsed)
+{
+   Histograms * p = local();
+   if (p == nullptr)
+   {
+      registry().retired.counts[op][bucket(elapsed)].fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+   std::atomic<uint64_t> & counter = p->counts[op][bucket(elapsed)];
+   counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/*********************************************
+ * LIST TRACE :: SUM
+ * Add up one operation across every thread
+ *********************************************/
+inline void listTrace :: sum(Op op, uint64_t counts[NUM_BUCKETS])
+{
+   Registry & r = registry();
+   std::lock_guard<std::mutex> guard(r.lock);
+   for (int b = 0; b < NUM_BUCKETS; b++)
+   {
+      counts[b] = r.retired.counts[op][b].load(std::memory_order_relaxed);
+      for (size_t i = 0; i < r.live.size(); i++)
+         counts[b] += r.live[i]->counts[op][b].load(std::memory_order_relaxed);
+   }
+}
+
+/*********************************************
+ * LIST TRACE :: COUNT
+ * How many times an operation was timed
+ *********************************************/
+inline uint64_t listTrace :: count(Op op)
+{
+   uint64_t counts[NUM_BUCKETS];
+   sum(op, counts);
+   uint64_t total = 0;
+   for (int b = 0; b < NUM_BUCKETS; b++)
+      total += counts[b];
+   return total;
+}
+
+/*********************************************
+ * LIST TRACE :: PERCENTILE
+ * The latency which fraction of the operations are
+ * under, to within the width of one bucket
+ *    INPUT  : the operation and a fraction such as 0.99
+ *    OUTPUT : ticks, or 0 if nothing was recorded
+ *    COST   : O(threads * buckets)
+ *********************************************/
+inline uint64_t listTrace :: percentile(Op op, double fraction)
+{
+   uint64_t counts[NUM_BUCKETS];
+   sum(op, counts);
+
+   uint64_t total = 0;
+   for (int b = 0; b < NUM_BUCKETS; b++)
+      total += counts[b];
+   if (total == 0)
+      return 0;
+
+   uint64_t rank = (uint64_t)(fraction * (double)total);
+   if (rank >= total)
+      rank = total - 1;
+
+   uint64_t seen = 0;
+   for (int b = 0; b < NUM_BUCKETS; b++)
+   {
+      seen += counts[b];
+      if (seen > rank)
+         return bucketValue(b);
+   }
+   return bucketValue(NUM_BUCKETS - 1);
+}
+
+/*********************************************
+ * LIST TRACE :: DUMP
+ * One CSV row per operation that was recorded:
+ *    operation,count,p50,p99,p999
+ *********************************************/
+inline void listTrace :: dump(std::ostream & out)
+{
+   out << "operation,count,p50,p99,p999\n";
+   for (int op = 0; op < NUM_OPS; op++)
+   {
+      uint64_t total = count((Op)op);
+      if (total == 0)
+         continue;
+      out << name((Op)op)                    << ','
+          << total                           << ','
+          << percentile((Op)op, 0.50)        << ','
+          << percentile((Op)op, 0.99)        << ','
+          << percentile((Op)op, 0.999)       << '\n';
+   }
+}
+
+/*********************************************
+ * LIST TRACE :: RESET
+ * Forget everything recorded so far. Threads which
+ * are recording at the same time may lose a count.
+ *********************************************/
+inline void listTrace :: reset()
+{
+   Registry & r = registry();
+   std::lock_guard<std::mutex> guard(r.lock);
+   r.retired.clear();
+   for (size_t i = 0; i < r.live.size(); i++)
+      r.live[i]->clear();
+}
+
+}; // namespace custom
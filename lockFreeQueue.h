@@ -0,0 +1,427 @@
+/***********************************************************************
+ * Header:
+ *    LOCK FREE QUEUE
+ * Summary:
+ *    A work queue which any number of threads can push to and pop from
+ *    without a mutex. This is the queue of Michael and Scott: a singly
+ *    linked list whose first node is a dummy, with the head and tail
+ *    moved by compare-and-swap.
+ *
+ *    A popped node can not be freed right away because another thread
+ *    may still be reading it. Before a thread reads a node it publishes
+ *    the pointer in one of its hazard pointers, and a retired node is
+ *    only deleted once no hazard pointer holds it.
+ *
+ *    This will contain the class definition of:
+ *        hazardPointers : Safe memory reclamation for lock-free lists
+ *        lockfree_queue : A multi-producer, multi-consumer queue
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+#include <algorithm>   // for std::sort
+#include <atomic>      // for std::atomic
+#include <mutex>       // for std::mutex
+#include <new>         // for placement new
+#include <utility>     // for std::move
+#include <vector>      // for std::vector
+#include "nodePool.h"  // for custom::pool
+
+class TestLockFreeQueue;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/**************************************************
+ * HAZARD POINTERS
+ * Every thread that touches a lock-free structure
+ * owns a record of SLOTS hazard pointers. The records
+ * live forever and are reused when a thread exits.
+ **************************************************/
+class hazardPointers
+{
+public:
+   static const int SLOTS = 2;
+
+   // publish p in one of the calling thread's slots
+   static void set(int slot, void * p)
+   {
+      local().pRecord->hazards[slot].store(p);
+   }
+   static void clear()
+   {
+      for (int slot = 0; slot < SLOTS; slot++)
+         local().pRecord->hazards[slot].store(nullptr, std::memory_order_release);
+   }
+
+   // load src and publish it until it holds still
+   template <typename Node>
+   static Node * protect(int slot, const std::atomic<Node *> & src)
+   {
+      Node * p = src.load();
+      for (;;)
+      {
+         set(slot, p);
+         Node * pCheck = src.load();
+         if (pCheck == p)
+            return p;
+         p = pCheck;
+      }
+   }
+
+   // free p with destroy once no thread has it published
+   static void retire(void * p, void (*destroy)(void *));
+
+private:
+   struct Record
+   {
+      Record() : pNext(nullptr), active(true)
+      {
+         for (int slot = 0; slot < SLOTS; slot++)
+            hazards[slot].store(nullptr);
+      }
+      std::atomic<void *> hazards[SLOTS];
+      Record * pNext;              // set once, before the record is published
+      std::atomic<bool> active;    // is a thread using this record
+   };
+
+   struct Retired
+   {
+      void * p;
+      void (*destroy)(void *);
+   };
+
+   // everything shared between threads
+   struct Domain
+   {
+      Domain() : pRecords(nullptr), numRecords(0) { }
+      std::atomic<Record *> pRecords;
+      std::atomic<size_t> numRecords;
+      std::mutex orphanLock;
+      std::vector<Retired> orphans;   // left behind by threads which exited
+   };
+
+   // the calling thread's record and its retired nodes
+   struct Local
+   {
+      Local();
+     ~Local();
+      Record * pRecord;
+      std::vector<Retired> retired;
+   };
+
+   static Domain & domain()
+   {
+      static Domain * pDomain = new Domain;
+      return *pDomain;
+   }
+
+   static Local & local()
+   {
+      static thread_local Local l;
+      return l;
+   }
+
+   static void scan(std::vector<Retired> & retired);
+};
+
+/*********************************************
+ * HAZARD POINTERS :: LOCAL
+ * Reuse the record of a thread which has exited, or
+ * add a new one to the front of the list
+ *********************************************/
+inline hazardPointers :: Local :: Local() : pRecord(nullptr)
+{
+   Domain & d = domain();
+   for (Record * p = d.pRecords.load(); p; p = p->pNext)
+   {
+      bool expected = false;
+      if (!p->active.load() && p->active.compare_exchange_strong(expected, true))
+      {
+         pRecord = p;
+         return;
+      }
+   }
+
+   pRecord = new Record;
+   pRecord->pNext = d.pRecords.load();
+   while (!d.pRecords.compare_exchange_weak(pRecord->pNext, pRecord))
+      ;
+   d.numRecords++;
+}
+
+/*********************************************
+ * HAZARD POINTERS :: ~LOCAL
+ * Free what we can. Anything still in use is handed
+ * to the domain for the next thread that scans.
+ *********************************************/
+inline hazardPointers :: Local :: ~Local()
+{
+   clear();
+   scan(retired);
+   if (!retired.empty())
+   {
+      Domain & d = domain();
+      std::lock_guard<std::mutex> guard(d.orphanLock);
+      d.orphans.insert(d.orphans.end(), retired.begin(), retired.end());
+   }
+   pRecord->active.store(false);
+}
+
+/*********************************************
+ * HAZARD POINTERS :: RETIRE
+ * Once there are a few more retired nodes than there
+ * could be hazard pointers, scanning is sure to free
+ * a good share of them
+ *********************************************/
+inline void hazardPointers :: retire(void * p, void (*destroy)(void *))
+{
+   Local & l = local();
+   Retired node = { p, destroy };
+   l.retired.push_back(node);
+   if (l.retired.size() >= 2 * SLOTS * domain().numRecords.load() + 64)
+      scan(l.retired);
+}
+
+/*********************************************
+ * HAZARD POINTERS :: SCAN
+ * Free every retired node which no hazard pointer
+ * holds, adopting any orphans on the way
+ *    INPUT  : the retired nodes of this thread
+ *    OUTPUT : the nodes which are still in use
+ *    COST   : O(r log h)
+ *********************************************/
+inline void hazardPointers :: scan(std::vector<Retired> & retired)
+{
+   Domain & d = domain();
+   {
+      std::unique_lock<std::mutex> guard(d.orphanLock, std::try_to_lock);
+      if (guard.owns_lock() && !d.orphans.empty())
+      {
+         retired.insert(retired.end(), d.orphans.begin(), d.orphans.end());
+         d.orphans.clear();
+      }
+   }
+
+   std::vector<void *> hazards;
+   for (Record * p = d.pRecords.load(); p; p = p->pNext)
+      for (int slot = 0; slot < SLOTS; slot++)
+         if (void * pHazard = p->hazards[slot].load())
+            hazards.push_back(pHazard);
+   std::sort(hazards.begin(), hazards.end());
+
+   size_t kept = 0;
+   for (size_t i = 0; i < retired.size(); i++)
+      if (std::binary_search(hazards.begin(), hazards.end(), retired[i].p))
+         retired[kept++] = retired[i];
+      else
+         retired[i].destroy(retired[i].p);
+   retired.resize(kept);
+}
+
+/**************************************************
+ * LOCK FREE QUEUE
+ * First in, first out, with no locks
+ **************************************************/
+template <typename T>
+class lockfree_queue
+{
+   friend class ::TestLockFreeQueue; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   lockfree_queue();
+   lockfree_queue(const lockfree_queue &) = delete;
+   lockfree_queue & operator = (const lockfree_queue &) = delete;
+  ~lockfree_queue();
+
+   //
+   // Insert and Remove
+   //
+
+   void push_back(const T &  data) { link(new Node(data));            }
+   void push_back(      T && data) { link(new Node(std::move(data))); }
+   bool pop_front(T & data);
+
+   //
+   // Status
+   //
+
+   bool empty() const;
+
+private:
+   class Node;
+
+   void link(Node * pNew);
+   static void destroy(void * p) { delete static_cast<Node *>(p); }
+
+   alignas(64) std::atomic<Node *> pHead;   // the dummy
+   alignas(64) std::atomic<Node *> pTail;   // the last node, or close to it
+};
+
+/*************************************************
+ * LOCK FREE QUEUE NODE
+ * Like list's Node but singly linked through an
+ * atomic pointer. The item lives in raw storage:
+ * popping moves it out and the node lives on as the
+ * dummy with nothing in it.
+ *************************************************/
+template <typename T>
+class lockfree_queue <T> :: Node
+{
+public:
+   Node()               : pNext(nullptr) { }
+   Node(const T & data) : pNext(nullptr) { new (storage) T(data);            }
+   Node(T && data)      : pNext(nullptr) { new (storage) T(std::move(data)); }
+
+   T & data()           { return *reinterpret_cast<T *>(storage); }
+
+   static void * operator new   (size_t)      { return pool<sizeof(Node), alignof(Node)>::allocate(); }
+   static void   operator delete(void * p)    { pool<sizeof(Node), alignof(Node)>::free(p);           }
+
+   alignas(T) unsigned char storage[sizeof(T)];   // user data
+   std::atomic<Node *> pNext;                    // pointer to next node
+};
+
+/*****************************************
+ * LOCK FREE QUEUE :: DEFAULT CONSTRUCTOR
+ ****************************************/
+template <typename T>
+lockfree_queue <T> :: lockfree_queue()
+{
+   Node * pDummy = new Node;
+   pHead.store(pDummy);
+   pTail.store(pDummy);
+}
+
+/*****************************************
+ * LOCK FREE QUEUE :: DESTRUCTOR
+ * Nobody else may be using the queue by now. Only
+ * the nodes after the dummy still hold an item.
+ ****************************************/
+template <typename T>
+lockfree_queue <T> :: ~lockfree_queue()
+{
+   Node * p = pHead.load();
+   Node * pNext = p->pNext.load();
+   delete p;
+   for (p = pNext; p; p = pNext)
+   {
+      pNext = p->pNext.load();
+      p->data().~T();
+      delete p;
+   }
+}
+
+/*********************************************
+ * LOCK FREE QUEUE :: LINK
+ * Swing the last node's pNext onto the new node, then
+ * try to move the tail. If the tail is lagging behind
+ * because another thread stalled, help it along.
+ *    INPUT  : a node holding the item
+ *    OUTPUT :
+ *    COST   : O(1) without contention
+ *********************************************/
+template <typename T>
+void lockfree_queue <T> :: link(Node * pNew)
+{
+   for (;;)
+   {
+      Node * pLast = hazardPointers::protect(0, pTail);
+      Node * pNext = pLast->pNext.load();
+      if (pLast != pTail.load())
+         continue;
+
+      if (pNext != nullptr)
+      {
+         pTail.compare_exchange_weak(pLast, pNext);
+         continue;
+      }
+
+      Node * pNull = nullptr;
+      if (pLast->pNext.compare_exchange_weak(pNull, pNew))
+      {
+         pTail.compare_exchange_strong(pLast, pNew);
+         break;
+      }
+   }
+   hazardPointers::clear();
+}
+
+/*********************************************
+ * LOCK FREE QUEUE :: POP FRONT
+ * Swing the head from the dummy onto the first node.
+ * Whoever wins owns the item in that node, which
+ * becomes the new dummy; the old dummy is retired.
+ * If moving the item out throws, it is lost but the
+ * queue is still well formed.
+ *    INPUT  : where to put the item
+ *    OUTPUT : false if the queue was empty
+ *    COST   : O(1) without contention
+ *********************************************/
+template <typename T>
+bool lockfree_queue <T> :: pop_front(T & data)
+{
+   for (;;)
+   {
+      Node * pDummy = hazardPointers::protect(0, pHead);
+      Node * pLast = pTail.load();
+      Node * pFirst = pDummy->pNext.load();
+      hazardPointers::set(1, pFirst);
+      if (pDummy != pHead.load())
+         continue;
+
+      if (pFirst == nullptr)
+      {
+         hazardPointers::clear();
+         return false;
+      }
+
+      // the tail is lagging behind; help it before we pass it
+      if (pDummy == pLast)
+      {
+         pTail.compare_exchange_weak(pLast, pFirst);
+         continue;
+      }
+
+      if (pHead.compare_exchange_weak(pDummy, pFirst))
+      {
+         // pFirst is the dummy now, so its item must go even if moving
+         // it out throws
+         try
+         {
+            data = std::move(pFirst->data());
+         }
+         catch (...)
+         {
+            pFirst->data().~T();
+            hazardPointers::clear();
+            hazardPointers::retire(pDummy, &destroy);
+            throw;
+         }
+         pFirst->data().~T();
+         hazardPointers::clear();
+         hazardPointers::retire(pDummy, &destroy);
+         return true;
+      }
+   }
+}
+
+/*********************************************
+ * LOCK FREE QUEUE :: EMPTY
+ * Only a snapshot: another thread may push or pop
+ * the moment we return
+ *********************************************/
+template <typename T>
+bool lockfree_queue <T> :: empty() const
+{
+   Node * pDummy = hazardPointers::protect(0, pHead);
+   bool isEmpty = (pDummy->pNext.load() == nullptr);
+   hazardPointers::clear();
+   return isEmpty;
+}
+
+}; // namespace custom
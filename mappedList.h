@@ -0,0 +1,576 @@
+/***********************************************************************
+ * Header:
+ *    MAPPED LIST
+ * Summary:
+ *    A list which lives in a file. The file is mapped into memory and
+ *    the nodes are kept right there, so opening a list again after a
+ *    restart is just mapping the file: nothing is read or rebuilt.
+ *
+ *    The file may land at a different address every time it is mapped,
+ *    and it moves whenever it has to grow, so nodes never point at each
+ *    other. A link is the node's offset from the start of the file, and
+ *    offset 0, where the header sits, means none. Iterators hold an
+ *    offset too, so they survive the file growing. A reference to an
+ *    item does not: it is only good until the next insert.
+ *
+ *    Items are stored as their bytes, so T must be trivially copyable
+ *    and must not hold pointers. Both the writer and the reader must
+ *    agree on byte order and on sizeof(T); the header checks the size.
+ *
+ *    Crash safety is best effort. Every change is written to the
+ *    mapping in place, and the operating system writes the pages back
+ *    when it likes. sync() waits for them to reach the disk. A crash
+ *    in the middle of an insert or an erase can leave the file with a
+ *    leaked node or a half-made link.
+ *
+ *    This will contain the class definition of:
+ *        mapped_file  : A file mapped into memory, which can grow
+ *        mapped_list  : A doubly linked list kept in a mapped file
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+#include <cstdint>     // for uint64_t
+#include <cstring>     // for std::memcmp
+#include <string>      // for std::string
+#include <type_traits> // for std::is_trivially_copyable
+#ifdef _WIN32
+#include <windows.h>   // for CreateFileMapping and MapViewOfFile
+#else
+#include <fcntl.h>     // for open
+#include <sys/mman.h>  // for mmap
+#include <sys/stat.h>  // for fstat
+#include <unistd.h>    // for ftruncate
+#endif // _WIN32
+
+class TestMappedList;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/**************************************************
+ * MAPPED FILE
+ * A whole file mapped read-write into memory
+ **************************************************/
+class mapped_file
+{
+public:
+   // minSize is only for a new or empty file
+   mapped_file(const std::string & path, size_t minSize);
+   mapped_file(const mapped_file &) = delete;
+   mapped_file & operator = (const mapped_file &) = delete;
+  ~mapped_file();
+
+   char * data()       { return pBase; }
+   size_t size() const { return numBytes; }
+   bool   isNew() const { return created; }
+
+   // make the file at least this big; data() may move
+   void grow(size_t minSize);
+
+   // wait until every change has reached the disk
+   void sync();
+
+private:
+   void map();
+   void unmap();
+
+#ifdef _WIN32
+   HANDLE hFile;
+   HANDLE hMapping;
+#else
+   int fd;
+#endif // _WIN32
+   char * pBase;
+   size_t numBytes;
+   bool created;       // the file was empty when we opened it
+};
+
+#ifdef _WIN32
+
+/*****************************************
+ * MAPPED FILE :: CONSTRUCTOR
+ * Open the file, creating it if need be. Only a new
+ * or empty file is sized to minSize; any other file
+ * is mapped as it is, and never written to here.
+ ****************************************/
+inline mapped_file :: mapped_file(const std::string & path, size_t minSize) :
+   hMapping(NULL), pBase(nullptr), numBytes(0), created(false)
+{
+   hFile = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL,
+                       OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+   if (hFile == INVALID_HANDLE_VALUE)
+      throw "ERROR: unable to open the mapped list";
+   LARGE_INTEGER size;
+   GetFileSizeEx(hFile, &size);
+   numBytes = (size_t)size.QuadPart;
+   created = (numBytes == 0);
+   try
+   {
+      if (created)
+         grow(minSize);
+      else
+         map();
+   }
+   catch (...)
+   {
+      CloseHandle(hFile);
+      throw;
+   }
+}
+
+inline mapped_file :: ~mapped_file()
+{
+   unmap();
+   CloseHandle(hFile);
+}
+
+inline void mapped_file :: map()
+{
+   hMapping = CreateFileMappingA(hFile, NULL, PAGE_READWRITE, 0, 0, NULL);
+   if (hMapping == NULL)
+      throw "ERROR: unable to map the list";
+   pBase = static_cast<char *>(MapViewOfFile(hMapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+   if (pBase == nullptr)
+   {
+      CloseHandle(hMapping);
+      hMapping = NULL;
+      throw "ERROR: unable to map the list";
+   }
+}
+
+inline void mapped_file :: unmap()
+{
+   if (pBase)
+      UnmapViewOfFile(pBase);
+   if (hMapping)
+      CloseHandle(hMapping);
+   pBase = nullptr;
+   hMapping = NULL;
+}
+
+inline void mapped_file :: grow(size_t minSize)
+{
+   unmap();
+   LARGE_INTEGER size;
+   size.QuadPart = (LONGLONG)minSize;
+   if (!SetFilePointerEx(hFile, size, NULL, FILE_BEGIN) || !SetEndOfFile(hFile))
+      throw "ERROR: unable to grow the mapped list";
+   numBytes = minSize;
+   map();
+}
+
+inline void mapped_file :: sync()
+{
+   FlushViewOfFile(pBase, 0);
+   FlushFileBuffers(hFile);
+}
+
+#else
+
+/*****************************************
+ * MAPPED FILE :: CONSTRUCTOR
+ * Open the file, creating it if need be. Only a new
+ * or empty file is sized to minSize; any other file
+ * is mapped as it is, and never written to here.
+ ****************************************/
+inline mapped_file :: mapped_file(const std::string & path, size_t minSize) :
+   pBase(nullptr), numBytes(0), created(false)
+{
+   fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+   if (fd < 0)
+      throw "ERROR: unable to open the mapped list";
+   struct stat status;
+   if (fstat(fd, &status) != 0)
+   {
+      ::close(fd);
+      throw "ERROR: unable to open the mapped list";
+   }
+   numBytes = (size_t)status.st_size;
+   created = (numBytes == 0);
+   try
+   {
+      if (created)
+         grow(minSize);
+      else
+         map();
+   }
+   catch (...)
+   {
+      ::close(fd);
+      throw;
+   }
+}
+
+inline mapped_file :: ~mapped_file()
+{
+   unmap();
+   ::close(fd);
+}
+
+inline void mapped_file :: map()
+{
+   void * p = mmap(nullptr, numBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (p == MAP_FAILED)
+      throw "ERROR: unable to map the list";
+   pBase = static_cast<char *>(p);
+}
+
+inline void mapped_file :: unmap()
+{
+   if (pBase)
+      munmap(pBase, numBytes);
+   pBase = nullptr;
+}
+
+inline void mapped_file :: grow(size_t minSize)
+{
+   unmap();
+   if (ftruncate(fd, (off_t)minSize) != 0)
+   {
+      map();
+      throw "ERROR: unable to grow the mapped list";
+   }
+   numBytes = minSize;
+   map();
+}
+
+inline void mapped_file :: sync()
+{
+   msync(pBase, numBytes, MS_SYNC);
+}
+
+#endif // _WIN32
+
+/**************************************************
+ * MAPPED LIST
+ * Just like list, but in a file
+ **************************************************/
+template <typename T>
+class mapped_list
+{
+   static_assert(std::is_trivially_copyable<T>::value,
+                 "a mapped_list stores its items as bytes");
+   friend class ::TestMappedList; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   mapped_list(const std::string & path);
+   mapped_list(const mapped_list &) = delete;
+   mapped_list & operator = (const mapped_list &) = delete;
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin()  { return iterator(this, header().head); }
+   iterator rbegin() { return iterator(this, header().tail); }
+   iterator end()    { return iterator(this, 0);             }
+
+   //
+   // Access
+   //
+
+   T & front();
+   T & back();
+
+   //
+   // Insert
+   //
+
+   void push_front(const T & data) { insert(begin(), data); }
+   void push_back (const T & data) { insert(end(),   data); }
+   iterator insert(iterator it, const T & data);
+
+   //
+   // Remove
+   //
+
+   void pop_front()                { erase(begin());  }
+   void pop_back()                 { erase(rbegin()); }
+   void clear();
+   iterator erase(const iterator & it);
+
+   //
+   // Persist
+   //
+
+   void sync() { file.sync(); }
+
+   //
+   // Status
+   //
+
+   bool   empty() { return size() == 0;                 }
+   size_t size()  { return (size_t)header().numElements; }
+
+private:
+   // the first bytes of the file
+   struct Header
+   {
+      char     magic[8];      // "CLSTMAP1"
+      uint64_t itemSize;      // sizeof(T)
+      uint64_t head;          // offset of the first node, or 0
+      uint64_t tail;          // offset of the last node, or 0
+      uint64_t numElements;
+      uint64_t freeList;      // offset of the first freed node, or 0
+      uint64_t bump;          // offset of the first never-used byte
+      uint64_t reserved;
+   };
+
+   // a node links to its neighbors by their offsets
+   struct Node
+   {
+      T data;
+      uint64_t next;
+      uint64_t prev;
+   };
+
+   static const size_t initialBytes = 64 * 1024;
+   static const uint64_t firstNode = (sizeof(Header) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+
+   Header & header()            { return *reinterpret_cast<Header *>(file.data()); }
+   Node & node(uint64_t offset) { return *reinterpret_cast<Node *>(file.data() + offset); }
+   uint64_t allocate();
+   void free(uint64_t offset);
+
+   mapped_file file;
+};
+
+/*************************************************
+ * MAPPED LIST ITERATOR
+ * Remembers the list and the node's offset, so it
+ * is still good after the file moves
+ *************************************************/
+template <typename T>
+class mapped_list <T> :: iterator
+{
+   friend class ::TestMappedList;
+   template <typename TT>
+   friend class custom::mapped_list;
+public:
+   iterator()                                : pList(nullptr), offset(0)      { }
+   iterator(mapped_list * pList, uint64_t offset) : pList(pList), offset(offset) { }
+
+   bool operator == (const iterator & rhs) const { return offset == rhs.offset; }
+   bool operator != (const iterator & rhs) const { return offset != rhs.offset; }
+
+   T & operator * ()
+   {
+      if (offset)
+         return pList->node(offset).data;
+      else
+         throw "ERROR: unable to access data from an empty list";
+   }
+
+   iterator & operator ++ ()
+   {
+      if (offset)
+         offset = pList->node(offset).next;
+      return *this;
+   }
+   iterator operator ++ (int postfix)
+   {
+      iterator old(*this);
+      ++(*this);
+      return old;
+   }
+   iterator & operator -- ()
+   {
+      if (offset)
+         offset = pList->node(offset).prev;
+      return *this;
+   }
+   iterator operator -- (int postfix)
+   {
+      iterator old(*this);
+      --(*this);
+      return old;
+   }
+
+private:
+   mapped_list * pList;
+   uint64_t offset;
+};
+
+/*****************************************
+ * MAPPED LIST :: CONSTRUCTOR
+ * Open the list saved in path, or start a new one.
+ * Opening an existing list only maps it: O(1). A file
+ * which is not a whole mapped list is refused before
+ * anything is written to it.
+ ****************************************/
+template <typename T>
+mapped_list <T> :: mapped_list(const std::string & path) : file(path, initialBytes)
+{
+   if (!file.isNew() && file.size() < firstNode)
+      throw "ERROR: this is not a mapped list";
+   Header & h = header();
+   if (file.isNew())
+   {
+      std::memcpy(h.magic, "CLSTMAP1", 8);
+      h.itemSize = sizeof(T);
+      h.head = h.tail = 0;
+      h.numElements = 0;
+      h.freeList = 0;
+      h.bump = firstNode;
+      h.reserved = 0;
+   }
+   else if (std::memcmp(h.magic, "CLSTMAP1", 8) != 0)
+      throw "ERROR: this is not a mapped list";
+   else if (h.itemSize != sizeof(T))
+      throw "ERROR: the mapped list holds a different type";
+   else if (h.bump < firstNode || h.bump > file.size() ||
+            h.head >= h.bump || h.tail >= h.bump || h.freeList >= h.bump)
+      throw "ERROR: the mapped list is damaged";
+}
+
+/*********************************************
+ * MAPPED LIST :: ALLOCATE
+ * A node freed earlier if there is one, or else the next
+ * unused one, growing the file by half again if it is full
+ *    INPUT  :
+ *    OUTPUT : the offset of the new node
+ *    COST   : O(1), amortized over the growth
+ *********************************************/
+template <typename T>
+uint64_t mapped_list <T> :: allocate()
+{
+   uint64_t offset = header().freeList;
+   if (offset)
+   {
+      header().freeList = node(offset).next;
+      return offset;
+   }
+
+   offset = header().bump;
+   if (offset + sizeof(Node) > file.size())
+      file.grow(file.size() + file.size() / 2 + sizeof(Node));
+   header().bump = offset + sizeof(Node);
+   return offset;
+}
+
+/*********************************************
+ * MAPPED LIST :: FREE
+ * Keep a node for the next allocate
+ *    INPUT  : the offset of a node no longer linked in
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void mapped_list <T> :: free(uint64_t offset)
+{
+   node(offset).next = header().freeList;
+   header().freeList = offset;
+}
+
+/*********************************************
+ * MAPPED LIST :: FRONT and BACK
+ *********************************************/
+template <typename T>
+T & mapped_list <T> :: front()
+{
+   if (empty())
+      throw "ERROR: unable to access data from an empty list";
+   return node(header().head).data;
+}
+
+template <typename T>
+T & mapped_list <T> :: back()
+{
+   if (empty())
+      throw "ERROR: unable to access data from an empty list";
+   return node(header().tail).data;
+}
+
+/*********************************************
+ * MAPPED LIST :: INSERT
+ * Add an item just before it, or at the end if it is
+ * end(). The new node is filled in before anything
+ * links to it.
+ *    INPUT  : where to put it and the item
+ *    OUTPUT : an iterator to the new item
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+typename mapped_list <T> :: iterator mapped_list <T> :: insert(iterator it, const T & data)
+{
+   // data may live in the file, which allocate can move
+   T item(data);
+   uint64_t offset = allocate();
+
+   uint64_t next = it.offset;
+   uint64_t prev = next ? node(next).prev : header().tail;
+   Node & n = node(offset);
+   n.data = item;
+   n.next = next;
+   n.prev = prev;
+
+   if (prev)
+      node(prev).next = offset;
+   else
+      header().head = offset;
+   if (next)
+      node(next).prev = offset;
+   else
+      header().tail = offset;
+   header().numElements++;
+   return iterator(this, offset);
+}
+
+/*********************************************
+ * MAPPED LIST :: ERASE
+ * Unlink the node and keep it for reuse
+ *    INPUT  : the item to remove
+ *    OUTPUT : an iterator to the item after it
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+typename mapped_list <T> :: iterator mapped_list <T> :: erase(const iterator & it)
+{
+   if (it.offset == 0)
+      return end();
+
+   Node & n = node(it.offset);
+   uint64_t next = n.next;
+   uint64_t prev = n.prev;
+   if (prev)
+      node(prev).next = next;
+   else
+      header().head = next;
+   if (next)
+      node(next).prev = prev;
+   else
+      header().tail = prev;
+   header().numElements--;
+
+   free(it.offset);
+   return iterator(this, next);
+}
+
+/*********************************************
+ * MAPPED LIST :: CLEAR
+ * Hand every node to the free list at once. The file
+ * does not shrink.
+ *    INPUT  :
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void mapped_list <T> :: clear()
+{
+   Header & h = header();
+   if (h.tail)
+   {
+      node(h.tail).next = h.freeList;
+      h.freeList = h.head;
+   }
+   h.head = h.tail = 0;
+   h.numElements = 0;
+}
+
+}; // namespace custom
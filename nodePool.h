@@ -0,0 +1,667 @@
+/***********************************************************************
+ * Header:
+ *    NODE POOL
+ * Summary:
+ *    A fixed-size block allocator for the nodes of our linked containers.
+ *    Calling the global new and delete for every node is expensive and
+ *    scatters the nodes all over the heap. Instead, we carve nodes out of
+ *    large slabs and keep the freed ones on a free list for reuse.
+ *
+ *    Single nodes go through a small cache which belongs to the calling
+ *    thread, so most calls take no lock at all. A cache holds up to two
+ *    magazines of free slots. When both are full, one is handed to a
+ *    shared depot in a single locked step. A thread whose cache runs dry
+ *    takes a full magazine back from the depot. In a pipeline where
+ *    producers allocate and consumers free, the slots make their way
+ *    back to the producers a magazine at a time.
+ *
+ *    This will contain the class definition of:
+ *        pool         : Allocates slots of a single size and alignment
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+#include <cassert>     // for ASSERT
+#include <cstddef>     // for size_t
+#include <cstdint>     // for std::uintptr_t
+#include <mutex>       // for std::mutex
+#include <vector>      // for std::vector
+#include <algorithm>   // for std::upper_bound
+#include <new>         // for ::operator new
+#include <utility>     // for std::swap
+
+// Called with the number of slots each time the pool hands some out. The
+// benchmarks define it to count pooled nodes as allocations.
+#ifndef POOL_COUNT_ALLOCATE
+#define POOL_COUNT_ALLOCATE(num)
+#endif
+
+namespace custom
+{
+
+/**************************************************
+ * POOL
+ * Hands out slots of one size. Every node type of
+ * the same size and alignment shares one pool. The
+ * memory is kept for the lifetime of the program:
+ * freed slots are reused but never returned.
+ **************************************************/
+template <size_t size, size_t align>
+class pool
+{
+public:
+   // the distance between two adjacent slots in a slab
+   static const size_t stride = ((size < sizeof(void *) ? sizeof(void *) : size)
+                                 + align - 1) / align * align;
+
+   // number of slots we carve out of the system allocator at a time
+   static const size_t slabSlots = (64 * 1024) / stride ? (64 * 1024) / stride : 1;
+
+   static void * allocate();
+   static void * allocate(size_t num);   // a chain of num slots
+   static void * allocateRun(size_t num);
+   static void   free(void * p);
+   static void   free(void * pFirst, void * pLast);
+   static size_t slabCount();
+
+   // number of slots in one magazine of a thread cache
+   static const size_t magazineSlots = 64;
+
+private:
+   // a freed slot reuses its own storage to point to the next free slot
+   struct Slot
+   {
+      Slot * pNext;
+   };
+
+   // a chain of free slots passed around as a unit
+   struct Magazine
+   {
+      Slot * pFirst;
+      size_t num;
+   };
+
+   // one block from the system allocator
+   struct Slab
+   {
+      char * pBegin;
+      char * pEnd;
+   };
+
+   struct State
+   {
+      State() : pFree(nullptr), pBump(nullptr), pEnd(nullptr),
+                freeSorted(true), freeLongest(0), numSlots(0) { }
+      std::mutex lock;
+      Slot * pFree;                  // slots which have been returned
+      char * pBump;                  // next unused slot in the current slab
+      char * pEnd;                   // end of the current slab
+      bool   freeSorted;             // pFree is in address order
+      size_t freeLongest;            // if sorted, no run in pFree is longer
+      size_t numSlots;               // slots in all the slabs
+      std::vector<Slab> slabs;       // every slab we ever allocated, by address
+      std::vector<Magazine> depot;   // full magazines, with room for them all
+   };
+
+   // the calling thread's magazines. This has no destructor so it can
+   // still be read after the thread's Flusher has run, which is when a
+   // static list may be freeing its nodes.
+   struct Cache
+   {
+      Magazine loaded;       // allocate and free work on this one
+      Magazine previous;     // spare, so we do not bounce at the boundary
+      bool registered;       // the Flusher has been created
+      bool done;             // the Flusher has run; go to the pool directly
+   };
+
+   // gives a thread's magazines back to the pool when the thread ends
+   struct Flusher
+   {
+     ~Flusher();
+   };
+
+   // the state is never destroyed so that static lists can outlive it
+   static State & state()
+   {
+      static State * pState = new State;
+      return *pState;
+   }
+
+   static Cache & cache()
+   {
+      static thread_local Cache c = { { nullptr, 0 }, { nullptr, 0 }, false, false };
+      return c;
+   }
+
+   static void   registerFlusher(Cache & c);
+   static void   refill(Cache & c);
+   static void   spill(Cache & c);
+   static Slot * take(State & s, size_t num);
+   static void   give(State & s, Magazine & m);
+   static char * newSlab(State & s, size_t num);
+   static char * findRun(State & s, size_t num);
+   static void   sortFree(State & s);
+   static size_t slabOf(const State & s, const char * p);
+};
+
+/*********************************************
+ * POOL :: NEW SLAB
+ * Get a fresh block of num slots from the system
+ *    INPUT  : the pool state (locked) and the number of slots
+ *    OUTPUT : the start of the new block
+ *    COST   : O(1)
+ *********************************************/
+template <size_t size, size_t align>
+char * pool <size, align> :: newSlab(State & s, size_t num)
+{
+   // make room in the depot for every full magazine the slots could
+   // ever make up, so spilling one on the way out of free() never
+   // has to allocate
+   size_t magazines = (s.numSlots + num) / magazineSlots;
+   if (magazines > s.depot.capacity())
+      s.depot.reserve(magazines > 2 * s.depot.capacity() ? magazines : 2 * s.depot.capacity());
+
+   // the plain global new only promises the default alignment, so an
+   // over-aligned node type needs to ask for its alignment explicitly
+#if defined(__cpp_aligned_new)
+   const bool overAligned = align > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+   void * pRaw = overAligned
+               ? ::operator new(num * stride, std::align_val_t(align))
+               : ::operator new(num * stride);
+   char * pSlab = static_cast<char *>(pRaw);
+#else
+   // without aligned new, over-allocate and round the start up
+   const bool overAligned = align > alignof(std::max_align_t);
+   void * pRaw = ::operator new(num * stride + (overAligned ? align - 1 : 0));
+   char * pSlab = static_cast<char *>(pRaw);
+   if (overAligned)
+      pSlab += (align - reinterpret_cast<std::uintptr_t>(pSlab) % align) % align;
+#endif
+   try
+   {
+      Slab slab = { pSlab, pSlab + num * stride };
+      s.slabs.insert(std::upper_bound(s.slabs.begin(), s.slabs.end(), slab,
+                                      [](const Slab & lhs, const Slab & rhs)
+                                      { return lhs.pBegin < rhs.pBegin; }),
+                     slab);
+   }
+   catch (...)
+   {
+#if defined(__cpp_aligned_new)
+      if (overAligned)
+         ::operator delete(pRaw, std::align_val_t(align));
+      else
+         ::operator delete(pRaw);
+#else
+      ::operator delete(pRaw);
+#endif
+      throw;
+   }
+   s.numSlots += num;
+   return pSlab;
+}
+
+/*********************************************
+ * POOL :: TAKE
+ * Get num slots linked through their first word.
+ * Freed slots and spilled magazines are used up
+ * first; the rest come side-by-side from the
+ * current slab.
+ *    INPUT  : the pool state (locked) and the number of slots
+ *    OUTPUT : the first slot of the chain
+ *    COST   : O(n)
+ *********************************************/
+template <size_t size, size_t align>
+typename pool <size, align> :: Slot * pool <size, align> :: take(State & s, size_t num)
+{
+   Slot * pFirst = nullptr;
+   Slot ** ppLink = &pFirst;
+
+   // take what we can from the free list, then from the depot
+   while (num)
+   {
+      if (s.pFree == nullptr && !s.depot.empty())
+      {
+         give(s, s.depot.back());
+         s.depot.pop_back();
+      }
+      if (s.pFree == nullptr)
+         break;
+      *ppLink = s.pFree;
+      ppLink = &s.pFree->pNext;
+      s.pFree = s.pFree->pNext;
+      num--;
+   }
+
+   // carve the remainder out of slabs
+   while (num)
+   {
+      if (s.pBump == s.pEnd)
+      {
+         size_t slots = num > slabSlots ? num : slabSlots;
+         s.pBump = newSlab(s, slots);
+         s.pEnd  = s.pBump + slots * stride;
+      }
+      Slot * pSlot = reinterpret_cast<Slot *>(s.pBump);
+      s.pBump += stride;
+      *ppLink = pSlot;
+      ppLink = &pSlot->pNext;
+      num--;
+   }
+
+   *ppLink = nullptr;
+   return pFirst;
+}
+
+/*********************************************
+ * POOL :: GIVE
+ * Put a magazine on the free list, leaving it empty
+ *    INPUT  : the pool state (locked) and the magazine
+ *    OUTPUT :
+ *    COST   : O(n)
+ *********************************************/
+template <size_t size, size_t align>
+void pool <size, align> :: give(State & s, Magazine & m)
+{
+   if (m.num == 0)
+      return;
+   Slot * pLast = m.pFirst;
+   while (pLast->pNext)
+      pLast = pLast->pNext;
+   pLast->pNext = s.pFree;
+   s.pFree = m.pFirst;
+   s.freeSorted = false;
+   m.pFirst = nullptr;
+   m.num = 0;
+}
+
+/*********************************************
+ * POOL :: REGISTER FLUSHER
+ * Creating the thread_local Flusher registers its
+ * destructor for when this thread ends
+ *********************************************/
+template <size_t size, size_t align>
+void pool <size, align> :: registerFlusher(Cache & c)
+{
+   static thread_local Flusher flusher;
+   (void)flusher;
+   c.registered = true;
+}
+
+template <size_t size, size_t align>
+pool <size, align> :: Flusher :: ~Flusher()
+{
+   Cache & c = cache();
+   State & s = state();
+   std::lock_guard<std::mutex> guard(s.lock);
+   give(s, c.loaded);
+   give(s, c.previous);
+   c.done = true;
+}
+
+/*********************************************
+ * POOL :: REFILL
+ * The loaded magazine is empty. Swap in the spare if
+ * it has anything, else take a full magazine from the
+ * depot, else carve a new one out of the pool.
+ *    INPUT  : the calling thread's cache
+ *    OUTPUT :
+ *    COST   : O(1) usually, O(magazineSlots) when carving
+ *********************************************/
+template <size_t size, size_t align>
+void pool <size, align> :: refill(Cache & c)
+{
+   if (c.previous.num)
+   {
+      std::swap(c.loaded, c.previous);
+      return;
+   }
+
+   if (!c.registered)
+      registerFlusher(c);
+
+   State & s = state();
+   std::lock_guard<std::mutex> guard(s.lock);
+   if (!s.depot.empty())
+   {
+      c.loaded = s.depot.back();
+      s.depot.pop_back();
+   }
+   else
+   {
+      c.loaded.pFirst = take(s, magazineSlots);
+      c.loaded.num = magazineSlots;
+   }
+}
+
+/*********************************************
+ * POOL :: SPILL
+ * The loaded magazine is full. Keep it as the spare
+ * if the spare is empty, else send the full spare to
+ * the depot. This is on the way out of free(), so it
+ * must not throw: the depot already has room.
+ *    INPUT  : the calling thread's cache
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <size_t size, size_t align>
+void pool <size, align> :: spill(Cache & c)
+{
+   if (c.previous.num)
+   {
+      State & s = state();
+      std::lock_guard<std::mutex> guard(s.lock);
+      assert(s.depot.size() < s.depot.capacity());   // newSlab made room
+      s.depot.push_back(c.previous);
+   }
+   c.previous = c.loaded;
+   c.loaded.pFirst = nullptr;
+   c.loaded.num = 0;
+}
+
+/*********************************************
+ * POOL :: ALLOCATE
+ * Get one slot from this thread's cache
+ *    INPUT  :
+ *    OUTPUT : uninitialized storage for one node
+ *    COST   : O(1)
+ *********************************************/
+template <size_t size, size_t align>
+void * pool <size, align> :: allocate()
+{
+   POOL_COUNT_ALLOCATE(1);
+   Cache & c = cache();
+   if (c.done)
+   {
+      State & s = state();
+      std::lock_guard<std::mutex> guard(s.lock);
+      return take(s, 1);
+   }
+
+   if (c.loaded.num == 0)
+      refill(c);
+
+   Slot * pSlot = c.loaded.pFirst;
+   c.loaded.pFirst = pSlot->pNext;
+   c.loaded.num--;
+   return pSlot;
+}
+
+/*********************************************
+ * POOL :: ALLOCATE CHAIN
+ * Get num slots under one lock, linked through their
+ * first word. This skips the thread cache: it is
+ * already one lock for the whole chain.
+ *    INPUT  : the number of slots needed
+ *    OUTPUT : the first slot of the chain
+ *    COST   : O(n)
+ *********************************************/
+template <size_t size, size_t align>
+void * pool <size, align> :: allocate(size_t num)
+{
+   assert(num > 0);
+   POOL_COUNT_ALLOCATE(num);
+   State & s = state();
+   std::lock_guard<std::mutex> guard(s.lock);
+   return take(s, num);
+}
+
+/*********************************************
+ * POOL :: ALLOCATE RUN
+ * Get num slots which are adjacent in memory. A run
+ * of freed slots is used if there is one, so a list
+ * which is read or compacted over and over keeps
+ * reusing the same memory. Otherwise the run comes
+ * from fresh slab space.
+ *    INPUT  : the number of slots needed
+ *    OUTPUT : the first slot, the rest follow at stride
+ *    COST   : O(1) from fresh space; searching the freed
+ *             slots is O(f) in the number of them, plus
+ *             more to put them in order when frees have come
+ *             in since the last search
+ *********************************************/
+template <size_t size, size_t align>
+void * pool <size, align> :: allocateRun(size_t num)
+{
+   assert(num > 0);
+   POOL_COUNT_ALLOCATE(num);
+   State & s = state();
+   std::lock_guard<std::mutex> guard(s.lock);
+
+   if (char * pRun = findRun(s, num))
+      return pRun;
+
+   // big runs get a slab of their own
+   if (num > slabSlots)
+      return newSlab(s, num);
+
+   // the rest of the current slab is too small, so retire it to the free list
+   if (s.pBump + num * stride > s.pEnd)
+   {
+      for (; s.pBump != s.pEnd; s.pBump += stride)
+      {
+         Slot * pSlot = reinterpret_cast<Slot *>(s.pBump);
+         pSlot->pNext = s.pFree;
+         s.pFree = pSlot;
+         s.freeSorted = false;
+      }
+      s.pBump = newSlab(s, slabSlots);
+      s.pEnd  = s.pBump + slabSlots * stride;
+   }
+
+   void * p = s.pBump;
+   s.pBump += num * stride;
+   return p;
+}
+
+/*********************************************
+ * POOL :: FIND RUN
+ * Unlink num freed slots which are adjacent in one
+ * slab. A list freed whole leaves its nodes at the
+ * front of the free list in order, so look there
+ * first. Otherwise the depot is emptied onto the free
+ * list and the free list is put in address order, so
+ * adjacent slots are neighbors in the list. The list
+ * stays in order afterwards until something is freed.
+ *    INPUT  : the pool state (locked) and the number of slots
+ *    OUTPUT : the first slot of the run, or null if there is none
+ *    COST   : O(num) if the run is at the front, else O(f),
+ *             plus sortFree() if the list is out of order
+ *********************************************/
+template <size_t size, size_t align>
+char * pool <size, align> :: findRun(State & s, size_t num)
+{
+   if (Slot * pFirst = s.pFree)
+   {
+      char * pSlabEnd = s.slabs[slabOf(s, reinterpret_cast<char *>(pFirst))].pEnd;
+      Slot * pLast = pFirst;
+      size_t run = 1;
+      for (; run < num; run++, pLast = pLast->pNext)
+      {
+         char * pNext = reinterpret_cast<char *>(pLast) + stride;
+         if (pNext >= pSlabEnd || pLast->pNext != reinterpret_cast<Slot *>(pNext))
+            break;
+      }
+      if (run == num)
+      {
+         s.pFree = pLast->pNext;
+         return reinterpret_cast<char *>(pFirst);
+      }
+   }
+
+   while (!s.depot.empty())
+   {
+      give(s, s.depot.back());
+      s.depot.pop_back();
+   }
+   if (!s.freeSorted)
+      sortFree(s);
+   if (num > s.freeLongest)
+      return nullptr;
+
+   Slot ** ppFirst = &s.pFree;   // the link to the first slot of this run
+   Slot * pLast = nullptr;       // the last slot of this run
+   char * pSlabEnd = nullptr;    // the end of the slab this run is in
+   size_t run = 0;
+   size_t longest = 0;
+   for (Slot ** ppLink = &s.pFree; *ppLink; ppLink = &(*ppLink)->pNext)
+   {
+      char * p = reinterpret_cast<char *>(*ppLink);
+      if (run && p == reinterpret_cast<char *>(pLast) + stride && p < pSlabEnd)
+         run++;
+      else
+      {
+         pSlabEnd = s.slabs[slabOf(s, p)].pEnd;
+         ppFirst = ppLink;
+         run = 1;
+      }
+      pLast = *ppLink;
+
+      if (run == num)
+      {
+         Slot * pFirst = *ppFirst;
+         *ppFirst = pLast->pNext;
+         return reinterpret_cast<char *>(pFirst);
+      }
+      if (run > longest)
+         longest = run;
+   }
+
+   s.freeLongest = longest;
+   return nullptr;
+}
+
+/*********************************************
+ * POOL :: SORT FREE
+ * Relink the free list in address order. Rather than
+ * sort, mark each free slot in a bitmap of every slab,
+ * then read the bitmap back in order.
+ *    INPUT  : the pool state (locked)
+ *    OUTPUT :
+ *    COST   : O(f log s + t) for f free slots, s slabs, and
+ *             t slots in all the slabs
+ *********************************************/
+template <size_t size, size_t align>
+void pool <size, align> :: sortFree(State & s)
+{
+   // where each slab's bits start
+   std::vector<size_t> firstBit(s.slabs.size() + 1, 0);
+   for (size_t i = 0; i < s.slabs.size(); i++)
+      firstBit[i + 1] = firstBit[i] + (s.slabs[i].pEnd - s.slabs[i].pBegin) / stride;
+   std::vector<bool> isFree(firstBit.back(), false);
+
+   // slots freed together are usually in the same slab as the one before
+   size_t num = 0;
+   size_t i = 0;
+   for (Slot * p = s.pFree; p; p = p->pNext, num++)
+   {
+      char * pSlot = reinterpret_cast<char *>(p);
+      if (pSlot < s.slabs[i].pBegin || pSlot >= s.slabs[i].pEnd)
+         i = slabOf(s, pSlot);
+      isFree[firstBit[i] + (pSlot - s.slabs[i].pBegin) / stride] = true;
+   }
+
+   Slot ** ppLink = &s.pFree;
+   for (i = 0; i < s.slabs.size(); i++)
+      for (size_t bit = firstBit[i]; bit < firstBit[i + 1]; bit++)
+         if (isFree[bit])
+         {
+            Slot * pSlot = reinterpret_cast<Slot *>(s.slabs[i].pBegin +
+                                                    (bit - firstBit[i]) * stride);
+            *ppLink = pSlot;
+            ppLink = &pSlot->pNext;
+         }
+   *ppLink = nullptr;
+   s.freeSorted = true;
+   s.freeLongest = num;
+}
+
+/*********************************************
+ * POOL :: SLAB OF
+ * Which slab holds a slot
+ *    INPUT  : the pool state (locked) and the slot
+ *    OUTPUT : the index of its slab in s.slabs
+ *    COST   : O(log s)
+ *********************************************/
+template <size_t size, size_t align>
+size_t pool <size, align> :: slabOf(const State & s, const char * p)
+{
+   size_t lo = 0;
+   size_t hi = s.slabs.size();
+   while (hi - lo > 1)
+   {
+      size_t mid = (lo + hi) / 2;
+      if (s.slabs[mid].pBegin <= p)
+         lo = mid;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+/*********************************************
+ * POOL :: FREE
+ * Return one slot to this thread's cache, whichever
+ * thread allocated it
+ *    INPUT  : a slot from allocate()
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <size_t size, size_t align>
+void pool <size, align> :: free(void * p)
+{
+   if (p == nullptr)
+      return;
+
+   Cache & c = cache();
+   if (c.done)
+   {
+      free(p, p);
+      return;
+   }
+
+   // a thread which only frees must still give its slots back when it ends
+   if (!c.registered)
+      registerFlusher(c);
+
+   if (c.loaded.num == magazineSlots)
+      spill(c);
+
+   Slot * pSlot = static_cast<Slot *>(p);
+   pSlot->pNext = c.loaded.pFirst;
+   c.loaded.pFirst = pSlot;
+   c.loaded.num++;
+}
+
+/*********************************************
+ * POOL :: FREE CHAIN
+ * Return a chain of slots already linked through
+ * their first word, taking the lock only once
+ *    INPUT  : the first and last slot of the chain
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <size_t size, size_t align>
+void pool <size, align> :: free(void * pFirst, void * pLast)
+{
+   State & s = state();
+   std::lock_guard<std::mutex> guard(s.lock);
+   static_cast<Slot *>(pLast)->pNext = s.pFree;
+   s.pFree = static_cast<Slot *>(pFirst);
+   s.freeSorted = false;
+}
+
+/*********************************************
+ * POOL :: SLAB COUNT
+ * How many blocks the pool has taken from the system
+ *********************************************/
+template <size_t size, size_t align>
+size_t pool <size, align> :: slabCount()
+{
+   State & s = state();
+   std::lock_guard<std::mutex> guard(s.lock);
+   return s.slabs.size();
+}
+
+}; // namespace custom
@@ -0,0 +1,660 @@
+/***********************************************************************
+ * Header:
+ *    PARALLEL LIST
+ * Summary:
+ *    Algorithms which spread one pass over a list across every core.
+ *    A list can not be split without walking it, so we walk it once,
+ *    remembering every k-th node in a chunk_index. That walk only
+ *    follows pNext, which is much cheaper than the work most callers
+ *    do per item. The chunks are then handed out to a pool of threads
+ *    through one atomic counter, so a thread that finishes early just
+ *    takes the next chunk.
+ *
+ *    A chunk_index can be kept and reused for several passes as long
+ *    as nobody inserts or erases in the meantime.
+ *
+ *    This will contain the class definition of:
+ *        threadPool      : The worker threads shared by every algorithm
+ *        chunk_index     : Every k-th node of a list
+ *        for_each        : Call a function on every item in parallel
+ *        transform_reduce: Map every item and combine the results
+ *        copy            : Copy a list with every thread
+ *        sort            : Merge sort a list with every thread
+ *        ingest          : Build a list while its source is still being read
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+#include <atomic>              // for std::atomic
+#include <condition_variable>  // for std::condition_variable
+#include <exception>           // for std::exception_ptr
+#include <functional>          // for std::function
+#include <iterator>            // for std::move_iterator
+#include <mutex>               // for std::mutex
+#include <thread>              // for std::thread
+#include <vector>              // for std::vector
+#include "list.h"
+
+class TestParallelList;    // forward declaration for unit tests
+
+namespace custom
+{
+namespace parallel
+{
+
+/**************************************************
+ * THREAD POOL
+ * One worker per core beyond the caller's. The pool
+ * runs one job at a time; a job started while
+ * another is running, including one started from
+ * inside a job, runs on the calling thread alone.
+ **************************************************/
+class threadPool
+{
+   friend class ::TestParallelList; // give unit tests access to the privates
+public:
+   // the shared pool lives for the rest of the program
+   static threadPool & instance()
+   {
+      static threadPool * pPool = new threadPool(std::thread::hardware_concurrency());
+      return *pPool;
+   }
+
+   // how many threads run a job, counting the caller
+   size_t size() const { return workers.size() + 1; }
+
+   // call job on every worker and on this thread, and wait for them all
+   void run(const std::function<void()> & job);
+
+private:
+   threadPool(unsigned int numThreads);
+  ~threadPool();
+   void work();
+
+   std::mutex busy;                    // held while a job is running
+   std::mutex lock;                    // guards everything below
+   std::condition_variable wake;       // a new job is ready
+   std::condition_variable finished;   // the last worker is done
+   const std::function<void()> * pJob;
+   unsigned long long generation;      // which job the workers should run
+   size_t running;                     // workers still on this job
+   bool stopping;                      // the workers should exit
+   std::vector<std::thread> workers;
+};
+
+/*****************************************
+ * THREAD POOL :: CONSTRUCTOR and DESTRUCTOR
+ ****************************************/
+inline threadPool :: threadPool(unsigned int numThreads) :
+   pJob(nullptr), generation(0), running(0), stopping(false)
+{
+   for (unsigned int i = 1; i < numThreads; i++)
+      workers.emplace_back(&threadPool::work, this);
+}
+
+inline threadPool :: ~threadPool()
+{
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      stopping = true;
+   }
+   wake.notify_all();
+   for (auto & worker : workers)
+      worker.join();
+}
+
+/*****************************************
+ * THREAD POOL :: WORK
+ * Sleep until there is a new job, run it, repeat
+ ****************************************/
+inline void threadPool :: work()
+{
+   unsigned long long seen = 0;
+   for (;;)
+   {
+      const std::function<void()> * pMine;
+      {
+         std::unique_lock<std::mutex> guard(lock);
+         wake.wait(guard, [this, seen]() { return stopping || generation != seen; });
+         if (stopping)
+            return;
+         seen = generation;
+         pMine = pJob;
+      }
+
+      (*pMine)();
+
+      std::lock_guard<std::mutex> guard(lock);
+      if (--running == 0)
+         finished.notify_one();
+   }
+}
+
+/*****************************************
+ * THREAD POOL :: RUN
+ * The job must not throw; the algorithms below
+ * catch what the user's function throws
+ ****************************************/
+inline void threadPool :: run(const std::function<void()> & job)
+{
+   std::unique_lock<std::mutex> guardBusy(busy, std::try_to_lock);
+   if (!guardBusy.owns_lock() || workers.empty())
+   {
+      job();
+      return;
+   }
+
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      pJob = &job;
+      running = workers.size();
+      generation++;
+   }
+   wake.notify_all();
+
+   job();
+
+   std::unique_lock<std::mutex> guard(lock);
+   finished.wait(guard, [this]() { return running == 0; });
+}
+
+/**************************************************
+ * CHUNK INDEX
+ * The first node of every chunk of a list, found in
+ * one walk. Chunk i runs from starts[i] up to
+ * starts[i + 1], and the last one to the end.
+ **************************************************/
+template <typename T>
+class chunk_index
+{
+   friend class ::TestParallelList; // give unit tests access to the privates
+public:
+   typedef typename list <T> :: iterator iterator;
+
+   // about chunksPerThread chunks for every thread in the pool
+   static const size_t chunksPerThread = 8;
+
+   // no chunk smaller than this is worth handing to another thread
+   static const size_t minChunk = 1024;
+
+   chunk_index(list <T> & l);
+   chunk_index(list <T> & l, size_t chunkSize);
+
+   size_t   size()               const { return starts.size(); }
+   size_t   items()              const { return numItems;      }
+   iterator begin(size_t chunk)  const { return starts[chunk];  }
+   iterator end  (size_t chunk)  const
+   {
+      return chunk + 1 < starts.size() ? starts[chunk + 1] : iterator();
+   }
+
+   // how many items are in a chunk; only the last may be short
+   size_t count(size_t chunk) const
+   {
+      return chunk + 1 < starts.size() ? chunkSize : numItems - chunkSize * chunk;
+   }
+
+private:
+   void build(list <T> & l, size_t chunkSize);
+
+   std::vector<iterator> starts;
+   size_t chunkSize;
+   size_t numItems;
+};
+
+/*****************************************
+ * CHUNK INDEX :: CONSTRUCTOR
+ * Pick a chunk size which keeps every thread busy
+ * without making the chunks too small to matter
+ ****************************************/
+template <typename T>
+chunk_index <T> :: chunk_index(list <T> & l)
+{
+   size_t chunks = threadPool::instance().size() * chunksPerThread;
+   size_t chunkSize = l.size() / chunks;
+   build(l, chunkSize < minChunk ? minChunk : chunkSize);
+}
+
+template <typename T>
+chunk_index <T> :: chunk_index(list <T> & l, size_t chunkSize)
+{
+   build(l, chunkSize ? chunkSize : 1);
+}
+
+/*****************************************
+ * CHUNK INDEX :: BUILD
+ * Walk the list once, keeping every k-th node
+ *    INPUT  : the list and k
+ *    OUTPUT :
+ *    COST   : O(n)
+ ****************************************/
+template <typename T>
+void chunk_index <T> :: build(list <T> & l, size_t chunkSize)
+{
+   this->chunkSize = chunkSize;
+   numItems = l.size();
+   starts.reserve(l.size() / chunkSize + 1);
+   size_t left = 0;
+   for (auto it = l.begin(); it != l.end(); ++it, --left)
+      if (left == 0)
+      {
+         starts.push_back(it);
+         left = chunkSize;
+      }
+}
+
+/*****************************************
+ * RUN CHUNKS
+ * Call doChunk(i) once for every chunk on every
+ * thread of the pool, each thread taking the next
+ * chunk nobody has claimed. The first exception
+ * stops the handing out and is thrown here.
+ ****************************************/
+template <class DoChunk>
+void runChunks(size_t numChunks, DoChunk doChunk)
+{
+   std::atomic<size_t> next(0);
+   std::exception_ptr error;
+   std::mutex errorLock;
+
+   threadPool::instance().run([&]()
+   {
+      for (size_t chunk = next++; chunk < numChunks; chunk = next++)
+      {
+         try
+         {
+            doChunk(chunk);
+         }
+         catch (...)
+         {
+            std::lock_guard<std::mutex> guard(errorLock);
+            if (!error)
+               error = std::current_exception();
+            next = numChunks;
+         }
+      }
+   });
+
+   if (error)
+      std::rethrow_exception(error);
+}
+
+/*****************************************
+ * FOR EACH
+ * Call f on every item. The items are visited in
+ * no particular order, several at once, so f must
+ * be safe to call from many threads.
+ *    INPUT  : the list (or its chunk index) and f
+ *    OUTPUT :
+ *    COST   : O(n / threads) plus one walk to index
+ ****************************************/
+template <typename T, class Function>
+void for_each(const chunk_index <T> & index, Function f)
+{
+   runChunks(index.size(), [&index, &f](size_t chunk)
+   {
+      for (auto it = index.begin(chunk); it != index.end(chunk); ++it)
+         f(*it);
+   });
+}
+
+template <typename T, class Function>
+void for_each(list <T> & l, Function f)
+{
+   for_each(chunk_index <T> (l), f);
+}
+
+/*****************************************
+ * TRANSFORM REDUCE
+ * init reduce transform(item) reduce ... for every
+ * item. reduce must be associative, but need not be
+ * commutative: the chunks are combined in order.
+ *    INPUT  : the list (or its chunk index), the initial value,
+ *             the combining function, and the mapping function
+ *    OUTPUT : the combined value
+ *    COST   : O(n / threads) plus one walk to index
+ ****************************************/
+template <typename T, typename Value, class Reduce, class Transform>
+Value transform_reduce(const chunk_index <T> & index, Value init,
+                       Reduce reduce, Transform transform)
+{
+   // one slot per chunk, padded so threads do not share a cache line
+   struct Partial
+   {
+      Value value;
+      char padding[64];
+   };
+   std::vector<Partial> partials(index.size(), Partial{ init, {} });
+
+   runChunks(index.size(), [&](size_t chunk)
+   {
+      auto it = index.begin(chunk);
+      Value value = transform(*it);
+      for (++it; it != index.end(chunk); ++it)
+         value = reduce(value, transform(*it));
+      partials[chunk].value = value;
+   });
+
+   for (size_t chunk = 0; chunk < partials.size(); chunk++)
+      init = reduce(init, partials[chunk].value);
+   return init;
+}
+
+template <typename T, typename Value, class Reduce, class Transform>
+Value transform_reduce(list <T> & l, Value init, Reduce reduce, Transform transform)
+{
+   return transform_reduce(chunk_index <T> (l), init, reduce, transform);
+}
+
+/*****************************************
+ * COPY
+ * Make dst a copy of the indexed list. Every chunk
+ * is copied into its own chain of nodes on whichever
+ * thread claims it; then the chains are stitched
+ * together in order, one relink per chunk. dst is only
+ * changed once every copy has succeeded, so if one
+ * throws, dst is left as it was. dst must not be the
+ * list which was indexed.
+ *    INPUT  : the index of the list to copy, and the destination
+ *    OUTPUT :
+ *    COST   : O(n / threads)
+ ****************************************/
+template <typename T>
+void copy(const chunk_index <T> & index, list <T> & dst)
+{
+   LIST_TRACE_OP(COPY_ASSIGN);
+   LIST_STATS_OP(COPY_ASSIGN);
+   typedef typename list <T> :: Node Node;
+
+   // the ends of every copied chunk, padded so threads do not share a cache line
+   struct Segment
+   {
+      Node * pFirst;
+      Node * pLast;
+      char padding[64];
+   };
+   std::vector<Segment> segments(index.size(), Segment{ nullptr, nullptr, {} });
+
+   try
+   {
+      runChunks(index.size(), [&index, &segments](size_t chunk)
+      {
+         LIST_STATS_OP(COPY_ASSIGN);
+         list <T> :: copyChain(index.begin(chunk).p, index.count(chunk),
+                               segments[chunk].pFirst, segments[chunk].pLast);
+      });
+   }
+   catch (...)
+   {
+      for (size_t chunk = 0; chunk < segments.size(); chunk++)
+         list <T> :: deleteChain(segments[chunk].pFirst);
+      throw;
+   }
+
+   for (size_t chunk = 1; chunk < segments.size(); chunk++)
+   {
+      segments[chunk - 1].pLast->pNext = segments[chunk].pFirst;
+      segments[chunk].pFirst->pPrev = segments[chunk - 1].pLast;
+   }
+
+   dst.clear();
+   if (!segments.empty())
+   {
+      dst.pHead = segments.front().pFirst;
+      dst.pTail = segments.back().pLast;
+      dst.setCount(index.items());
+   }
+}
+
+/*****************************************
+ * COPY
+ * A list too small to split is copied the usual
+ * way, reusing the nodes dst already has
+ ****************************************/
+template <typename T>
+void copy(list <T> & src, list <T> & dst)
+{
+   if (&src == &dst)
+      return;
+
+   chunk_index <T> index(src);
+   if (index.size() < 2)
+      dst = src;
+   else
+      copy(index, dst);
+}
+
+/*****************************************
+ * SORT
+ * Cut the list into pieces by relinking, merge sort
+ * each piece on its own thread, then merge the pieces
+ * in pairs, each round in parallel, until one is left.
+ * Nothing is copied or allocated and equal items keep
+ * their order. comp is copied for every thread. If it
+ * throws, every item is still in the list, but in no
+ * particular order.
+ *    INPUT  : the list, how to compare, and how many pieces
+ *             (0 for one per thread)
+ *    OUTPUT :
+ *    COST   : O(n log n / threads), plus O(n) for the last merge
+ ****************************************/
+template <typename T, class Compare>
+void sort(list <T> & l, Compare comp, size_t pieces)
+{
+   LIST_TRACE_OP(SORT);
+   typedef typename list <T> :: Node  Node;
+   typedef typename list <T> :: Chain Chain;
+
+   if (pieces == 0)
+   {
+      pieces = threadPool::instance().size();
+      if (l.size() / pieces < chunk_index <T> :: minChunk)
+         pieces = l.size() / chunk_index <T> :: minChunk;
+   }
+   if (pieces > l.size())
+      pieces = l.size();
+   if (pieces < 2)
+   {
+      l.sort(comp);
+      return;
+   }
+
+   // cut the list into pieces which differ in size by at most one
+   std::vector<Chain> chains(pieces);
+   size_t perPiece = l.size() / pieces;
+   size_t extra = l.size() % pieces;
+   Node * p = l.pHead;
+   for (size_t piece = 0; piece < pieces; piece++)
+   {
+      chains[piece].pFirst = p;
+      for (size_t i = (piece < extra ? 0 : 1); i < perPiece; i++)
+         p = p->pNext;
+      chains[piece].pLast = p;
+      p = p->pNext;
+      chains[piece].pLast->pNext = nullptr;
+   }
+
+   l.forgetFinger();
+   try
+   {
+      runChunks(pieces, [&chains, &comp](size_t piece)
+      {
+         Compare mine(comp);
+         list <T> :: sortChain(chains[piece], mine);
+      });
+
+      // each round halves the number of chains; an odd one out waits
+      while (chains.size() > 1)
+      {
+         runChunks(chains.size() / 2, [&chains, &comp](size_t pair)
+         {
+            Compare mine(comp);
+            list <T> :: mergeChains(chains[2 * pair], chains[2 * pair + 1], mine);
+         });
+
+         size_t kept = 0;
+         for (size_t i = 0; i < chains.size(); i += 2)
+            chains[kept++] = chains[i];
+         chains.resize(kept);
+      }
+   }
+   catch (...)
+   {
+      // every chain is whole, whether or not its thread got to it
+      for (size_t i = 1; i < chains.size(); i++)
+         list <T> :: joinChains(chains[0], chains[i]);
+      l.pHead = chains[0].pFirst;
+      l.pTail = chains[0].pLast;
+      throw;
+   }
+
+   l.pHead = chains[0].pFirst;
+   l.pTail = chains[0].pLast;
+}
+
+template <typename T, class Compare>
+void sort(list <T> & l, Compare comp)
+{
+   sort(l, comp, 0);
+}
+
+template <typename T>
+void sort(list <T> & l)
+{
+   sort(l, std::less<T>(), 0);
+}
+
+/*****************************************
+ * INGEST
+ * Append everything source produces to dst, reading
+ * and linking at the same time. A second thread calls
+ * source to fill one chunk while this thread builds the
+ * nodes for the chunk before it. There are only ever
+ * two chunks, so memory stays bounded however long
+ * the source runs.
+ *
+ * source(chunk, max) appends up to max items to chunk
+ * and returns false once there is nothing more to read.
+ * It is only ever called from the second thread, one
+ * call at a time. The pool runs one job on every
+ * thread, which does not fit a two-stage pipeline,
+ * so the reading thread is a thread of its own.
+ *
+ * The items are linked into a list of their own and
+ * spliced onto dst at the end, so if source or a copy
+ * throws, dst is left as it was and the exception is
+ * thrown here.
+ *    INPUT  : the list to append to, the source, and the chunk size
+ *    OUTPUT :
+ *    COST   : O(n), as fast as the slower of the two stages
+ ****************************************/
+template <typename T, class Source>
+void ingest(list <T> & dst, Source source, size_t chunkSize)
+{
+   if (chunkSize == 0)
+      chunkSize = 1;
+
+   std::mutex lock;                   // guards everything below but the chunks
+   std::condition_variable changed;
+   std::vector<T> chunks[2];          // a chunk belongs to the reader unless it is full
+   bool full[2] = { false, false };
+   bool finished = false;             // the reader will fill no more chunks
+   bool stopping = false;             // the linker gave up; the reader should too
+   std::exception_ptr error;
+
+   std::thread reader([&]()
+   {
+      try
+      {
+         bool more = true;
+         for (size_t i = 0; more; i = 1 - i)
+         {
+            {
+               std::unique_lock<std::mutex> guard(lock);
+               changed.wait(guard, [&]() { return !full[i] || stopping; });
+               if (stopping)
+                  return;
+            }
+            chunks[i].clear();
+            more = source(chunks[i], chunkSize);
+            std::lock_guard<std::mutex> guard(lock);
+            full[i] = true;
+            changed.notify_all();
+         }
+      }
+      catch (...)
+      {
+         std::lock_guard<std::mutex> guard(lock);
+         error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> guard(lock);
+      finished = true;
+      changed.notify_all();
+   });
+
+   list <T> items;
+   try
+   {
+      for (size_t i = 0; ; i = 1 - i)
+      {
+         {
+            std::unique_lock<std::mutex> guard(lock);
+            changed.wait(guard, [&]() { return full[i] || finished; });
+            if (!full[i])
+               break;
+         }
+         items.push_back_bulk(std::make_move_iterator(chunks[i].begin()),
+                              std::make_move_iterator(chunks[i].end()));
+         std::lock_guard<std::mutex> guard(lock);
+         full[i] = false;
+         changed.notify_all();
+      }
+   }
+   catch (...)
+   {
+      {
+         std::lock_guard<std::mutex> guard(lock);
+         stopping = true;
+         changed.notify_all();
+      }
+      reader.join();
+      throw;
+   }
+
+   reader.join();
+   if (error)
+      std::rethrow_exception(error);
+   dst.splice(dst.end(), items);
+}
+
+template <typename T, class Source>
+void ingest(list <T> & dst, Source source)
+{
+   ingest(dst, source, 4096);
+}
+
+/*****************************************
+ * INGEST
+ * The same, reading from a range such as a pair of
+ * std::istream_iterator
+ ****************************************/
+template <typename T, class Iterator>
+void ingest(list <T> & dst, Iterator first, Iterator last, size_t chunkSize)
+{
+   ingest(dst, [&first, &last](std::vector<T> & chunk, size_t max)
+   {
+      for (; chunk.size() < max && first != last; ++first)
+         chunk.push_back(*first);
+      return first != last;
+   }, chunkSize);
+}
+
+template <typename T, class Iterator>
+void ingest(list <T> & dst, Iterator first, Iterator last)
+{
+   ingest(dst, first, last, 4096);
+}
+
+}; // namespace parallel
+}; // namespace custom
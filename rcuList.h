@@ -0,0 +1,542 @@
+/***********************************************************************
+ * Header:
+ *    RCU LIST
+ * Summary:
+ *    A list for data which is read far more often than it is changed.
+ *    Readers walk the list without taking a lock. Writers take turns
+ *    through one mutex and never change a node a reader can see: a new
+ *    node is built completely and then published with a release store,
+ *    and an erased node is unlinked but left alone until every reader
+ *    that might still be standing on it has finished. This is the
+ *    read-copy-update idea.
+ *
+ *    Readers announce themselves through rcu, which keeps one epoch
+ *    record per thread. Entering a read section writes the current
+ *    epoch to the thread's own record, so readers never write anything
+ *    another thread writes. A node erased in epoch e may be freed once
+ *    every record is either idle or at e or later: that is the grace
+ *    period.
+ *
+ *    This will contain the class definition of:
+ *        rcu          : Read sections and grace periods
+ *        rcu_list     : A singly linked list with lock-free readers
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+#include <atomic>      // for std::atomic
+#include <cstdint>     // for uint64_t
+#include <mutex>       // for std::mutex
+#include <thread>      // for std::this_thread::yield
+#include <utility>     // for std::move
+#include <vector>      // for std::vector
+#include "nodePool.h"  // for custom::pool
+
+class TestRcuList;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/**************************************************
+ * RCU
+ * Tracks which epoch every reading thread started in.
+ * The records live forever and are reused when a
+ * thread exits.
+ **************************************************/
+class rcu
+{
+public:
+   /*************************************************
+    * READ SCOPE
+    * Nothing unlinked after a ReadScope starts is
+    * freed until it ends. Read sections may nest. A
+    * thread must not wait for a grace period while it
+    * is inside one.
+    *************************************************/
+   class ReadScope
+   {
+   public:
+      ReadScope()  { enter(); }
+     ~ReadScope()  { leave(); }
+      ReadScope(const ReadScope &) = delete;
+      ReadScope & operator = (const ReadScope &) = delete;
+   };
+
+   static void enter();
+   static void leave();
+
+   // start a new epoch; things unlinked before this may be freed in it
+   static uint64_t advance();
+
+   // the oldest epoch a reader may still be in, or UINT64_MAX if none is reading
+   static uint64_t oldestReader();
+
+   // wait until every reader has left the epochs before this one
+   static void synchronize(uint64_t epoch);
+
+private:
+   struct Record
+   {
+      Record() : epoch(0), pNext(nullptr), active(true) { }
+      std::atomic<uint64_t> epoch; // 0 when not reading
+      Record * pNext;              // set once, before the record is published
+      std::atomic<bool> active;    // is a thread using this record
+      char padding[64];            // keep other records off our cache line
+   };
+
+   struct Domain
+   {
+      Domain() : epoch(1), pRecords(nullptr) { }
+      std::atomic<uint64_t> epoch;
+      std::atomic<Record *> pRecords;
+   };
+
+   // the calling thread's record and how deeply it is nested
+   struct Local
+   {
+      Local();
+     ~Local();
+      Record * pRecord;
+      int depth;
+   };
+
+   static Domain & domain()
+   {
+      static Domain * pDomain = new Domain;
+      return *pDomain;
+   }
+
+   static Local & local()
+   {
+      static thread_local Local l;
+      return l;
+   }
+};
+
+/*********************************************
+ * RCU :: LOCAL
+ * Reuse the record of a thread which has exited, or
+ * add a new one to the front of the list
+ *********************************************/
+inline rcu :: Local :: Local() : pRecord(nullptr), depth(0)
+{
+   Domain & d = domain();
+   for (Record * p = d.pRecords.load(); p; p = p->pNext)
+   {
+      bool expected = false;
+      if (!p->active.load() && p->active.compare_exchange_strong(expected, true))
+      {
+         pRecord = p;
+         return;
+      }
+   }
+
+   pRecord = new Record;
+   pRecord->pNext = d.pRecords.load();
+   while (!d.pRecords.compare_exchange_weak(pRecord->pNext, pRecord))
+      ;
+}
+
+inline rcu :: Local :: ~Local()
+{
+   pRecord->epoch.store(0, std::memory_order_release);
+   pRecord->active.store(false);
+}
+
+/*********************************************
+ * RCU :: ENTER
+ * Publish the epoch we are reading in. The fence
+ * keeps our reads of the list from moving ahead of
+ * the store: either a writer sees our record, or we
+ * see everything it unlinked before it looked.
+ *********************************************/
+inline void rcu :: enter()
+{
+   Local & l = local();
+   if (l.depth++ == 0)
+   {
+      l.pRecord->epoch.store(domain().epoch.load(std::memory_order_acquire),
+                             std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+   }
+}
+
+inline void rcu :: leave()
+{
+   Local & l = local();
+   if (--l.depth == 0)
+      l.pRecord->epoch.store(0, std::memory_order_release);
+}
+
+/*********************************************
+ * RCU :: ADVANCE
+ * Called by a writer after it unlinks nodes. They
+ * can be freed once no reader is older than the
+ * epoch returned.
+ *********************************************/
+inline uint64_t rcu :: advance()
+{
+   uint64_t epoch = domain().epoch.fetch_add(1) + 1;
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   return epoch;
+}
+
+/*********************************************
+ * RCU :: OLDEST READER
+ *    INPUT  :
+ *    OUTPUT : the smallest epoch of any thread in a read section
+ *    COST   : O(threads)
+ *********************************************/
+inline uint64_t rcu :: oldestReader()
+{
+   uint64_t oldest = UINT64_MAX;
+   for (Record * p = domain().pRecords.load(); p; p = p->pNext)
+   {
+      uint64_t epoch = p->epoch.load(std::memory_order_acquire);
+      if (epoch != 0 && epoch < oldest)
+         oldest = epoch;
+   }
+   return oldest;
+}
+
+/*********************************************
+ * RCU :: SYNCHRONIZE
+ * Block until the grace period for epoch has passed
+ *********************************************/
+inline void rcu :: synchronize(uint64_t epoch)
+{
+   while (oldestReader() < epoch)
+      std::this_thread::yield();
+}
+
+/**************************************************
+ * RCU LIST
+ * Lock-free readers, one writer at a time
+ **************************************************/
+template <typename T>
+class rcu_list
+{
+   friend class ::TestRcuList; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   rcu_list() : pHead(nullptr), pTail(nullptr), numElements(0) { }
+   rcu_list(const rcu_list &) = delete;
+   rcu_list & operator = (const rcu_list &) = delete;
+  ~rcu_list();
+
+   //
+   // Write: these take the writer lock
+   //
+
+   void push_front(const T & data);
+   void push_back (const T & data);
+   template <class Predicate>
+   size_t remove_if(Predicate pred);
+   size_t remove(const T & data);
+   void clear();
+   void synchronize();
+
+   //
+   // Read: these take no lock
+   //
+
+   template <class Function>
+   void for_each(Function f) const;
+   template <class Predicate>
+   bool find_if(Predicate pred, T & data) const;
+   bool contains(const T & data) const;
+
+   //
+   // Status
+   //
+
+   size_t size()  const { return numElements.load(std::memory_order_relaxed); }
+   bool   empty() const { return size() == 0;                                 }
+
+private:
+   class Node;
+
+   // a node which is unlinked but may still be read
+   struct Retired
+   {
+      Node * p;
+      uint64_t epoch;
+   };
+
+   void unlink(Node * p);
+   void reclaim();
+
+   std::atomic<Node *> pHead;            // what readers start from
+   std::mutex writeLock;                 // guards everything below
+   Node * pTail;
+   std::vector<Retired> retired;
+   std::atomic<size_t> numElements;
+};
+
+/*************************************************
+ * RCU LIST NODE
+ * Readers only follow pNext. pPrev is for writers.
+ *************************************************/
+template <typename T>
+class rcu_list <T> :: Node
+{
+public:
+   Node(const T & data) : data(data), pNext(nullptr), pPrev(nullptr) { }
+
+   static void * operator new   (size_t)      { return pool<sizeof(Node), alignof(Node)>::allocate(); }
+   static void   operator delete(void * p)    { pool<sizeof(Node), alignof(Node)>::free(p);           }
+
+   const T data;                 // never changes once published
+   std::atomic<Node *> pNext;    // pointer to next node
+   Node * pPrev;                 // pointer to previous node, guarded by writeLock
+};
+
+/*****************************************
+ * RCU LIST :: DESTRUCTOR
+ * Nobody else may be using the list by now
+ ****************************************/
+template <typename T>
+rcu_list <T> :: ~rcu_list()
+{
+   for (Node * p = pHead.load(); p; )
+   {
+      Node * pDelete = p;
+      p = p->pNext.load();
+      delete pDelete;
+   }
+   for (size_t i = 0; i < retired.size(); i++)
+      delete retired[i].p;
+}
+
+/*********************************************
+ * RCU LIST :: PUSH FRONT
+ * The node is complete before the release store
+ * makes it visible
+ *    INPUT  : the item to add
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void rcu_list <T> :: push_front(const T & data)
+{
+   Node * pNew = new Node(data);
+   std::lock_guard<std::mutex> guard(writeLock);
+
+   Node * pFirst = pHead.load(std::memory_order_relaxed);
+   pNew->pNext.store(pFirst, std::memory_order_relaxed);
+   if (pFirst)
+      pFirst->pPrev = pNew;
+   else
+      pTail = pNew;
+   pHead.store(pNew, std::memory_order_release);
+   numElements.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*********************************************
+ * RCU LIST :: PUSH BACK
+ *    INPUT  : the item to add
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void rcu_list <T> :: push_back(const T & data)
+{
+   Node * pNew = new Node(data);
+   std::lock_guard<std::mutex> guard(writeLock);
+
+   pNew->pPrev = pTail;
+   if (pTail)
+      pTail->pNext.store(pNew, std::memory_order_release);
+   else
+      pHead.store(pNew, std::memory_order_release);
+   pTail = pNew;
+   numElements.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*********************************************
+ * RCU LIST :: UNLINK
+ * Take p out of the list. A reader standing on p can
+ * still follow its pNext, which we leave alone.
+ *    INPUT  : a node in the list (writeLock held)
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void rcu_list <T> :: unlink(Node * p)
+{
+   Node * pNext = p->pNext.load(std::memory_order_relaxed);
+   if (p->pPrev)
+      p->pPrev->pNext.store(pNext, std::memory_order_release);
+   else
+      pHead.store(pNext, std::memory_order_release);
+   if (pNext)
+      pNext->pPrev = p->pPrev;
+   else
+      pTail = p->pPrev;
+   numElements.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/*********************************************
+ * RCU LIST :: RECLAIM
+ * Free every retired node whose grace period has
+ * passed. This never waits.
+ *    INPUT  : (writeLock held)
+ *    OUTPUT :
+ *    COST   : O(threads + retired)
+ *********************************************/
+template <typename T>
+void rcu_list <T> :: reclaim()
+{
+   if (retired.empty())
+      return;
+
+   uint64_t oldest = rcu::oldestReader();
+   size_t kept = 0;
+   for (size_t i = 0; i < retired.size(); i++)
+      if (retired[i].epoch > oldest)
+         retired[kept++] = retired[i];
+      else
+         delete retired[i].p;
+   retired.resize(kept);
+}
+
+/*********************************************
+ * RCU LIST :: REMOVE IF
+ * Unlink every item pred accepts. One new epoch
+ * covers all of them.
+ *    INPUT  : the predicate
+ *    OUTPUT : how many were removed
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+template <class Predicate>
+size_t rcu_list <T> :: remove_if(Predicate pred)
+{
+   std::lock_guard<std::mutex> guard(writeLock);
+
+   size_t first = retired.size();
+   for (Node * p = pHead.load(std::memory_order_relaxed); p; )
+   {
+      Node * pNext = p->pNext.load(std::memory_order_relaxed);
+      if (pred(p->data))
+      {
+         unlink(p);
+         Retired node = { p, 0 };
+         retired.push_back(node);
+      }
+      p = pNext;
+   }
+
+   size_t removed = retired.size() - first;
+   if (removed)
+   {
+      uint64_t epoch = rcu::advance();
+      for (size_t i = first; i < retired.size(); i++)
+         retired[i].epoch = epoch;
+   }
+   reclaim();
+   return removed;
+}
+
+/*********************************************
+ * RCU LIST :: REMOVE
+ *********************************************/
+template <typename T>
+size_t rcu_list <T> :: remove(const T & data)
+{
+   return remove_if([&data](const T & item) { return item == data; });
+}
+
+/*********************************************
+ * RCU LIST :: CLEAR
+ * Readers already on the list finish their walk
+ *********************************************/
+template <typename T>
+void rcu_list <T> :: clear()
+{
+   remove_if([](const T &) { return true; });
+}
+
+/*********************************************
+ * RCU LIST :: SYNCHRONIZE
+ * Wait for the readers and free every retired node.
+ * Must not be called from inside a read section.
+ *    INPUT  :
+ *    OUTPUT :
+ *    COST   : as long as the slowest reader
+ *********************************************/
+template <typename T>
+void rcu_list <T> :: synchronize()
+{
+   std::lock_guard<std::mutex> guard(writeLock);
+   if (retired.empty())
+      return;
+
+   uint64_t newest = 0;
+   for (size_t i = 0; i < retired.size(); i++)
+      if (retired[i].epoch > newest)
+         newest = retired[i].epoch;
+   rcu::synchronize(newest);
+   reclaim();
+}
+
+/*********************************************
+ * RCU LIST :: FOR EACH
+ * Call f on every item from front to back. f may
+ * see an item which is being removed, but never a
+ * half-built one. f must not write to the list.
+ *    INPUT  : the function to call
+ *    OUTPUT :
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+template <class Function>
+void rcu_list <T> :: for_each(Function f) const
+{
+   rcu::ReadScope scope;
+   for (Node * p = pHead.load(std::memory_order_acquire); p;
+        p = p->pNext.load(std::memory_order_acquire))
+      f(p->data);
+}
+
+/*********************************************
+ * RCU LIST :: FIND IF
+ * Copy out the first item pred accepts
+ *    INPUT  : the predicate and where to copy the item
+ *    OUTPUT : whether one was found
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+template <class Predicate>
+bool rcu_list <T> :: find_if(Predicate pred, T & data) const
+{
+   rcu::ReadScope scope;
+   for (Node * p = pHead.load(std::memory_order_acquire); p;
+        p = p->pNext.load(std::memory_order_acquire))
+      if (pred(p->data))
+      {
+         data = p->data;
+         return true;
+      }
+   return false;
+}
+
+/*********************************************
+ * RCU LIST :: CONTAINS
+ *********************************************/
+template <typename T>
+bool rcu_list <T> :: contains(const T & data) const
+{
+   rcu::ReadScope scope;
+   for (Node * p = pHead.load(std::memory_order_acquire); p;
+        p = p->pNext.load(std::memory_order_acquire))
+      if (p->data == data)
+         return true;
+   return false;
+}
+
+}; // namespace custom
@@ -0,0 +1,247 @@
+/***********************************************************************
+ * Header:
+ *    SHARDED LIST
+ * Summary:
+ *    A list for many threads which mostly add items and only now and
+ *    then look at all of them, like a metrics collector. The items are
+ *    spread over several ordinary lists, called shards, and each shard
+ *    has its own lock. Every thread is given a shard of its own the
+ *    first time it pushes, so with as many shards as threads nobody
+ *    waits on anybody else, and the shards sit on separate cache lines
+ *    so they do not fight over memory either.
+ *
+ *    There is no single order across shards. Items pushed by one thread
+ *    stay in the order that thread pushed them. drain() splices every
+ *    shard onto one custom::list in O(shards), without copying an item.
+ *
+ *    This will contain the class definition of:
+ *        sharded_list : Many lists, each with its own lock
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+#include <atomic>      // for std::atomic
+#include <mutex>       // for std::mutex
+#include <thread>      // for std::thread::hardware_concurrency
+#include <utility>     // for std::move
+#include <vector>      // for std::vector
+#include "list.h"      // for custom::list
+
+class TestShardedList;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/**************************************************
+ * SHARDED LIST
+ * A list split over independently locked shards
+ **************************************************/
+template <typename T>
+class sharded_list
+{
+   friend class ::TestShardedList; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   sharded_list(size_t numShards = 0);
+   sharded_list(const sharded_list &) = delete;
+   sharded_list & operator = (const sharded_list &) = delete;
+
+   //
+   // Insert
+   //
+
+   void push_back(const T &  data);
+   void push_back(      T && data);
+
+   //
+   // Remove
+   //
+
+   void    drain(list <T> & into);
+   list <T> drain();
+   void    clear();
+
+   //
+   // Traverse
+   //
+
+   template <class Function>
+   void for_each(Function f);
+
+   //
+   // Status
+   //
+
+   size_t size();
+   bool   empty() { return size() == 0; }
+   size_t shards() const { return vShards.size(); }
+
+private:
+   struct Shard
+   {
+      std::mutex lock;        // guards items
+      list <T> items;
+      char padding[64];       // keeps the next shard's lock off this cache line
+   };
+
+   Shard & myShard();
+   static size_t threadSlot();
+
+   std::vector<Shard> vShards;
+};
+
+/*****************************************
+ * SHARDED LIST :: CONSTRUCTOR
+ * One shard per hardware thread unless told otherwise
+ ****************************************/
+template <typename T>
+sharded_list <T> :: sharded_list(size_t numShards) :
+   vShards(numShards ? numShards :
+           std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1)
+{
+}
+
+/*********************************************
+ * SHARDED LIST :: THREAD SLOT
+ * Every thread takes the next number the first time
+ * it asks, so threads spread evenly over the shards.
+ *    INPUT  :
+ *    OUTPUT : this thread's number
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+size_t sharded_list <T> :: threadSlot()
+{
+   static std::atomic<size_t> next(0);
+   thread_local size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+   return slot;
+}
+
+/*********************************************
+ * SHARDED LIST :: MY SHARD
+ * The shard this thread pushes to
+ *    INPUT  :
+ *    OUTPUT : the shard
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+typename sharded_list <T> :: Shard & sharded_list <T> :: myShard()
+{
+   return vShards[threadSlot() % vShards.size()];
+}
+
+/*********************************************
+ * SHARDED LIST :: PUSH BACK
+ * Add an item to this thread's shard. The node is
+ * built before the lock is taken.
+ *    INPUT  : the item
+ *    OUTPUT :
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void sharded_list <T> :: push_back(const T & data)
+{
+   list <T> one;
+   one.push_back(data);
+   Shard & shard = myShard();
+   std::lock_guard<std::mutex> guard(shard.lock);
+   shard.items.splice(shard.items.end(), one);
+}
+
+template <typename T>
+void sharded_list <T> :: push_back(T && data)
+{
+   list <T> one;
+   one.push_back(std::move(data));
+   Shard & shard = myShard();
+   std::lock_guard<std::mutex> guard(shard.lock);
+   shard.items.splice(shard.items.end(), one);
+}
+
+/*********************************************
+ * SHARDED LIST :: DRAIN
+ * Move every item onto the end of into, one shard
+ * after another. Only one shard is locked at a time, so
+ * pushes carry on while we drain.
+ *    INPUT  : the list to fill
+ *    OUTPUT : every shard is left empty
+ *    COST   : O(shards)
+ *********************************************/
+template <typename T>
+void sharded_list <T> :: drain(list <T> & into)
+{
+   for (auto & shard : vShards)
+   {
+      std::lock_guard<std::mutex> guard(shard.lock);
+      into.splice(into.end(), shard.items);
+   }
+}
+
+template <typename T>
+list <T> sharded_list <T> :: drain()
+{
+   list <T> all;
+   drain(all);
+   return all;
+}
+
+/*********************************************
+ * SHARDED LIST :: CLEAR
+ * Throw every item away. The nodes are freed outside
+ * the shard locks.
+ *    INPUT  :
+ *    OUTPUT :
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+void sharded_list <T> :: clear()
+{
+   list <T> all;
+   drain(all);
+}
+
+/*********************************************
+ * SHARDED LIST :: FOR EACH
+ * Call f on every item, shard by shard. This is a view
+ * of all the shards but not a snapshot: a shard already
+ * visited may get more items while we look at the next.
+ *    INPUT  : the function to call on each item
+ *    OUTPUT :
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+template <class Function>
+void sharded_list <T> :: for_each(Function f)
+{
+   for (auto & shard : vShards)
+   {
+      std::lock_guard<std::mutex> guard(shard.lock);
+      for (auto it = shard.items.begin(); it != shard.items.end(); ++it)
+         f(*it);
+   }
+}
+
+/*********************************************
+ * SHARDED LIST :: SIZE
+ * Add up the shards
+ *    INPUT  :
+ *    OUTPUT : the number of items
+ *    COST   : O(shards)
+ *********************************************/
+template <typename T>
+size_t sharded_list <T> :: size()
+{
+   size_t num = 0;
+   for (auto & shard : vShards)
+   {
+      std::lock_guard<std::mutex> guard(shard.lock);
+      num += shard.items.size();
+   }
+   return num;
+}
+
+}; // namespace custom
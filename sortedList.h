@@ -0,0 +1,442 @@
+/***********************************************************************
+ * Header:
+ *    SORTED LIST
+ * Summary:
+ *    A list which keeps its items in order and finds them in O(log n).
+ *    Every node is linked to its neighbors front to back like any list,
+ *    which is level 0. About one node in four also reaches forward on
+ *    level 1 to the next node which got that far, one in sixteen on
+ *    level 2, and so on: a skip list. A search starts on the top level
+ *    and drops down one level each time the next step would go too far,
+ *    so it skips past most of the list.
+ *
+ *    Only the nodes taller than level 0 carry a tower of forward
+ *    pointers, so most nodes cost no more than a list node. Iterators
+ *    only use level 0 and walk both ways.
+ *
+ *    Items with equal keys are kept in the order they were inserted.
+ *    The items cannot be changed in place, since that could break the
+ *    order: erase one and insert the new value instead.
+ *
+ *    This will contain the class definition of:
+ *        sorted_list : A list kept in order, with skip levels
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+#include <cstdint>     // for uint32_t
+#include <functional>  // for std::less
+#include <utility>     // for std::move
+#include "nodePool.h"  // for custom::pool
+
+class TestSortedList;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/**************************************************
+ * SORTED LIST
+ * A list kept in order by Compare
+ **************************************************/
+template <typename T, class Compare = std::less<T>>
+class sorted_list
+{
+   friend class ::TestSortedList; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   sorted_list(const Compare & compare = Compare());
+   sorted_list(const sorted_list &) = delete;
+   sorted_list & operator = (const sorted_list &) = delete;
+  ~sorted_list() { clear(); }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin()  const { return iterator(pHeads[0]); }
+   iterator rbegin() const { return iterator(pTail);     }
+   iterator end()    const { return iterator();          }
+
+   //
+   // Search
+   //
+
+   iterator find       (const T & key) const;
+   iterator lower_bound(const T & key) const;
+   iterator upper_bound(const T & key) const;
+   bool     contains   (const T & key) const { return find(key) != end(); }
+
+   //
+   // Access
+   //
+
+   const T & front() const;
+   const T & back()  const;
+
+   //
+   // Insert
+   //
+
+   iterator insert(const T & data);
+   iterator insert(T && data);
+
+   //
+   // Remove
+   //
+
+   size_t   erase(const T & key);
+   iterator erase(const iterator & it);
+   void     clear();
+
+   //
+   // Status
+   //
+
+   bool   empty() const { return numElements == 0; }
+   size_t size()  const { return numElements;      }
+
+private:
+   class Node;
+   static const int maxLevels = 16;   // enough for 4^16 items
+
+   void findBefore(const T & key, bool after, Node * pBefore[]) const;
+   iterator link(Node * pNew);
+   int randomHeight();
+
+   Node * pHeads[maxLevels];   // the first node on each level
+   Node * pTail;               // the last node on level 0
+   size_t numElements;
+   int    numLevels;           // how many levels are in use
+   uint32_t seed;              // for the heights
+   Compare compare;
+};
+
+/*************************************************
+ * SORTED LIST NODE
+ * A list node, and for the taller ones a tower of
+ * forward pointers for levels 1 and up
+ *************************************************/
+template <typename T, class Compare>
+class sorted_list <T, Compare> :: Node
+{
+public:
+   Node(const T & data) : data(data)            { }
+   Node(T && data)      : data(std::move(data)) { }
+  ~Node() { delete [] pTower; }
+
+   static void * operator new   (size_t)      { return pool<sizeof(Node), alignof(Node)>::allocate(); }
+   static void   operator delete(void * p)    { pool<sizeof(Node), alignof(Node)>::free(p);           }
+
+   // the next node on a level, 0 being the list itself
+   Node * & next(int level) { return level ? pTower[level - 1] : pNext; }
+
+   T data;
+   Node * pNext = nullptr;
+   Node * pPrev = nullptr;
+   Node ** pTower = nullptr;   // height - 1 forward pointers, or none
+   int height = 1;
+};
+
+/*************************************************
+ * SORTED LIST ITERATOR
+ * Walks level 0 both ways. The items are read only.
+ *************************************************/
+template <typename T, class Compare>
+class sorted_list <T, Compare> :: iterator
+{
+   friend class ::TestSortedList;
+   template <typename TT, class CC>
+   friend class custom::sorted_list;
+public:
+   iterator()         : p(nullptr) { }
+   iterator(Node * p) : p(p)       { }
+
+   bool operator == (const iterator & rhs) const { return p == rhs.p; }
+   bool operator != (const iterator & rhs) const { return p != rhs.p; }
+
+   const T & operator * () const
+   {
+      if (p)
+         return p->data;
+      else
+         throw "ERROR: unable to access data from an empty list";
+   }
+
+   iterator & operator ++ ()           { if (p) p = p->pNext; return *this; }
+   iterator   operator ++ (int postfix) { iterator old(*this); ++(*this); return old; }
+   iterator & operator -- ()           { if (p) p = p->pPrev; return *this; }
+   iterator   operator -- (int postfix) { iterator old(*this); --(*this); return old; }
+
+private:
+   Node * p;
+};
+
+/*****************************************
+ * SORTED LIST :: CONSTRUCTOR
+ ****************************************/
+template <typename T, class Compare>
+sorted_list <T, Compare> :: sorted_list(const Compare & compare) :
+   pTail(nullptr), numElements(0), numLevels(1), seed(2463534242u), compare(compare)
+{
+   for (int level = 0; level < maxLevels; level++)
+      pHeads[level] = nullptr;
+}
+
+/*********************************************
+ * SORTED LIST :: FIND BEFORE
+ * Walk down from the top level, stopping on each level
+ * at the last node which comes before the key. With
+ * after set, equal keys count as before, so we stop
+ * after them instead.
+ *    INPUT  : the key and which side of the equal keys
+ *    OUTPUT : pBefore[level] for every level in use,
+ *             nullptr where the key goes first
+ *    COST   : O(log n)
+ *********************************************/
+template <typename T, class Compare>
+void sorted_list <T, Compare> :: findBefore(const T & key, bool after, Node * pBefore[]) const
+{
+   Node * p = nullptr;   // nullptr stands for the heads
+   for (int level = numLevels - 1; level >= 0; level--)
+   {
+      for (;;)
+      {
+         Node * pNext = p ? p->next(level) : pHeads[level];
+         if (pNext == nullptr ||
+             (after ? compare(key, pNext->data) : !compare(pNext->data, key)))
+            break;
+         p = pNext;
+      }
+      pBefore[level] = p;
+   }
+}
+
+/*********************************************
+ * SORTED LIST :: LOWER BOUND, UPPER BOUND and FIND
+ *    INPUT  : the key
+ *    OUTPUT : the first item not before the key, the
+ *             first item after it, or the first equal
+ *             item (end() if there is none)
+ *    COST   : O(log n)
+ *********************************************/
+template <typename T, class Compare>
+typename sorted_list <T, Compare> :: iterator
+sorted_list <T, Compare> :: lower_bound(const T & key) const
+{
+   Node * pBefore[maxLevels];
+   findBefore(key, false, pBefore);
+   return iterator(pBefore[0] ? pBefore[0]->pNext : pHeads[0]);
+}
+
+template <typename T, class Compare>
+typename sorted_list <T, Compare> :: iterator
+sorted_list <T, Compare> :: upper_bound(const T & key) const
+{
+   Node * pBefore[maxLevels];
+   findBefore(key, true, pBefore);
+   return iterator(pBefore[0] ? pBefore[0]->pNext : pHeads[0]);
+}
+
+template <typename T, class Compare>
+typename sorted_list <T, Compare> :: iterator
+sorted_list <T, Compare> :: find(const T & key) const
+{
+   iterator it = lower_bound(key);
+   if (it.p && !compare(key, it.p->data))
+      return it;
+   return end();
+}
+
+/*********************************************
+ * SORTED LIST :: FRONT and BACK
+ *********************************************/
+template <typename T, class Compare>
+const T & sorted_list <T, Compare> :: front() const
+{
+   if (pHeads[0] == nullptr)
+      throw "ERROR: unable to access data from an empty list";
+   return pHeads[0]->data;
+}
+
+template <typename T, class Compare>
+const T & sorted_list <T, Compare> :: back() const
+{
+   if (pTail == nullptr)
+      throw "ERROR: unable to access data from an empty list";
+   return pTail->data;
+}
+
+/*********************************************
+ * SORTED LIST :: INSERT
+ * Put the item after any equal to it
+ *    INPUT  : the item
+ *    OUTPUT : an iterator to it
+ *    COST   : O(log n)
+ *********************************************/
+template <typename T, class Compare>
+typename sorted_list <T, Compare> :: iterator sorted_list <T, Compare> :: insert(const T & data)
+{
+   return link(new Node(data));
+}
+
+template <typename T, class Compare>
+typename sorted_list <T, Compare> :: iterator sorted_list <T, Compare> :: insert(T && data)
+{
+   return link(new Node(std::move(data)));
+}
+
+/*********************************************
+ * SORTED LIST :: LINK
+ * Give a new node its height and link it in on every
+ * level it reaches
+ *    INPUT  : the node
+ *    OUTPUT : an iterator to it
+ *    COST   : O(log n)
+ *********************************************/
+template <typename T, class Compare>
+typename sorted_list <T, Compare> :: iterator sorted_list <T, Compare> :: link(Node * pNew)
+{
+   int height = randomHeight();
+   if (height > 1)
+   {
+      try
+      {
+         pNew->pTower = new Node * [height - 1];
+      }
+      catch (...)
+      {
+         delete pNew;
+         throw;
+      }
+      pNew->height = height;
+   }
+
+   Node * pBefore[maxLevels];
+   findBefore(pNew->data, true, pBefore);
+   for (int level = numLevels; level < height; level++)
+      pBefore[level] = nullptr;
+   if (height > numLevels)
+      numLevels = height;
+
+   for (int level = 0; level < height; level++)
+   {
+      Node * & pLink = pBefore[level] ? pBefore[level]->next(level) : pHeads[level];
+      pNew->next(level) = pLink;
+      pLink = pNew;
+   }
+
+   pNew->pPrev = pBefore[0];
+   if (pNew->pNext)
+      pNew->pNext->pPrev = pNew;
+   else
+      pTail = pNew;
+
+   numElements++;
+   return iterator(pNew);
+}
+
+/*********************************************
+ * SORTED LIST :: ERASE
+ * Unlink a node from every level it is on. The search
+ * lands just before the first equal key; if there are
+ * several, walk on along each level to the node itself.
+ *    INPUT  : the item to remove
+ *    OUTPUT : an iterator to the item after it
+ *    COST   : O(log n)
+ *********************************************/
+template <typename T, class Compare>
+typename sorted_list <T, Compare> :: iterator sorted_list <T, Compare> :: erase(const iterator & it)
+{
+   Node * pErase = it.p;
+   if (pErase == nullptr)
+      return end();
+   Node * pNext = pErase->pNext;
+
+   Node * pBefore[maxLevels];
+   findBefore(pErase->data, false, pBefore);
+   for (int level = 0; level < pErase->height; level++)
+   {
+      Node * p = pBefore[level];
+      Node * pLinkNext = p ? p->next(level) : pHeads[level];
+      while (pLinkNext != pErase)
+      {
+         p = pLinkNext;
+         pLinkNext = p->next(level);
+      }
+      (p ? p->next(level) : pHeads[level]) = pErase->next(level);
+   }
+
+   if (pNext)
+      pNext->pPrev = pErase->pPrev;
+   else
+      pTail = pErase->pPrev;
+   while (numLevels > 1 && pHeads[numLevels - 1] == nullptr)
+      numLevels--;
+
+   delete pErase;
+   numElements--;
+   return iterator(pNext);
+}
+
+/*********************************************
+ * SORTED LIST :: ERASE KEY
+ * Remove every item equal to the key
+ *    INPUT  : the key
+ *    OUTPUT : how many were removed
+ *    COST   : O(log n) for each one removed
+ *********************************************/
+template <typename T, class Compare>
+size_t sorted_list <T, Compare> :: erase(const T & key)
+{
+   size_t num = 0;
+   for (iterator it = find(key); it != end(); it = find(key))
+   {
+      erase(it);
+      num++;
+   }
+   return num;
+}
+
+/*********************************************
+ * SORTED LIST :: CLEAR
+ *    COST   : O(n)
+ *********************************************/
+template <typename T, class Compare>
+void sorted_list <T, Compare> :: clear()
+{
+   while (pHeads[0])
+   {
+      Node * pDelete = pHeads[0];
+      pHeads[0] = pHeads[0]->pNext;
+      delete pDelete;
+   }
+   for (int level = 0; level < maxLevels; level++)
+      pHeads[level] = nullptr;
+   pTail = nullptr;
+   numElements = 0;
+   numLevels = 1;
+}
+
+/*********************************************
+ * SORTED LIST :: RANDOM HEIGHT
+ * One level, then one more with a chance of 1 in 4
+ * each time. Two bits of a xorshift number per level.
+ *********************************************/
+template <typename T, class Compare>
+int sorted_list <T, Compare> :: randomHeight()
+{
+   seed ^= seed << 13;
+   seed ^= seed >> 17;
+   seed ^= seed << 5;
+   int height = 1;
+   for (uint32_t bits = seed; height < maxLevels && (bits & 3) == 0; bits >>= 2)
+      height++;
+   return height;
+}
+
+}; // namespace custom
@@ -0,0 +1,421 @@
+/***********************************************************************
+ * Header:
+ *    SPLIT LIST
+ * Summary:
+ *    A list for large items which keeps its links apart from its data.
+ *    In list, every node holds the item and then pNext and pPrev, so
+ *    for a 256 byte record the links sit four cache lines past the
+ *    start of the node, and any walk along the list pulls in a line of
+ *    every node. Here a node is only the two links and a pointer to
+ *    the item: 24 bytes, drawn from a pool of their own, so the nodes
+ *    of a list sit packed together and a walk which never looks at the
+ *    items (counting, reversing, finding a position to splice at)
+ *    touches a fraction of the memory. The items come from a second
+ *    pool of item-sized slots, in the order they were added.
+ *
+ *    Reading an item costs one more pointer than in list. For small
+ *    items, where the links and the item share a cache line anyway,
+ *    use list.
+ *
+ *    This will contain the class definition of:
+ *        split_list : A list with its links and its items stored apart
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+#include <new>         // for placement new
+#include <utility>     // for std::move and std::swap
+#include "nodePool.h"  // for custom::pool
+
+class TestSplitList;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/**************************************************
+ * SPLIT LIST
+ * A list of small link nodes, each pointing at its
+ * item in a separate pool
+ **************************************************/
+template <typename T>
+class split_list
+{
+   friend class ::TestSplitList; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   split_list() : pHead(nullptr), pTail(nullptr), numElements(0) { }
+   split_list(const split_list & rhs);
+   split_list & operator = (const split_list &) = delete;
+  ~split_list() { clear(); }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin()  { return iterator(pHead); }
+   iterator rbegin() { return iterator(pTail); }
+   iterator end()    { return iterator();      }
+
+   //
+   // Access
+   //
+
+   T & front();
+   T & back();
+
+   //
+   // Insert
+   //
+
+   void push_front(const T & data) { insert(begin(), data);            }
+   void push_front(T && data)      { insert(begin(), std::move(data)); }
+   void push_back (const T & data) { insert(end(),   data);            }
+   void push_back (T && data)      { insert(end(),   std::move(data)); }
+   iterator insert(iterator it, const T & data);
+   iterator insert(iterator it, T && data);
+   void splice(iterator it, split_list & rhs);
+
+   //
+   // Remove
+   //
+
+   void pop_front() { erase(begin());  }
+   void pop_back()  { erase(rbegin()); }
+   iterator erase(const iterator & it);
+   void clear();
+
+   //
+   // Links only: none of these read an item
+   //
+
+   void reverse();
+   iterator iterator_at(size_t index);
+   size_t recount() const;
+
+   //
+   // Status
+   //
+
+   bool   empty() const { return numElements == 0; }
+   size_t size()  const { return numElements;      }
+
+private:
+   class Node;
+   typedef pool<sizeof(T), alignof(T)> items;
+
+   iterator link(iterator it, T * pData);
+   static void deleteItem(T * pData);
+
+   Node * pHead;         // the first link
+   Node * pTail;         // the last link
+   size_t numElements;
+};
+
+/*************************************************
+ * SPLIT LIST NODE
+ * Just the links, and where the item is
+ *************************************************/
+template <typename T>
+class split_list <T> :: Node
+{
+public:
+   Node(T * pData) : pNext(nullptr), pPrev(nullptr), pData(pData) { }
+
+   static void * operator new   (size_t)      { return pool<sizeof(Node), alignof(Node)>::allocate(); }
+   static void   operator delete(void * p)    { pool<sizeof(Node), alignof(Node)>::free(p);           }
+
+   Node * pNext;
+   Node * pPrev;
+   T * pData;
+};
+
+/*************************************************
+ * SPLIT LIST ITERATOR
+ * Walks the links; only * reaches the item
+ *************************************************/
+template <typename T>
+class split_list <T> :: iterator
+{
+   friend class ::TestSplitList;
+   template <typename TT>
+   friend class custom::split_list;
+public:
+   iterator()         : p(nullptr) { }
+   iterator(Node * p) : p(p)       { }
+
+   bool operator == (const iterator & rhs) const { return p == rhs.p; }
+   bool operator != (const iterator & rhs) const { return p != rhs.p; }
+
+   T & operator * ()
+   {
+      if (p)
+         return *p->pData;
+      else
+         throw "ERROR: unable to access data from an empty list";
+   }
+
+   iterator & operator ++ ()           { if (p) p = p->pNext; return *this; }
+   iterator   operator ++ (int postfix) { iterator old(*this); ++(*this); return old; }
+   iterator & operator -- ()           { if (p) p = p->pPrev; return *this; }
+   iterator   operator -- (int postfix) { iterator old(*this); --(*this); return old; }
+
+private:
+   Node * p;
+};
+
+/*****************************************
+ * SPLIT LIST :: COPY CONSTRUCTOR
+ ****************************************/
+template <typename T>
+split_list <T> :: split_list(const split_list & rhs) :
+   pHead(nullptr), pTail(nullptr), numElements(0)
+{
+   for (const Node * p = rhs.pHead; p; p = p->pNext)
+      push_back(*p->pData);
+}
+
+/*********************************************
+ * SPLIT LIST :: FRONT and BACK
+ *********************************************/
+template <typename T>
+T & split_list <T> :: front()
+{
+   if (pHead == nullptr)
+      throw "ERROR: unable to access data from an empty list";
+   return *pHead->pData;
+}
+
+template <typename T>
+T & split_list <T> :: back()
+{
+   if (pTail == nullptr)
+      throw "ERROR: unable to access data from an empty list";
+   return *pTail->pData;
+}
+
+/*********************************************
+ * SPLIT LIST :: INSERT
+ * Build the item in its own pool, then link a node
+ * to it just before it
+ *    INPUT  : where to put it and the item
+ *    OUTPUT : an iterator to the new item
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+typename split_list <T> :: iterator split_list <T> :: insert(iterator it, const T & data)
+{
+   void * p = items::allocate();
+   try
+   {
+      return link(it, new (p) T(data));
+   }
+   catch (...)
+   {
+      items::free(p);
+      throw;
+   }
+}
+
+template <typename T>
+typename split_list <T> :: iterator split_list <T> :: insert(iterator it, T && data)
+{
+   void * p = items::allocate();
+   try
+   {
+      return link(it, new (p) T(std::move(data)));
+   }
+   catch (...)
+   {
+      items::free(p);
+      throw;
+   }
+}
+
+/*********************************************
+ * SPLIT LIST :: LINK
+ * Put a node for pData in front of it, or at the end
+ * if it is end(). If the node can not be allocated
+ * the item is destroyed again.
+ *    INPUT  : where to put it and the built item
+ *    OUTPUT : an iterator to the new node
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+typename split_list <T> :: iterator split_list <T> :: link(iterator it, T * pData)
+{
+   Node * pNew;
+   try
+   {
+      pNew = new Node(pData);
+   }
+   catch (...)
+   {
+      pData->~T();
+      throw;
+   }
+
+   Node * pAfter = it.p;
+   Node * pBefore = pAfter ? pAfter->pPrev : pTail;
+   pNew->pNext = pAfter;
+   pNew->pPrev = pBefore;
+   if (pBefore)
+      pBefore->pNext = pNew;
+   else
+      pHead = pNew;
+   if (pAfter)
+      pAfter->pPrev = pNew;
+   else
+      pTail = pNew;
+   numElements++;
+   return iterator(pNew);
+}
+
+/*********************************************
+ * SPLIT LIST :: SPLICE
+ * Move every node of rhs in front of it. Neither the
+ * nodes nor the items move.
+ *    INPUT  : where to put them, and the list to take them from
+ *    OUTPUT : rhs is left empty
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+void split_list <T> :: splice(iterator it, split_list & rhs)
+{
+   if (&rhs == this || rhs.empty())
+      return;
+
+   Node * pAfter = it.p;
+   Node * pBefore = pAfter ? pAfter->pPrev : pTail;
+   rhs.pHead->pPrev = pBefore;
+   if (pBefore)
+      pBefore->pNext = rhs.pHead;
+   else
+      pHead = rhs.pHead;
+   rhs.pTail->pNext = pAfter;
+   if (pAfter)
+      pAfter->pPrev = rhs.pTail;
+   else
+      pTail = rhs.pTail;
+
+   numElements += rhs.numElements;
+   rhs.pHead = rhs.pTail = nullptr;
+   rhs.numElements = 0;
+}
+
+/*********************************************
+ * SPLIT LIST :: ERASE
+ *    INPUT  : the item to remove
+ *    OUTPUT : an iterator to the item after it
+ *    COST   : O(1)
+ *********************************************/
+template <typename T>
+typename split_list <T> :: iterator split_list <T> :: erase(const iterator & it)
+{
+   Node * p = it.p;
+   if (p == nullptr)
+      return end();
+   Node * pNext = p->pNext;
+
+   if (p->pPrev)
+      p->pPrev->pNext = p->pNext;
+   else
+      pHead = p->pNext;
+   if (p->pNext)
+      p->pNext->pPrev = p->pPrev;
+   else
+      pTail = p->pPrev;
+
+   deleteItem(p->pData);
+   delete p;
+   numElements--;
+   return iterator(pNext);
+}
+
+/*********************************************
+ * SPLIT LIST :: CLEAR
+ *    COST   : O(n)
+ *********************************************/
+template <typename T>
+void split_list <T> :: clear()
+{
+   while (pHead)
+   {
+      Node * pDelete = pHead;
+      pHead = pHead->pNext;
+      deleteItem(pDelete->pData);
+      delete pDelete;
+   }
+   pTail = nullptr;
+   numElements = 0;
+}
+
+/*********************************************
+ * SPLIT LIST :: REVERSE
+ * Swap the links of every node, and the ends
+ *    INPUT  :
+ *    OUTPUT : the items in the opposite order
+ *    COST   : O(n), touching only the nodes
+ *********************************************/
+template <typename T>
+void split_list <T> :: reverse()
+{
+   for (Node * p = pHead; p; p = p->pPrev)   // pPrev is the old pNext by now
+      std::swap(p->pNext, p->pPrev);
+   std::swap(pHead, pTail);
+}
+
+/*********************************************
+ * SPLIT LIST :: ITERATOR AT
+ * Walk to a position from the nearer end
+ *    INPUT  : the position
+ *    OUTPUT : an iterator to it, or end() past the end
+ *    COST   : O(n), touching only the nodes
+ *********************************************/
+template <typename T>
+typename split_list <T> :: iterator split_list <T> :: iterator_at(size_t index)
+{
+   if (index >= numElements)
+      return end();
+   Node * p;
+   if (index < numElements / 2)
+      for (p = pHead; index > 0; index--)
+         p = p->pNext;
+   else
+      for (p = pTail, index = numElements - 1 - index; index > 0; index--)
+         p = p->pPrev;
+   return iterator(p);
+}
+
+/*********************************************
+ * SPLIT LIST :: RECOUNT
+ * Count the nodes by walking them, to check size()
+ *    INPUT  :
+ *    OUTPUT : the number of nodes
+ *    COST   : O(n), touching only the nodes
+ *********************************************/
+template <typename T>
+size_t split_list <T> :: recount() const
+{
+   size_t num = 0;
+   for (const Node * p = pHead; p; p = p->pNext)
+      num++;
+   return num;
+}
+
+/*********************************************
+ * SPLIT LIST :: DELETE ITEM
+ * Destroy an item and give its slot back
+ *********************************************/
+template <typename T>
+void split_list <T> :: deleteItem(T * pData)
+{
+   pData->~T();
+   items::free(pData);
+}
+
+}; // namespace custom
@@ -0,0 +1,483 @@
+/***********************************************************************
+ * Header:
+ *    TEST CONCURRENT LIST
+ * Summary:
+ *    Unit tests for concurrent_list
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "concurrentList.h"
+#include "unitTest.h"
+
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestConcurrentList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Insert
+      test_pushback_standard();
+      test_pushfront_empty();
+      test_pushfront_standard();
+      test_pushbackBulk_standard();
+
+      // Remove
+      test_popfront_empty();
+      test_popfront_standard();
+      test_popfront_last();
+      test_popfront_count();
+      test_popfront_throws();
+      test_popfrontBulk_some();
+      test_popfrontBulk_all();
+
+      // Traverse
+      test_forEach_standard();
+      test_contains_standard();
+
+      // Threads
+      test_threads_pushPop();
+      test_threads_bulk();
+
+#ifdef LIST_CACHE_ALIGNED
+      // Layout
+      test_layout_cacheAligned();
+#endif // LIST_CACHE_ALIGNED
+
+      report("ConcurrentList");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // a new list is just the dummy
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::concurrent_list<int> l;
+      // verify
+      assertUnit(l.pHead != nullptr);
+      assertUnit(l.pTail == l.pHead);
+      if (l.pHead)
+      {
+         assertUnit(l.pHead->pNext == nullptr);
+         assertUnit(l.pHead->hasData == false);
+      }
+      assertUnit(l.size() == 0);
+      assertUnit(l.empty());
+   }  // teardown
+
+   /***************************************
+    * PUSH BACK and PUSH FRONT
+    ***************************************/
+
+   // push_back links after the tail
+   void test_pushback_standard()
+   {  // setup
+      custom::concurrent_list<int> l;
+      // exercise
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      // verify
+      //    dummy    pHead             pTail
+      //    +----+   +----+   +----+   +----+
+      //    |    | - | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+   +----+
+      assertStandardFixture(l);
+   }  // teardown
+
+   // push_front on an empty list also moves the tail
+   void test_pushfront_empty()
+   {  // setup
+      custom::concurrent_list<int> l;
+      // exercise
+      l.push_front(99);
+      // verify
+      assertUnit(l.size() == 1);
+      assertUnit(l.pHead->pNext == l.pTail);
+      assertUnit(l.pTail->data() == 99);
+      assertUnit(l.pTail->pNext == nullptr);
+   }  // teardown
+
+   // push_front links right after the dummy
+   void test_pushfront_standard()
+   {  // setup
+      custom::concurrent_list<int> l;
+      l.push_back(26);
+      l.push_back(31);
+      // exercise
+      l.push_front(11);
+      // verify
+      assertStandardFixture(l);
+   }  // teardown
+
+   // the range is linked on after the tail
+   void test_pushbackBulk_standard()
+   {  // setup
+      custom::concurrent_list<int> l;
+      l.push_back(11);
+      std::vector<int> v { 26, 31 };
+      // exercise
+      l.push_back_bulk(v.begin(), v.end());
+      // verify
+      //    +----+   +----+   +----+   +----+
+      //    |    | - | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+   +----+
+      assertStandardFixture(l);
+   }  // teardown
+
+   /***************************************
+    * POP FRONT
+    ***************************************/
+
+   // nothing to pop
+   void test_popfront_empty()
+   {  // setup
+      custom::concurrent_list<int> l;
+      int data = 99;
+      // exercise
+      bool popped = l.pop_front(data);
+      // verify
+      assertUnit(popped == false);
+      assertUnit(data == 99);
+      assertUnit(l.pTail == l.pHead);
+   }  // teardown
+
+   // the first node becomes the dummy
+   void test_popfront_standard()
+   {  // setup
+      custom::concurrent_list<int> l;
+      l.push_back(99);
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      auto pFirst = l.pHead->pNext;
+      int data = 0;
+      // exercise
+      bool popped = l.pop_front(data);
+      // verify
+      assertUnit(popped);
+      assertUnit(data == 99);
+      assertUnit(l.pHead == pFirst);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // popping the last item leaves the tail on the new dummy
+   void test_popfront_last()
+   {  // setup
+      custom::concurrent_list<int> l;
+      l.push_back(99);
+      int data = 0;
+      // exercise
+      bool popped = l.pop_front(data);
+      // verify
+      assertUnit(popped);
+      assertUnit(data == 99);
+      assertUnit(l.pTail == l.pHead);
+      assertUnit(l.pHead->hasData == false);
+      assertUnit(l.empty());
+      // the list still works
+      l.push_back(11);
+      assertUnit(l.pHead->pNext == l.pTail);
+   }  // teardown
+
+   // popping what was pushed at the back takes the head count below zero
+   void test_popfront_count()
+   {  // setup
+      custom::concurrent_list<int> l;
+      l.push_back(11);
+      l.push_back(26);
+      l.push_front(99);
+      int data = 0;
+      // exercise
+      l.pop_front(data);
+      l.pop_front(data);
+      // verify
+      assertUnit(data == 11);
+      assertUnit(l.numHead == -1);
+      assertUnit(l.numTail == 2);
+      assertUnit(l.size() == 1);
+   }  // teardown
+
+   // an item whose move assignment throws when it holds 42
+   struct Fragile
+   {
+      Fragile(int value = 0) : value(value) { }
+      Fragile(Fragile && rhs) : value(rhs.value) { }
+      Fragile & operator = (Fragile && rhs)
+      {
+         if (rhs.value == 42)
+            throw std::string("42");
+         value = rhs.value;
+         return *this;
+      }
+      std::string padding = std::string(100, 'x');   // so a leak is a real allocation
+      int value;
+   };
+
+   // an assignment which throws still takes the item out of the list
+   void test_popfront_throws()
+   {  // setup
+      custom::concurrent_list<Fragile> l;
+      l.push_back(Fragile(42));
+      l.push_back(Fragile(26));
+      Fragile data;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.pop_front(data);
+      }
+      catch (const std::string & what)
+      {
+         thrown = (what == "42");
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(l.size() == 1);
+      assertUnit(l.pHead->hasData == false);
+      bool popped = l.pop_front(data);
+      assertUnit(popped);
+      assertUnit(data.value == 26);
+      assertUnit(l.empty());
+   }  // teardown
+
+   /***************************************
+    * TRAVERSE
+    ***************************************/
+
+   // for_each sees every item in order and may change them
+   void test_forEach_standard()
+   {  // setup
+      custom::concurrent_list<int> l;
+      l.push_back(10);
+      l.push_back(25);
+      l.push_back(30);
+      std::vector<int> visited;
+      // exercise
+      l.for_each([&visited](int & value) { visited.push_back(value); value += 1; });
+      // verify
+      assertUnit(visited.size() == 3);
+      if (visited.size() == 3)
+      {
+         assertUnit(visited[0] == 10);
+         assertUnit(visited[1] == 25);
+         assertUnit(visited[2] == 30);
+      }
+      assertStandardFixture(l);
+   }  // teardown
+
+   // contains walks hand-over-hand
+   void test_contains_standard()
+   {  // setup
+      custom::concurrent_list<int> l;
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      // exercise
+      bool found26 = l.contains(26);
+      bool found99 = l.contains(99);
+      // verify
+      assertUnit(found26);
+      assertUnit(!found99);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // the last node taken becomes the dummy
+   void test_popfrontBulk_some()
+   {  // setup
+      custom::concurrent_list<int> l;
+      l.push_back(97);
+      l.push_back(98);
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      auto p98 = l.pHead->pNext->pNext;
+      std::vector<int> v;
+      // exercise
+      size_t num = l.pop_front_bulk(std::back_inserter(v), 2);
+      // verify
+      assertUnit(num == 2);
+      assertUnit(v.size() == 2);
+      if (v.size() == 2)
+      {
+         assertUnit(v[0] == 97);
+         assertUnit(v[1] == 98);
+      }
+      assertUnit(l.pHead == p98);
+      assertUnit(l.pHead->hasData == false);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // taking everything leaves the tail on the new dummy
+   void test_popfrontBulk_all()
+   {  // setup
+      custom::concurrent_list<int> l;
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      std::vector<int> v;
+      // exercise
+      size_t num = l.pop_front_bulk(std::back_inserter(v), 99);
+      // verify
+      assertUnit(num == 3);
+      assertUnit(v.size() == 3);
+      assertUnit(l.pTail == l.pHead);
+      assertUnit(l.empty());
+      // the list still works
+      l.push_back(11);
+      assertUnit(l.pHead->pNext == l.pTail);
+      assertUnit(l.size() == 1);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // producers and consumers at the same time lose nothing
+   void test_threads_pushPop()
+   {  // setup
+      custom::concurrent_list<int> l;
+      const int numThreads = 4;
+      const int numItems = 10000;
+      std::vector<std::thread> threads;
+      std::vector<long long> sums(numThreads, 0);
+      // exercise
+      for (int t = 0; t < numThreads; t++)
+         threads.emplace_back([&l, &sums, t, numItems]()
+         {
+            for (int i = 1; i <= numItems; i++)
+            {
+               if (i % 2)
+                  l.push_back(i);
+               else
+                  l.push_front(i);
+               int data;
+               if (l.pop_front(data))
+                  sums[t] += data;
+            }
+         });
+      for (auto & thread : threads)
+         thread.join();
+      long long total = 0;
+      for (auto sum : sums)
+         total += sum;
+      int data;
+      while (l.pop_front(data))
+         total += data;
+      // verify
+      assertUnit(total == (long long)numThreads * numItems * (numItems + 1) / 2);
+      assertUnit(l.empty());
+      assertUnit(l.pTail == l.pHead);
+   }  // teardown
+
+   // batches in and batches out lose nothing
+   void test_threads_bulk()
+   {  // setup
+      custom::concurrent_list<int> l;
+      const int numThreads = 4;
+      const int numBatches = 500;
+      const int batchSize = 20;
+      std::vector<std::thread> threads;
+      std::vector<long long> sums(numThreads, 0);
+      // exercise
+      for (int t = 0; t < numThreads; t++)
+         threads.emplace_back([&l, &sums, t, numBatches, batchSize]()
+         {
+            std::vector<int> batch(batchSize);
+            for (int b = 0; b < numBatches; b++)
+            {
+               for (int i = 0; i < batchSize; i++)
+                  batch[i] = b * batchSize + i + 1;
+               l.push_back_bulk(batch.begin(), batch.end());
+               std::vector<int> out;
+               l.pop_front_bulk(std::back_inserter(out), batchSize / 2);
+               for (int data : out)
+                  sums[t] += data;
+            }
+         });
+      for (auto & thread : threads)
+         thread.join();
+      long long total = 0;
+      for (auto sum : sums)
+         total += sum;
+      int data;
+      while (l.pop_front(data))
+         total += data;
+      // verify
+      long long numItems = numBatches * batchSize;
+      assertUnit(total == numThreads * numItems * (numItems + 1) / 2);
+      assertUnit(l.empty());
+      assertUnit(l.pTail == l.pHead);
+   }  // teardown
+
+#ifdef LIST_CACHE_ALIGNED
+   /***************************************
+    * LAYOUT
+    ***************************************/
+
+   // the head side and the tail side are at least a cache line apart
+   void test_layout_cacheAligned()
+   {  // setup
+      custom::concurrent_list<int> l;
+      // exercise
+      const char * pHeadSide = reinterpret_cast<const char *>(&l.numHead);
+      const char * pTailSide = reinterpret_cast<const char *>(&l.tailLock);
+      // verify
+      assertUnit(pTailSide - pHeadSide >= 64);
+      assertUnit(reinterpret_cast<const char *>(&l.headLock) -
+                 reinterpret_cast<const char *>(&l) >= 64);
+   }  // teardown
+#endif // LIST_CACHE_ALIGNED
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *        dummy   pHead             pTail
+    *       +----+   +----+   +----+   +----+
+    *       |    | - | 11 | - | 26 | - | 31 |
+    *       +----+   +----+   +----+   +----+
+    ****************************************************************/
+   void assertStandardFixtureParameters(const custom::concurrent_list<int>& l, int line, const char* function)
+   {
+      // verify the member variables
+      assertIndirect(l.size() == 3);
+      assertIndirect(l.pHead != nullptr);
+      assertIndirect(l.pTail != nullptr);
+
+      // verify the linked list
+      if (l.pHead)
+      {
+         auto p = l.pHead;
+         assertIndirect(p->hasData == false);
+         int expected[] = { 11, 26, 31 };
+         for (int i = 0; i < 3; i++)
+         {
+            p = p->pNext;
+            assertIndirect(p != nullptr);
+            if (p == nullptr)
+               return;
+            assertIndirect(p->hasData);
+            assertIndirect(p->data() == expected[i]);
+         }
+         assertIndirect(p == l.pTail);
+         assertIndirect(p->pNext == nullptr);
+      }
+   }
+};
+
+#endif // DEBUG
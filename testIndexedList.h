@@ -0,0 +1,360 @@
+/***********************************************************************
+ * Header:
+ *    TEST INDEXED LIST
+ * Summary:
+ *    Unit tests for indexed_list
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "indexedList.h"
+#include "unitTest.h"
+
+#include <string>
+#include <vector>
+
+class TestIndexedList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_copy();
+
+      // Insert
+      test_pushback_standard();
+      test_pushfront_standard();
+      test_insert_middle();
+      test_insert_string();
+
+      // Access
+      test_at_standard();
+      test_at_outOfRange();
+      test_iteratorAt_standard();
+      test_indexOf_standard();
+
+      // Remove
+      test_erase_middle();
+      test_erase_all();
+
+      // Against std::vector
+      test_random_model();
+
+      report("IndexedList");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // nothing in the list or the tree
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::indexed_list<int> l;
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.size() == 0);
+      assertUnit(l.pHead == nullptr);
+      assertUnit(l.pTail == nullptr);
+      assertUnit(l.pRoot == nullptr);
+      assertUnit(l.begin() == l.end());
+   }  // teardown
+
+   // the copy has its own nodes, in the same order
+   void test_construct_copy()
+   {  // setup
+      custom::indexed_list<int> lSrc;
+      lSrc.push_back(11);
+      lSrc.push_back(26);
+      lSrc.push_back(31);
+      // exercise
+      custom::indexed_list<int> lDes(lSrc);
+      // verify
+      assertStandardFixture(lDes);
+      assertStandardFixture(lSrc);
+      assertUnit(lDes.pHead != lSrc.pHead);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // push_back adds after the tail
+   void test_pushback_standard()
+   {  // setup
+      custom::indexed_list<int> l;
+      // exercise
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      // verify
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      assertStandardFixture(l);
+   }  // teardown
+
+   // push_front adds before the head
+   void test_pushfront_standard()
+   {  // setup
+      custom::indexed_list<int> l;
+      // exercise
+      l.push_front(31);
+      l.push_front(26);
+      l.push_front(11);
+      // verify
+      assertStandardFixture(l);
+   }  // teardown
+
+   // insert goes before the iterator
+   void test_insert_middle()
+   {  // setup
+      custom::indexed_list<int> l;
+      l.push_back(11);
+      l.push_back(31);
+      // exercise
+      auto it = l.insert(l.rbegin(), 26);
+      // verify
+      assertUnit(*it == 26);
+      assertUnit(l.index_of(it) == 1);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // the item is moved in
+   void test_insert_string()
+   {  // setup
+      custom::indexed_list<std::string> l;
+      std::string s(100, 'x');
+      // exercise
+      l.insert(l.end(), std::move(s));
+      l.insert(l.begin(), std::string(100, 'y'));
+      // verify
+      assertUnit(l.size() == 2);
+      assertUnit(l.at(0) == std::string(100, 'y'));
+      assertUnit(l.at(1) == std::string(100, 'x'));
+      assertTreeParameters(l, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   /***************************************
+    * AT, ITERATOR AT and INDEX OF
+    ***************************************/
+
+   // every position finds its item
+   void test_at_standard()
+   {  // setup
+      custom::indexed_list<int> l;
+      for (int i = 0; i < 1000; i++)
+         l.push_back(i * 2);
+      // exercise
+      bool allFound = true;
+      for (size_t i = 0; i < 1000; i++)
+         allFound = allFound && l.at(i) == (int)i * 2;
+      // verify
+      assertUnit(allFound);
+      assertUnit(depth(l.pRoot) < 60);
+   }  // teardown
+
+   // past the end throws
+   void test_at_outOfRange()
+   {  // setup
+      custom::indexed_list<int> l;
+      l.push_back(11);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.at(1);
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // the iterator walks on from where it was found
+   void test_iteratorAt_standard()
+   {  // setup
+      custom::indexed_list<int> l;
+      for (int i = 0; i < 100; i++)
+         l.push_back(i);
+      // exercise
+      auto it = l.iterator_at(50);
+      // verify
+      bool inOrder = true;
+      for (int expected = 50; expected < 60; expected++, ++it)
+         inOrder = inOrder && *it == expected;
+      assertUnit(inOrder);
+      assertUnit(l.iterator_at(100) == l.end());
+   }  // teardown
+
+   // index_of undoes iterator_at
+   void test_indexOf_standard()
+   {  // setup
+      custom::indexed_list<int> l;
+      for (int i = 0; i < 500; i++)
+         l.push_front(i);
+      // exercise
+      bool allFound = true;
+      size_t index = 0;
+      for (auto it = l.begin(); it != l.end(); ++it, index++)
+         allFound = allFound && l.index_of(it) == index;
+      // verify
+      assertUnit(allFound);
+      assertUnit(l.index_of(l.end()) == 500);
+   }  // teardown
+
+   /***************************************
+    * ERASE
+    ***************************************/
+
+   // the neighbors are linked to each other and the counts drop
+   void test_erase_middle()
+   {  // setup
+      custom::indexed_list<int> l;
+      l.push_back(11);
+      l.push_back(99);
+      l.push_back(26);
+      l.push_back(31);
+      // exercise
+      auto it = l.erase(l.iterator_at(1));
+      // verify
+      assertUnit(*it == 26);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // erasing everything leaves an empty tree
+   void test_erase_all()
+   {  // setup
+      custom::indexed_list<int> l;
+      for (int i = 0; i < 100; i++)
+         l.push_back(i);
+      // exercise
+      while (!l.empty())
+         l.pop_back();
+      // verify
+      assertUnit(l.size() == 0);
+      assertUnit(l.pHead == nullptr);
+      assertUnit(l.pTail == nullptr);
+      assertUnit(l.pRoot == nullptr);
+   }  // teardown
+
+   /***************************************
+    * RANDOM
+    ***************************************/
+
+   // a long run of inserts and erases matches a vector doing the same
+   void test_random_model()
+   {  // setup
+      custom::indexed_list<int> l;
+      std::vector<int> model;
+      unsigned int seed = 12345;
+      // exercise
+      for (int i = 0; i < 5000; i++)
+      {
+         seed = seed * 1103515245 + 12345;
+         size_t index = model.empty() ? 0 : (seed >> 8) % (model.size() + 1);
+         if (model.empty() || (seed >> 4) % 3 != 0)
+         {
+            l.insert(l.iterator_at(index), i);
+            model.insert(model.begin() + index, i);
+         }
+         else
+         {
+            index %= model.size();
+            l.erase(l.iterator_at(index));
+            model.erase(model.begin() + index);
+         }
+      }
+      // verify
+      assertUnit(l.size() == model.size());
+      bool same = true;
+      for (size_t i = 0; i < model.size(); i++)
+         same = same && l.at(i) == model[i];
+      assertUnit(same);
+      assertTreeParameters(l, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   /****************************************************************
+    * Verify the tree
+    * Every node's parent points back at it, the counts add up, no
+    * child outranks its parent, and the tree visits the nodes in
+    * list order
+    ****************************************************************/
+   template <typename T>
+   void assertTreeParameters(custom::indexed_list<T>& l, int line, const char* function)
+   {
+      typename custom::indexed_list<T>::Node * pList = l.pHead;
+      bool valid = true;
+      size_t num = walk(l.pRoot, pList, valid);
+      assertIndirect(valid);
+      assertIndirect(pList == nullptr);
+      assertIndirect(num == l.size());
+      if (l.pRoot)
+         assertIndirect(l.pRoot->pParent == nullptr);
+   }
+
+   template <typename Node>
+   size_t walk(Node * p, Node * & pList, bool & valid)
+   {
+      if (p == nullptr)
+         return 0;
+      size_t num = walk(p->pLeft, pList, valid);
+      valid = valid && p == pList;
+      if (pList)
+         pList = pList->pNext;
+      num += 1 + walk(p->pRight, pList, valid);
+      valid = valid && p->count == num;
+      if (p->pLeft)
+         valid = valid && p->pLeft->pParent == p && p->pLeft->priority <= p->priority;
+      if (p->pRight)
+         valid = valid && p->pRight->pParent == p && p->pRight->priority <= p->priority;
+      return num;
+   }
+
+   template <typename Node>
+   size_t depth(Node * p)
+   {
+      if (p == nullptr)
+         return 0;
+      size_t left = depth(p->pLeft);
+      size_t right = depth(p->pRight);
+      return 1 + (left > right ? left : right);
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *       +----+   +----+   +----+
+    *       | 11 | - | 26 | - | 31 |
+    *       +----+   +----+   +----+
+    ****************************************************************/
+   void assertStandardFixtureParameters(custom::indexed_list<int>& l, int line, const char* function)
+   {
+      assertIndirect(l.size() == 3);
+      assertIndirect(l.pHead != nullptr);
+      assertIndirect(l.pTail != nullptr);
+      if (l.pHead == nullptr || l.pTail == nullptr)
+         return;
+      assertIndirect(l.pHead->pPrev == nullptr);
+      assertIndirect(l.pTail->pNext == nullptr);
+      assertIndirect(l.at(0) == 11);
+      assertIndirect(l.at(1) == 26);
+      assertIndirect(l.at(2) == 31);
+      assertIndirect(l.front() == 11);
+      assertIndirect(l.back() == 31);
+      assertIndirect(l.pHead->pNext->pNext == l.pTail);
+      assertIndirect(l.pTail->pPrev->pPrev == l.pHead);
+      assertTreeParameters(l, line, function);
+   }
+};
+
+#endif // DEBUG
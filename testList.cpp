@@ -11,8 +11,20 @@
 #define DEBUG   
 #endif
  //#undef DEBUG  // Remove this comment to disable unit tests
+ //#define BENCHMARK  // Remove this comment to run the benchmarks; define it for benchAlloc.cpp too
 
+#include "benchList.h"      // for the benchmarks; first, so it can hook the node pool
 #include "testList.h"       // for the spy unit tests
+#include "testConcurrentList.h" // for the concurrent list unit tests
+#include "testLockFreeQueue.h"  // for the lock-free queue unit tests
+#include "testRcuList.h"        // for the RCU list unit tests
+#include "testParallelList.h"   // for the parallel algorithm unit tests
+#include "testShardedList.h"    // for the sharded list unit tests
+#include "testMappedList.h"     // for the mapped list unit tests
+#include "testIndexedList.h"    // for the indexed list unit tests
+#include "testSortedList.h"     // for the sorted list unit tests
+#include "testListSimd.h"       // for the simd scan unit tests
+#include "testSplitList.h"      // for the split list unit tests
 
 
 /**********************************************************************
@@ -24,7 +36,22 @@ int main()
 #ifdef DEBUG
    // unit tests
    TestList().run();
+   TestConcurrentList().run();
+   TestLockFreeQueue().run();
+   TestRcuList().run();
+   TestParallelList().run();
+   TestShardedList().run();
+   TestMappedList().run();
+   TestIndexedList().run();
+   TestSortedList().run();
+   TestListSimd().run();
+   TestSplitList().run();
 #endif // DEBUG
+
+#ifdef BENCHMARK
+   // benchmarks
+   BenchList().run();
+#endif // BENCHMARK
    
    return 0;
 }
@@ -16,9 +16,15 @@
 #include "unitTest.h"
 
 #include <vector>
+#include <string>
+#include <iterator>
+#include <sstream>
+#include <cstring>
+#include <cstdint>
 #include <cassert>
 #include <memory>
 #include <iostream>
+#include <thread>
 
 class TestList : public UnitTest
 {
@@ -61,6 +67,9 @@ public:
       test_iterator_increment_standardMiddle();
       test_iterator_dereference_read();
       test_iterator_dereference_update();
+      test_forEachPrefetch_empty();
+      test_forEachPrefetch_standard();
+      test_forEachPrefetch_noDistance();
          // There should be a case to catch it++ going to nullptr (it should be able to do that)
 
       // Access
@@ -70,12 +79,19 @@ public:
       test_back_empty();
       test_back_standardRead();
       test_back_standardWrite();
+      test_at_standard();
+      test_at_outOfRange();
+      test_iteratorAt_nearFinger();
+      test_finger_insertErase();
+      test_finger_moveSwap();
+      test_finger_random();
 
 //      // Insert
       test_pushback_empty();
       test_pushback_standard();
       test_pushback_moveEmpty();
       test_pushback_moveStandard();
+      test_pushback_overAligned();
       test_pushfront_empty();
       test_pushfront_standard();
       test_pushfront_moveEmpty();
@@ -102,12 +118,90 @@ public:
       test_erase_standardMiddle();
       test_erase_standardEnd();
 
+      // Bulk
+      test_pushbackBulk_empty();
+      test_pushbackBulk_standard();
+      test_pushbackBulk_throws();
+      test_popfrontBulk_empty();
+      test_popfrontBulk_some();
+      test_popfrontBulk_all();
+      test_drainInto_standard();
+
+      // Export
+      test_copyTo_empty();
+      test_copyTo_standard();
+      test_toVector_standard();
+      test_drainTo_standard();
+      test_drainTo_string();
+
+      // Serialize
+      test_write_empty();
+      test_write_standard();
+      test_read_standard();
+      test_read_string();
+      test_read_twoInOneBuffer();
+      test_read_bigBlocks();
+      test_read_short();
+      test_read_hugeLength();
+      test_read_wrongType();
+
+      // Layout
+      test_compact_empty();
+      test_compact_items();
+
+      // Splice
+      test_splice_emptyRhs();
+      test_splice_intoEmpty();
+      test_splice_end();
+      test_splice_front();
+
+      // Order
+      test_sort_empty();
+      test_sort_standard();
+      test_sort_compare();
+      test_sort_stable();
+      test_sort_throws();
+
       // Status
       test_size_empty();
       test_size_three();
       test_empty_empty();
       test_empty_three();
 
+#ifdef LIST_POOL
+      // Pool
+      test_assign_trivialRun();
+      test_read_reusesSlabs();
+      test_compact_standard();
+      test_compact_alreadyCompact();
+      test_compact_reusesRuns();
+      test_free_threadExit();
+#endif // LIST_POOL
+
+#ifdef LIST_STATS
+      // Stats
+      test_stats_constructMove();
+      test_stats_constructCopy();
+      test_stats_constructFill();
+      test_stats_pushback();
+      test_stats_clear();
+#endif // LIST_STATS
+
+#ifdef LIST_CACHE_ALIGNED
+      // Layout
+      test_layout_cacheAligned();
+      test_layout_countHalves();
+#endif // LIST_CACHE_ALIGNED
+
+#ifdef LIST_TRACE
+      // Trace
+      test_trace_pushback();
+      test_trace_popback();
+      test_trace_drainTo();
+      test_trace_buckets();
+      test_trace_threadExit();
+#endif // LIST_TRACE
+
       report("List");
    }
 
@@ -122,7 +216,7 @@ public:
       custom::list<int> l;
       l.pHead = (custom::list<int>::Node*)0xBADF00D1;
       l.pTail = (custom::list<int>::Node*)0xBADF00D2;
-      l.numElements = 99;
+      l.setCount(99);
       // exercise
       alloc.construct(&l); // the constructor is called explicitly
       // verify
@@ -136,7 +230,7 @@ public:
       custom::list<int> l;
       l.pHead = (custom::list<int>::Node*)0xBADF00D1;
       l.pTail = (custom::list<int>::Node*)0xBADF00D2;
-      l.numElements = 99;
+      l.setCount(99);
       // exercise
       alloc.construct(&l,0); // the constructor is called explicitly
       // verify
@@ -150,14 +244,14 @@ public:
       custom::list<int> l;
       l.pHead = (custom::list<int>::Node*)0xBADF00D1;
       l.pTail = (custom::list<int>::Node*)0xBADF00D2;
-      l.numElements = 99;
+      l.setCount(99);
       // exercise
       alloc.construct(&l, 3); // the constructor is called explicitly
       // verify
       //    +----+   +----+   +----+
       //    | 00 | - | 00 | - | 00 |
       //    +----+   +----+   +----+      
-      assertUnit(l.numElements == 3);
+      assertUnit(l.size() == 3);
       assertUnit(l.pHead != nullptr);
       if (l.pHead)
       {
@@ -189,14 +283,14 @@ public:
       custom::list<int> l;
       l.pHead = (custom::list<int>::Node*)0xBADF00D1;
       l.pTail = (custom::list<int>::Node*)0xBADF00D2;
-      l.numElements = 99;
+      l.setCount(99);
       // exercise
       alloc.construct(&l, size_t(3), s); // the constructor is called explicitly
       // verify
       //    +----+   +----+   +----+
       //    | 99 | - | 99 | - | 99 |
       //    +----+   +----+   +----+      
-      assertUnit(l.numElements == 3);
+      assertUnit(l.size() == 3);
       assertUnit(l.pHead != nullptr);
       if (l.pHead)
       {
@@ -228,7 +322,7 @@ public:
 //      custom::list<int> l;
 //      l.pHead = (custom::list<int>::Node*)0xBADF00D1;
 //      l.pTail = (custom::list<int>::Node*)0xBADF00D2;
-//      l.numElements = 99;
+//      l.setCount(99);
       // exercise
 //      alloc.construct(&l, size_t(3), s); // the constructor is called explicitly
       auto l = custom::list<int>(size_t(3), s);
@@ -236,7 +330,7 @@ public:
       //    +----+   +----+   +----+
       //    | 99 | - | 99 | - | 99 |
       //    +----+   +----+   +----+
-      assertUnit(l.numElements == 3);
+      assertUnit(l.size() == 3);
       assertUnit(l.pHead != nullptr);
       if (l.pHead)
       {
@@ -541,6 +635,33 @@ public:
       teardownStandardFixture(lDes);
    } 
 
+   // items which are only bytes are copied into one run of adjacent nodes
+   void test_assign_trivialRun()
+   {  // setup
+      custom::list<int> lSrc;
+      for (int i = 0; i < 1000; i++)
+         lSrc.push_back(i * 3);
+      custom::list<int> lDes;
+      // exercise
+      lDes = lSrc;
+      // verify
+      bool adjacent = true;
+      bool same = true;
+      int i = 0;
+      for (auto p = lDes.pHead; p; p = p->pNext, i++)
+      {
+         adjacent = adjacent && (p->pNext == nullptr || p->pNext == p + 1);
+         same = same && p->data == i * 3;
+      }
+      assertUnit(adjacent);
+      assertUnit(same);
+      assertUnit(i == 1000);
+      assertUnit(lDes.size() == 1000);
+      assertUnit(lDes.pHead->pPrev == nullptr);
+      assertUnit(lDes.pTail == lDes.pHead + 999);
+      assertUnit(lDes.pTail->pPrev == lDes.pHead + 998);
+   }  // teardown
+
    // From the empty list to the standard to fixture
    void test_assign_emptyToStandard()
    {  // setup
@@ -577,7 +698,7 @@ public:
       pDes2->pPrev = pDes1;
       lDes.pHead = pDes1;
       lDes.pTail = pDes2;
-      lDes.numElements = 2;
+      lDes.setCount(2);
       // exercise
       lDes = lSrc;
       // verify
@@ -629,7 +750,7 @@ public:
       lDes2->pPrev = lDes1;
       lDes.pHead = lDes1;
       lDes.pTail = lDes4;
-      lDes.numElements = 4;
+      lDes.setCount(4);
       // exercise
       lDes = lSrc;
       // verify
@@ -703,7 +824,7 @@ public:
       //       +----+
       custom::list<int> l;
       l.pHead = l.pTail = new custom::list<int>::Node(int(99));
-      l.numElements = 1;
+      l.setCount(1);
       std::initializer_list<int> il{ int(11),int(26),int(31) };
       // exercise
       l = il;   // l = {int(11), int(26), int(31) }
@@ -737,7 +858,7 @@ public:
       p2->pPrev = p1;
       l.pHead = p1;
       l.pTail = p4;
-      l.numElements = 4;
+      l.setCount(4);
       std::initializer_list<int> il{ int(11),int(26),int(31) };
       // exercise
       l = il;   // l = {int(11), int(26), int(31) }
@@ -799,7 +920,7 @@ public:
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
       assertUnit(l.pTail == l.pHead);
-      assertUnit(l.numElements == 1);
+      assertUnit(l.size() == 1);
       if (l.pHead)
       { 
          assertUnit(l.pHead->data == int(99));
@@ -830,7 +951,7 @@ public:
       //       +----+   +----+   +----+   +----+
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
-      assertUnit(l.numElements == 4);
+      assertUnit(l.size() == 4);
       if (l.pTail)
       {
          assertUnit(l.pTail->data == int(99));
@@ -841,7 +962,7 @@ public:
             assertUnit(l.pTail->pPrev->pNext == l.pTail);
             l.pTail = l.pTail->pPrev;
             delete l.pTail->pNext;
-            l.numElements--;
+            l.countBack(-1);
             l.pTail->pNext = nullptr;
          }
       }
@@ -865,7 +986,7 @@ public:
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
       assertUnit(l.pTail == l.pHead);
-      assertUnit(l.numElements == 1);
+      assertUnit(l.size() == 1);
       if (l.pHead)
       {
          assertUnit(l.pHead->data == int(99));
@@ -896,7 +1017,7 @@ public:
       //       +----+   +----+   +----+   +----+
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
-      assertUnit(l.numElements == 4);
+      assertUnit(l.size() == 4);
       if (l.pTail)
       {
          assertUnit(l.pTail->data == int(99));
@@ -907,7 +1028,7 @@ public:
             assertUnit(l.pTail->pPrev->pNext == l.pTail);
             l.pTail = l.pTail->pPrev;
             delete l.pTail->pNext;
-            l.numElements--;
+            l.countBack(-1);
             l.pTail->pNext = nullptr;
          }
       }
@@ -917,6 +1038,34 @@ public:
       teardownStandardFixture(l);
    }
 
+   // over-aligned items land on their boundary, even when there are
+   // enough of them to need several of the pool's slabs
+   void test_pushback_overAligned()
+   {  // setup
+      struct alignas(64) Wide
+      {
+         int x;
+      };
+      custom::list<Wide> l;
+      // exercise
+      for (int i = 0; i < 5000; i++)
+         l.push_back(Wide{ i });
+      // verify
+      int i = 0;
+      bool aligned = true;
+      bool inOrder = true;
+      for (auto it = l.begin(); it != l.end(); ++it, i++)
+      {
+         if (reinterpret_cast<std::uintptr_t>(&*it) % 64 != 0)
+            aligned = false;
+         if ((*it).x != i)
+            inOrder = false;
+      }
+      assertUnit(aligned);
+      assertUnit(inOrder);
+      assertUnit(l.size() == 5000);
+   }  // teardown
+
    /***************************************
     * PUSH FRONT
     ***************************************/
@@ -935,7 +1084,7 @@ public:
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
       assertUnit(l.pTail == l.pHead);
-      assertUnit(l.numElements == 1);
+      assertUnit(l.size() == 1);
       if (l.pTail)
       {
          assertUnit(l.pTail->data == int(99));
@@ -966,7 +1115,7 @@ public:
       //       +----+   +----+   +----+   +----+
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
-      assertUnit(l.numElements == 4);
+      assertUnit(l.size() == 4);
       if (l.pHead)
       {
          assertUnit(l.pHead->data == int(99));
@@ -977,7 +1126,7 @@ public:
             assertUnit(l.pHead->pNext->pPrev == l.pHead);
             l.pHead = l.pHead->pNext;
             delete l.pHead->pPrev;
-            l.numElements--;
+            l.countFront(-1);
             l.pHead->pPrev = nullptr;
          }
       }
@@ -1001,7 +1150,7 @@ public:
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
       assertUnit(l.pTail == l.pHead);
-      assertUnit(l.numElements == 1);
+      assertUnit(l.size() == 1);
       if (l.pTail)
       {
          assertUnit(l.pTail->data == int(99));
@@ -1032,7 +1181,7 @@ public:
       //       +----+   +----+   +----+   +----+
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
-      assertUnit(l.numElements == 4);
+      assertUnit(l.size() == 4);
       if (l.pHead)
       {
          assertUnit(l.pHead->data == int(99));
@@ -1043,7 +1192,7 @@ public:
             assertUnit(l.pHead->pNext->pPrev == l.pHead);
             l.pHead = l.pHead->pNext;
             delete l.pHead->pPrev;
-            l.numElements--;
+            l.countFront(-1);
             l.pHead->pPrev = nullptr;
          }
       }
@@ -1081,7 +1230,7 @@ public:
       l.pTail->pNext = p;
       p->pPrev = l.pTail;
       l.pTail = p;
-      l.numElements++;
+      l.countBack(1);
       // exercise
       l.pop_back();
       // verify
@@ -1104,7 +1253,7 @@ public:
       //       +----+
       custom::list<int> l;
       l.pHead = l.pTail = new custom::list<int>::Node(99);
-      l.numElements = 1;
+      l.setCount(1);
       // exercise
       l.pop_back();
       // verify
@@ -1125,7 +1274,7 @@ public:
       // verify
       assertUnit(l.pHead == NULL);
       assertUnit(l.pTail == NULL);
-      assertUnit(l.numElements == 0);
+      assertUnit(l.size() == 0);
       assertUnit(l.size() == 0);
       assertUnit(l.empty() == true);
    }  // teardown
@@ -1143,7 +1292,7 @@ public:
       l.pHead->pPrev = p;
       p->pNext = l.pHead;
       l.pHead = p;
-      l.numElements++;
+      l.countFront(1);
       // exercise
       l.pop_front();
       // verify
@@ -1166,7 +1315,7 @@ public:
       //       +----+
       custom::list<int> l;
       l.pHead = l.pTail = new custom::list<int>::Node(99);
-      l.numElements = 1;
+      l.setCount(1);
       // exercise
       l.pop_front();
       // verify
@@ -1310,6 +1459,178 @@ public:
       teardownStandardFixture(l);
    }
 
+   /***************************************
+    * AT and ITERATOR AT
+    ***************************************/
+
+   // every position of the standard list, and the finger left on the last
+   void test_at_standard()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      custom::list<int> l;
+      setupStandardFixture(l);
+      // exercise
+      int v0 = l.at(0);
+      int v2 = l.at(2);
+      int v1 = l.at(1);
+      // verify
+      assertUnit(v0 == 11);
+      assertUnit(v1 == 26);
+      assertUnit(v2 == 31);
+      assertUnit(l.pFinger == l.pHead->pNext);
+      assertUnit(l.fingerIndex == 1);
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // past the end throws, and iterator_at gives end()
+   void test_at_outOfRange()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.at(3);
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(l.iterator_at(3) == l.end());
+      assertUnit(l.pFinger == nullptr);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // a lookup near the last one walks from the finger
+   void test_iteratorAt_nearFinger()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 100; i++)
+         l.push_back(i);
+      auto it50 = l.iterator_at(50);
+      // exercise
+      auto it52 = l.iterator_at(52);
+      auto it49 = l.iterator_at(49);
+      // verify
+      assertUnit(*it50 == 50);
+      assertUnit(*it52 == 52);
+      assertUnit(*it49 == 49);
+      assertUnit(it49.p->pNext == it50.p);
+      assertUnit(l.pFinger == it49.p);
+      assertUnit(l.fingerIndex == 49);
+   }  // teardown
+
+   // inserts and erases next to the finger keep it; one far away drops it
+   void test_finger_insertErase()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 10; i++)
+         l.push_back(i);
+      auto it5 = l.iterator_at(5);
+      // exercise and verify
+      l.push_front(-1);
+      assertUnit(l.pFinger == it5.p && l.fingerIndex == 6);
+      l.insert(it5, 99);
+      assertUnit(l.pFinger == it5.p && l.fingerIndex == 7);
+      l.erase(it5);
+      assertUnit(l.pFinger != nullptr && l.fingerIndex == 7);
+      if (l.pFinger)
+         assertUnit(l.pFinger->data == 6);
+      l.pop_front();
+      assertUnit(l.fingerIndex == 6);
+      l.pop_back();
+      assertUnit(l.fingerIndex == 6);
+      l.erase(l.begin().p->pNext);
+      assertUnit(l.pFinger == nullptr);
+      assertUnit(l.at(5) == 6);
+      assertUnit(l.at(4) == 99);
+   }  // teardown
+
+   // the finger goes with the nodes when a list is moved or swapped
+   void test_finger_moveSwap()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int> lOther;
+      lOther.push_back(99);
+      l.at(1);
+      auto p26 = l.pFinger;
+      // exercise and verify
+      custom::list<int> lMoved(std::move(l));
+      assertUnit(lMoved.pFinger == p26 && lMoved.fingerIndex == 1);
+      assertUnit(l.pFinger == nullptr);
+      lMoved.swap(lOther);
+      assertUnit(lOther.pFinger == p26 && lOther.fingerIndex == 1);
+      assertUnit(lMoved.pFinger == nullptr);
+      assertUnit(lOther.at(2) == 31);
+      assertUnit(lMoved.at(0) == 99);
+      // teardown
+      teardownStandardFixture(lOther);
+   }
+
+   // a long run of changes and lookups matches a vector doing the same
+   void test_finger_random()
+   {  // setup
+      custom::list<int> l;
+      std::vector<int> model;
+      unsigned int seed = 12345;
+      bool same = true;
+      // exercise
+      for (int i = 0; i < 5000 && same; i++)
+      {
+         seed = seed * 1103515245 + 12345;
+         size_t index = model.empty() ? 0 : (seed >> 8) % model.size();
+         switch ((seed >> 4) % 6)
+         {
+            case 0:
+               l.insert(l.iterator_at(index), i);
+               model.insert(model.begin() + index, i);
+               break;
+            case 1:
+               if (!model.empty())
+               {
+                  l.erase(l.iterator_at(index));
+                  model.erase(model.begin() + index);
+               }
+               break;
+            case 2:
+               l.push_front(i);
+               model.insert(model.begin(), i);
+               break;
+            case 3:
+               if (!model.empty())
+               {
+                  l.pop_front();
+                  model.erase(model.begin());
+               }
+               break;
+            default:
+               if (!model.empty())
+                  same = l.at(index) == model[index];
+         }
+         if (l.pFinger)
+         {
+            auto it = l.begin();
+            for (size_t j = 0; j < l.fingerIndex; j++)
+               ++it;
+            same = same && it.p == l.pFinger;
+         }
+      }
+      // verify
+      assertUnit(same);
+      assertUnit(l.size() == model.size());
+   }  // teardown
+
+
 
     /***************************************
     * INSERT - Copy
@@ -1338,7 +1659,7 @@ public:
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
       assertUnit(l.pTail == l.pHead);
-      assertUnit(l.numElements == 1);
+      assertUnit(l.size() == 1);
       if (l.pHead)
       {
          assertUnit(l.pHead->data == int(99));
@@ -1375,7 +1696,7 @@ public:
       assertUnit(itReturn.p != nullptr);
       if (itReturn.p)
          assertUnit(itReturn.p->data == int(99));
-      assertUnit(l.numElements == 4);
+      assertUnit(l.size() == 4);
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
       if (l.pHead)
@@ -1433,7 +1754,7 @@ public:
       assertUnit(itReturn.p != nullptr);
       if (itReturn.p)
          assertUnit(itReturn.p->data == int(99));
-      assertUnit(l.numElements == 4);
+      assertUnit(l.size() == 4);
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
       if (l.pHead)
@@ -1488,7 +1809,7 @@ public:
       assertUnit(itReturn.p != nullptr);
       if (itReturn.p)
          assertUnit(itReturn.p->data == int(99));
-      assertUnit(l.numElements == 4);
+      assertUnit(l.size() == 4);
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
       if (l.pHead)
@@ -1547,7 +1868,7 @@ public:
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
       assertUnit(l.pTail == l.pHead);
-      assertUnit(l.numElements == 1);
+      assertUnit(l.size() == 1);
       if (l.pHead)
       {
          assertUnit(l.pHead->data == int(99));
@@ -1585,7 +1906,7 @@ public:
       assertUnit(itReturn.p != nullptr);
       if (itReturn.p)
          assertUnit(itReturn.p->data == int(99));
-      assertUnit(l.numElements == 4);
+      assertUnit(l.size() == 4);
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
       if (l.pHead)
@@ -1644,7 +1965,7 @@ public:
       assertUnit(itReturn.p != nullptr);
       if (itReturn.p)
          assertUnit(itReturn.p->data == int(99));
-      assertUnit(l.numElements == 4);
+      assertUnit(l.size() == 4);
       assertUnit(l.pHead != nullptr);
       assertUnit(l.pTail != nullptr);
       if (l.pHead)
@@ -1723,7 +2044,7 @@ public:
       //        itReturn
       assertUnit(l.pHead == p2);
       assertUnit(l.pTail == p3);
-      assertUnit(l.numElements == 2);
+      assertUnit(l.size() == 2);
       assertUnit(l.pHead != nullptr);
       if (l.pHead)
       {
@@ -1768,7 +2089,7 @@ public:
       //                  itReturn
       assertUnit(l.pHead == p1);
       assertUnit(l.pTail == p3);
-      assertUnit(l.numElements == 2);
+      assertUnit(l.size() == 2);
       assertUnit(l.pHead != nullptr);
       if (l.pHead)
       {
@@ -1814,7 +2135,7 @@ public:
       //                         itErase = NULL
       assertUnit(l.pHead == p1);
       assertUnit(l.pTail == p2);
-      assertUnit(l.numElements == 2);
+      assertUnit(l.size() == 2);
       assertUnit(l.pHead != nullptr);
       if (l.pHead)
       {
@@ -1986,6 +2307,1155 @@ public:
       teardownStandardFixture(l);
    }
 
+   /***************************************
+    * COMPACT
+    ***************************************/
+
+   // compacting an empty list does nothing
+   void test_compact_empty()
+   {  // setup
+      custom::list<int> l;
+      // exercise
+      l.compact();
+      // verify
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // the items keep their order and the links are rebuilt both ways
+   void test_compact_items()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 100; i++)
+         if (i % 2)
+            l.push_back(i);
+         else
+            l.push_front(i);
+      std::vector<int> before = l.to_vector();
+      // exercise
+      l.compact();
+      // verify
+      std::vector<int> after = l.to_vector();
+      assertUnit(before == after);
+      assertUnit(l.size() == 100);
+      bool linked = true;
+      for (custom::list<int>::Node * p = l.pHead; p; p = p->pNext)
+         linked = linked && (p->pNext ? p->pNext->pPrev == p : p == l.pTail);
+      assertUnit(linked);
+      assertUnit(l.pHead->pPrev == nullptr);
+   }  // teardown
+
+   // the nodes end up side-by-side in list order
+   void test_compact_standard()
+   {  // setup
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      custom::list<int> l;
+      setupStandardFixture(l);
+      // the pool may have handed out three adjacent slots, so move the
+      // middle node somewhere else to be sure there is work to do
+      custom::list<int>::Node * pSpacer = new custom::list<int>::Node(int(99));
+      custom::list<int>::Node * p26 = new custom::list<int>::Node(int(26));
+      delete pSpacer;
+      p26->pPrev = l.pHead;
+      p26->pNext = l.pTail;
+      delete l.pHead->pNext;
+      l.pHead->pNext = p26;
+      l.pTail->pPrev = p26;
+      custom::list<int>::Node * pOld = l.pHead;
+      // exercise
+      l.compact();
+      // verify
+      assertUnit(l.pHead != pOld);
+      if (l.pHead)
+      {
+         assertUnit(l.pHead->pNext == l.pHead + 1);
+         assertUnit(l.pTail == l.pHead + 2);
+      }
+      //    +----+----+----+
+      //    | 11 | 26 | 31 |
+      //    +----+----+----+
+      assertStandardFixture(l);
+      // teardown
+      l.clear();
+   }
+
+   // a list already in order keeps its nodes
+   void test_compact_alreadyCompact()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      l.compact();
+      custom::list<int>::Node * pHead = l.pHead;
+      // exercise
+      l.compact();
+      // verify
+      assertUnit(l.pHead == pHead);
+      assertStandardFixture(l);
+      // teardown
+      l.clear();
+   }
+
+#ifdef LIST_POOL
+   // compacting over and over reuses the runs freed before, so the
+   // pool stops growing
+   void test_compact_reusesRuns()
+   {  // setup
+      typedef custom::list<int>::Node Node;
+      typedef custom::pool<sizeof(Node), alignof(Node)> Pool;
+      custom::list<int> l;
+      for (int i = 0; i < 20000; i++)
+         l.push_back((i * 7919) % 20000);
+      size_t slabs = 0;
+      bool allCompact = true;
+      // exercise
+      for (int round = 0; round < 8; round++)
+      {
+         if (round % 2)
+            l.sort(std::greater<int>());
+         else
+            l.sort();
+         l.compact();
+         allCompact = allCompact && l.pHead->pNext == l.pHead + 1;
+         if (round == 1)
+            slabs = Pool::slabCount();
+      }
+      // verify
+      assertUnit(allCompact);
+      assertUnit(Pool::slabCount() == slabs);
+      assertUnit(l.size() == 20000);
+      assertUnit(l.front() == 19999);
+   }  // teardown
+
+   // nodes freed on a thread which never allocates go back to the
+   // pool when the thread ends, so passing lists off to short-lived
+   // threads to be freed does not grow the pool. The item is a size no
+   // other test uses, so the pool starts out empty.
+   struct Bulky
+   {
+      char bytes[232];
+   };
+   void test_free_threadExit()
+   {  // setup
+      typedef custom::list<Bulky>::Node Node;
+      typedef custom::pool<sizeof(Node), alignof(Node)> Pool;
+      size_t slabs = 0;
+      // exercise
+      for (int round = 0; round < 200; round++)
+      {
+         custom::list<Bulky> l;
+         for (int i = 0; i < 40; i++)
+            l.push_back(Bulky());
+         std::thread t([&l]()
+         {
+            while (!l.empty())
+               l.pop_front();
+         });
+         t.join();
+         if (round == 1)
+            slabs = Pool::slabCount();
+      }
+      // verify
+      assertUnit(Pool::slabCount() <= slabs + 1);
+   }  // teardown
+#endif // LIST_POOL
+
+   /***************************************
+    * FOR EACH PREFETCH
+    ***************************************/
+
+   // nothing to visit in an empty list
+   void test_forEachPrefetch_empty()
+   {  // setup
+      custom::list<int> l;
+      int count = 0;
+      // exercise
+      l.for_each_prefetch([&count](int &) { count++; });
+      // verify
+      assertUnit(count == 0);
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // visit every item in order, looking further ahead than the list is long
+   void test_forEachPrefetch_standard()
+   {  // setup
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      custom::list<int> l;
+      setupStandardFixture(l);
+      std::vector<int> visited;
+      // exercise
+      l.for_each_prefetch([&visited](int & value) { visited.push_back(value); }, 8);
+      // verify
+      assertUnit(visited.size() == 3);
+      if (visited.size() == 3)
+      {
+         assertUnit(visited[0] == 11);
+         assertUnit(visited[1] == 26);
+         assertUnit(visited[2] == 31);
+      }
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // with no look-ahead the items can still be updated in place
+   void test_forEachPrefetch_noDistance()
+   {  // setup
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      custom::list<int> l;
+      setupStandardFixture(l);
+      // exercise
+      l.for_each_prefetch([](int & value) { value += 1; }, 0);
+      // verify
+      //    +----+   +----+   +----+
+      //    | 12 | - | 27 | - | 32 |
+      //    +----+   +----+   +----+
+      assertUnit(l.pHead->data == 12);
+      assertUnit(l.pHead->pNext->data == 27);
+      assertUnit(l.pTail->data == 32);
+      l.for_each_prefetch([](int & value) { value -= 1; }, 1);
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   /***************************************
+    * BULK
+    ***************************************/
+
+   // an empty range changes nothing
+   void test_pushbackBulk_empty()
+   {  // setup
+      custom::list<int> l;
+      std::vector<int> v;
+      // exercise
+      l.push_back_bulk(v.begin(), v.end());
+      // verify
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // the range goes on the end, in order
+   void test_pushbackBulk_standard()
+   {  // setup
+      //    +----+
+      //    | 11 |
+      //    +----+
+      custom::list<int> l;
+      l.push_back(11);
+      std::vector<int> v { 26, 31 };
+      // exercise
+      l.push_back_bulk(v.begin(), v.end());
+      // verify
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // an item whose copy throws on one value
+   struct Fragile
+   {
+      Fragile(int value) : value(value) { }
+      Fragile(const Fragile & rhs) : value(rhs.value)
+      {
+         if (value == 42)
+            throw std::string("42");
+      }
+      std::string padding = std::string(100, 'x');   // so a leak is a real allocation
+      int value;
+   };
+
+   // a copy which throws leaves the list as it was
+   void test_pushbackBulk_throws()
+   {  // setup
+      custom::list<Fragile> l;
+      l.push_back(Fragile(7));
+      std::vector<Fragile> v;
+      v.reserve(3);
+      v.emplace_back(1);
+      v.emplace_back(2);
+      v.emplace_back(3);
+      v[2].value = 42;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.push_back_bulk(v.begin(), v.end());
+      }
+      catch (const std::string & what)
+      {
+         thrown = (what == "42");
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(l.size() == 1);
+      assertUnit(l.pHead == l.pTail);
+      assertUnit(l.pTail->pNext == nullptr);
+      assertUnit(l.front().value == 7);
+   }  // teardown
+
+   // nothing to pop
+   void test_popfrontBulk_empty()
+   {  // setup
+      custom::list<int> l;
+      std::vector<int> v;
+      // exercise
+      size_t num = l.pop_front_bulk(std::back_inserter(v), 10);
+      // verify
+      assertUnit(num == 0);
+      assertUnit(v.empty());
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // the first few come off in order
+   void test_popfrontBulk_some()
+   {  // setup
+      //    +----+   +----+   +----+   +----+   +----+
+      //    | 97 | - | 98 | - | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+   +----+   +----+
+      custom::list<int> l;
+      l.push_back(97);
+      l.push_back(98);
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      int out[2] = { 0, 0 };
+      // exercise
+      size_t num = l.pop_front_bulk(out, 2);
+      // verify
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      assertUnit(num == 2);
+      assertUnit(out[0] == 97);
+      assertUnit(out[1] == 98);
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // asking for more than there is takes everything
+   void test_popfrontBulk_all()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      std::vector<int> v;
+      // exercise
+      size_t num = l.pop_front_bulk(std::back_inserter(v), 99);
+      // verify
+      assertUnit(num == 3);
+      assertUnit(v.size() == 3);
+      if (v.size() == 3)
+      {
+         assertUnit(v[0] == 11);
+         assertUnit(v[2] == 31);
+      }
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // drain_into moves everything onto the end of another list
+   void test_drainInto_standard()
+   {  // setup
+      custom::list<int> l;
+      l.push_back(26);
+      l.push_back(31);
+      custom::list<int> rhs;
+      rhs.push_back(11);
+      // exercise
+      l.drain_into(rhs);
+      // verify
+      assertEmptyFixture(l);
+      assertStandardFixture(rhs);
+      // teardown
+      teardownStandardFixture(rhs);
+   }
+
+   /***************************************
+    * EXPORT
+    ***************************************/
+
+   // nothing is written
+   void test_copyTo_empty()
+   {  // setup
+      custom::list<int> l;
+      int out[1] = { 99 };
+      // exercise
+      int * pEnd = l.copy_to(out);
+      // verify
+      assertUnit(pEnd == out);
+      assertUnit(out[0] == 99);
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // the items land in order and the list keeps them
+   void test_copyTo_standard()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      int out[4] = { 0, 0, 0, 99 };
+      // exercise
+      int * pEnd = l.copy_to(out);
+      // verify
+      assertUnit(pEnd == out + 3);
+      assertUnit(out[0] == 11);
+      assertUnit(out[1] == 26);
+      assertUnit(out[2] == 31);
+      assertUnit(out[3] == 99);
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // the vector is exactly as big as the list
+   void test_toVector_standard()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      // exercise
+      std::vector<int> v = l.to_vector();
+      // verify
+      assertUnit(v.size() == 3);
+      assertUnit(v.capacity() == 3);
+      if (v.size() == 3)
+      {
+         assertUnit(v[0] == 11);
+         assertUnit(v[1] == 26);
+         assertUnit(v[2] == 31);
+      }
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // every item is moved out and the list is left empty
+   void test_drainTo_standard()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      int out[3] = { 0, 0, 0 };
+      // exercise
+      int * pEnd = l.drain_to(out);
+      // verify
+      assertUnit(pEnd == out + 3);
+      assertUnit(out[0] == 11);
+      assertUnit(out[1] == 26);
+      assertUnit(out[2] == 31);
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // the items are moved, not copied
+   void test_drainTo_string()
+   {  // setup
+      custom::list<std::string> l;
+      l.push_back(std::string(100, 'a'));
+      l.push_back(std::string(100, 'b'));
+      const char * pChars = l.pHead->data.data();
+      std::vector<std::string> v;
+      // exercise
+      l.drain_to(std::back_inserter(v));
+      // verify
+      assertUnit(v.size() == 2);
+      if (v.size() == 2)
+      {
+         assertUnit(v[0].data() == pChars);
+         assertUnit(v[1] == std::string(100, 'b'));
+      }
+      assertUnit(l.size() == 0);
+      assertUnit(l.pHead == nullptr);
+      assertUnit(l.pTail == nullptr);
+   }  // teardown
+
+   /***************************************
+    * WRITE and READ
+    ***************************************/
+
+   // an empty list is just the header
+   void test_write_empty()
+   {  // setup
+      custom::list<int> l;
+      std::vector<char> buffer;
+      // exercise
+      l.write(buffer);
+      // verify
+      assertUnit(buffer.size() == 16);
+      if (buffer.size() == 16)
+      {
+         assertUnit(std::string(buffer.data(), 4) == "CLST");
+         uint32_t itemSize;
+         uint64_t numItems;
+         std::memcpy(&itemSize, buffer.data() + 4, 4);
+         std::memcpy(&numItems, buffer.data() + 8, 8);
+         assertUnit(itemSize == sizeof(int));
+         assertUnit(numItems == 0);
+      }
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // the header and then the items, back to back
+   void test_write_standard()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      std::vector<char> buffer;
+      // exercise
+      l.write(buffer);
+      // verify
+      assertUnit(buffer.size() == 16 + 3 * sizeof(int));
+      if (buffer.size() == 16 + 3 * sizeof(int))
+      {
+         int items[3];
+         std::memcpy(items, buffer.data() + 16, sizeof(items));
+         assertUnit(items[0] == 11);
+         assertUnit(items[1] == 26);
+         assertUnit(items[2] == 31);
+      }
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // reading replaces what was there
+   void test_read_standard()
+   {  // setup
+      custom::list<int> lSrc;
+      setupStandardFixture(lSrc);
+      std::stringstream stream;
+      lSrc.write(stream);
+      custom::list<int> l;
+      l.push_back(99);
+      // exercise
+      l.read(stream);
+      // verify
+      assertStandardFixture(l);
+      assertStandardFixture(lSrc);
+      // teardown
+      teardownStandardFixture(lSrc);
+   }
+
+   // strings go through their list_serializer
+   void test_read_string()
+   {  // setup
+      custom::list<std::string> lSrc;
+      lSrc.push_back("eleven");
+      lSrc.push_back("");
+      lSrc.push_back(std::string(1000, 'x'));
+      std::stringstream stream;
+      lSrc.write(stream);
+      custom::list<std::string> l;
+      // exercise
+      l.read(stream);
+      // verify
+      assertUnit(l.size() == 3);
+      if (l.size() == 3)
+      {
+         assertUnit(l.pHead->data == "eleven");
+         assertUnit(l.pHead->pNext->data == "");
+         assertUnit(l.pTail->data == std::string(1000, 'x'));
+         assertUnit(l.pTail->pPrev == l.pHead->pNext);
+      }
+   }  // teardown
+
+   // read says how much of the buffer it used
+   void test_read_twoInOneBuffer()
+   {  // setup
+      custom::list<int> lFirst;
+      setupStandardFixture(lFirst);
+      custom::list<int> lSecond;
+      lSecond.push_back(99);
+      std::vector<char> buffer;
+      lFirst.write(buffer);
+      lSecond.write(buffer);
+      custom::list<int> l1;
+      custom::list<int> l2;
+      // exercise
+      size_t used = l1.read(buffer.data(), buffer.size());
+      size_t usedToo = l2.read(buffer.data() + used, buffer.size() - used);
+      // verify
+      assertUnit(used == 16 + 3 * sizeof(int));
+      assertUnit(used + usedToo == buffer.size());
+      assertStandardFixture(l1);
+      assertUnit(l2.size() == 1);
+      assertUnit(l2.front() == 99);
+      // teardown
+      teardownStandardFixture(lFirst);
+   }
+
+   // more items than fit in one block, linked across the blocks
+   void test_read_bigBlocks()
+   {  // setup
+      custom::list<int> lSrc;
+      for (int i = 0; i < 40000; i++)
+         lSrc.push_back(i);
+      std::vector<char> buffer;
+      lSrc.write(buffer);
+      custom::list<int> l;
+      // exercise
+      l.read(buffer.data(), buffer.size());
+      // verify
+      assertUnit(l.size() == 40000);
+      int expected = 0;
+      custom::list<int>::Node * pPrev = nullptr;
+      for (auto p = l.pHead; p; pPrev = p, p = p->pNext, expected++)
+      {
+         if (p->data != expected || p->pPrev != pPrev)
+            break;
+      }
+      assertUnit(expected == 40000);
+      assertUnit(l.pTail == pPrev);
+   }  // teardown
+
+   // a cut off buffer throws and leaves the list alone
+   void test_read_short()
+   {  // setup
+      custom::list<std::string> lSrc;
+      lSrc.push_back("eleven");
+      lSrc.push_back("twenty six");
+      std::vector<char> buffer;
+      lSrc.write(buffer);
+      custom::list<std::string> l;
+      l.push_back("ninety nine");
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.read(buffer.data(), buffer.size() - 1);
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(l.size() == 1);
+      assertUnit(l.front() == "ninety nine");
+   }  // teardown
+
+   // a string claiming to be a terabyte long in a short buffer
+   // fails when the buffer runs out, not when allocating
+   void test_read_hugeLength()
+   {  // setup
+      custom::list<std::string> lSrc;
+      lSrc.push_back("eleven");
+      std::vector<char> buffer;
+      lSrc.write(buffer);
+      uint64_t length = uint64_t(1) << 40;
+      std::memcpy(buffer.data() + 16, &length, sizeof(length));
+      custom::list<std::string> l;
+      l.push_back("ninety nine");
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.read(buffer.data(), buffer.size());
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(l.size() == 1);
+      assertUnit(l.front() == "ninety nine");
+   }  // teardown
+
+#ifdef LIST_POOL
+   // loading the same list over and over reuses the nodes of the last
+   // one, so the pool stops growing
+   void test_read_reusesSlabs()
+   {  // setup
+      typedef custom::list<int>::Node Node;
+      typedef custom::pool<sizeof(Node), alignof(Node)> Pool;
+      custom::list<int> lSrc;
+      for (int i = 0; i < 40000; i++)
+         lSrc.push_back(i);
+      std::stringstream stream;
+      lSrc.write(stream);
+      size_t slabs = 0;
+      bool allRead = true;
+      // exercise
+      for (int round = 0; round < 8; round++)
+      {
+         custom::list<int> l;
+         stream.clear();
+         stream.seekg(0);
+         l.read(stream);
+         allRead = allRead && l.size() == 40000 && l.back() == 39999;
+         if (round == 1)
+            slabs = Pool::slabCount();
+      }
+      // verify
+      assertUnit(allRead);
+      assertUnit(Pool::slabCount() == slabs);
+   }  // teardown
+#endif // LIST_POOL
+
+   // a list of another type is refused
+   void test_read_wrongType()
+   {  // setup
+      custom::list<double> lSrc;
+      lSrc.push_back(1.5);
+      std::vector<char> buffer;
+      lSrc.write(buffer);
+      custom::list<int> l;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.read(buffer.data(), buffer.size());
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertEmptyFixture(l);
+   }  // teardown
+
+   /***************************************
+    * SPLICE
+    ***************************************/
+
+   // splicing an empty list changes nothing
+   void test_splice_emptyRhs()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int> rhs;
+      // exercise
+      l.splice(l.end(), rhs);
+      // verify
+      assertEmptyFixture(rhs);
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // splicing into an empty list takes the nodes as they are
+   void test_splice_intoEmpty()
+   {  // setup
+      custom::list<int> l;
+      custom::list<int> rhs;
+      setupStandardFixture(rhs);
+      custom::list<int>::Node * pHead = rhs.pHead;
+      // exercise
+      l.splice(l.end(), rhs);
+      // verify
+      assertUnit(l.pHead == pHead);
+      assertStandardFixture(l);
+      assertEmptyFixture(rhs);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // splice onto the end
+   void test_splice_end()
+   {  // setup
+      //    +----+        +----+   +----+
+      //    | 11 |        | 26 | - | 31 |
+      //    +----+        +----+   +----+
+      custom::list<int> l;
+      l.push_back(11);
+      custom::list<int> rhs;
+      rhs.push_back(26);
+      rhs.push_back(31);
+      // exercise
+      l.splice(l.end(), rhs);
+      // verify
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      assertStandardFixture(l);
+      assertEmptyFixture(rhs);
+      // teardown
+      l.clear();
+   }
+
+   // splice in front of the first node
+   void test_splice_front()
+   {  // setup
+      //    +----+   +----+        +----+
+      //    | 11 | - | 26 |        | 31 |
+      //    +----+   +----+        +----+
+      custom::list<int> l;
+      l.push_back(31);
+      custom::list<int> rhs;
+      rhs.push_back(11);
+      rhs.push_back(26);
+      // exercise
+      l.splice(l.begin(), rhs);
+      // verify
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      assertStandardFixture(l);
+      assertEmptyFixture(rhs);
+      // teardown
+      l.clear();
+   }
+
+   /***************************************
+    * SORT
+    ***************************************/
+
+   // sorting an empty list does nothing
+   void test_sort_empty()
+   {  // setup
+      custom::list<int> l;
+      // exercise
+      l.sort();
+      // verify
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // the nodes are relinked, not copied
+   void test_sort_standard()
+   {  // setup
+      //    +----+   +----+   +----+
+      //    | 31 | - | 11 | - | 26 |
+      //    +----+   +----+   +----+
+      custom::list<int> l;
+      l.push_back(31);
+      l.push_back(11);
+      l.push_back(26);
+      custom::list<int>::Node * p31 = l.pHead;
+      custom::list<int>::Node * p11 = l.pHead->pNext;
+      custom::list<int>::Node * p26 = l.pTail;
+      // exercise
+      l.sort();
+      // verify
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      assertUnit(l.pHead == p11);
+      assertUnit(l.pHead->pNext == p26);
+      assertUnit(l.pTail == p31);
+      assertStandardFixture(l);
+      // teardown
+      l.clear();
+   }
+
+   // sort with a comparison of our own
+   void test_sort_compare()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 100; i++)
+         l.push_back((i * 37) % 100);
+      // exercise
+      l.sort([](int lhs, int rhs) { return lhs > rhs; });
+      // verify
+      int expected = 99;
+      for (auto it = l.begin(); it != l.end(); ++it, expected--)
+         assertUnit(*it == expected);
+      assertUnit(expected == -1);
+      assertUnit(l.size() == 100);
+      assertUnit(l.pHead->pPrev == nullptr);
+      assertUnit(l.pTail->data == 0);
+      assertUnit(l.pTail->pNext == nullptr);
+      assertUnit(l.pTail->pPrev->data == 1);
+      // teardown
+      l.clear();
+   }
+
+   // equal items keep their order
+   void test_sort_stable()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 50; i++)
+         l.push_back((i % 5) * 100 + i);
+      // exercise
+      l.sort([](int lhs, int rhs) { return lhs / 100 < rhs / 100; });
+      // verify
+      int previous = -1;
+      for (auto it = l.begin(); it != l.end(); ++it)
+      {
+         assertUnit(*it > previous);
+         previous = *it;
+      }
+      // teardown
+      l.clear();
+   }
+
+   // a comparison which throws, wherever in the sort, leaves every
+   // item in the list, linked both ways
+   void test_sort_throws()
+   {  // setup
+      bool allThrown = true;
+      bool allKept = true;
+      // exercise
+      for (int throwAt = 1; throwAt < 700; throwAt += 7)
+      {
+         custom::list<int> l;
+         for (int i = 0; i < 100; i++)
+            l.push_back((i * 37) % 100);
+         int calls = 0;
+         bool thrown = false;
+         try
+         {
+            l.sort([&calls, throwAt](int lhs, int rhs)
+            {
+               if (++calls == throwAt)
+                  throw "ERROR: unable to compare";
+               return lhs < rhs;
+            });
+         }
+         catch (const char * error)
+         {
+            thrown = true;
+         }
+         allThrown = allThrown && (thrown || calls < throwAt);
+
+         std::vector<bool> seen(100, false);
+         size_t num = 0;
+         custom::list<int>::Node * pPrev = nullptr;
+         for (custom::list<int>::Node * p = l.pHead; p && num <= 100; pPrev = p, p = p->pNext, num++)
+         {
+            allKept = allKept && p->pPrev == pPrev && !seen[p->data];
+            seen[p->data] = true;
+         }
+         allKept = allKept && num == 100 && l.pTail == pPrev && l.size() == 100;
+         allKept = allKept && l.pFinger == nullptr;
+      }
+      // verify
+      assertUnit(allThrown);
+      assertUnit(allKept);
+   }  // teardown
+
+#ifdef LIST_STATS
+   /***************************************
+    * STATS
+    ***************************************/
+
+   // moving a list allocates no nodes
+   void test_stats_constructMove()
+   {  // setup
+      custom::list<int> lSrc;
+      setupStandardFixture(lSrc);
+      custom::listStats & stats = custom::list<int>::stats();
+      size_t allocations = stats.allocations;
+      size_t frees = stats.frees;
+      // exercise
+      custom::list<int> lDest(std::move(lSrc));
+      // verify
+      assertUnit(stats.allocations == allocations);
+      assertUnit(stats.frees == frees);
+      assertStandardFixture(lDest);
+      // teardown
+      teardownStandardFixture(lDest);
+   }
+
+   // copying a list of three allocates three nodes, charged to copy-assign
+   void test_stats_constructCopy()
+   {  // setup
+      custom::list<int> lSrc;
+      setupStandardFixture(lSrc);
+      custom::listStats & stats = custom::list<int>::stats();
+      size_t allocations = stats.allocations;
+      size_t copyAssign = stats.allocationsByOp[custom::listStats::COPY_ASSIGN];
+      size_t nodesLive = stats.nodesLive;
+      // exercise
+      custom::list<int> lDest(lSrc);
+      // verify
+      assertUnit(stats.allocations == allocations + 3);
+      assertUnit(stats.allocationsByOp[custom::listStats::COPY_ASSIGN] == copyAssign + 3);
+      assertUnit(stats.nodesLive == nodesLive + 3);
+      assertUnit(stats.nodesPeak >= nodesLive + 3);
+      assertUnit(stats.bytesLive == stats.nodesLive * sizeof(custom::list<int>::Node));
+      assertStandardFixture(lDest);
+      // teardown
+      teardownStandardFixture(lSrc);
+      teardownStandardFixture(lDest);
+   }
+
+   // the push_backs inside the fill constructor are charged to the fill
+   void test_stats_constructFill()
+   {  // setup
+      custom::listStats & stats = custom::list<int>::stats();
+      size_t fill = stats.allocationsByOp[custom::listStats::FILL_CONSTRUCT];
+      size_t push = stats.allocationsByOp[custom::listStats::PUSH];
+      // exercise
+      custom::list<int> l(size_t(3), int(99));
+      // verify
+      assertUnit(stats.allocationsByOp[custom::listStats::FILL_CONSTRUCT] == fill + 3);
+      assertUnit(stats.allocationsByOp[custom::listStats::PUSH] == push);
+      assertUnit(l.size() == 3);
+   }  // teardown
+
+   // one push_back is one allocation
+   void test_stats_pushback()
+   {  // setup
+      custom::list<int> l;
+      custom::listStats & stats = custom::list<int>::stats();
+      size_t push = stats.allocationsByOp[custom::listStats::PUSH];
+      // exercise
+      l.push_back(int(99));
+      // verify
+      assertUnit(stats.allocationsByOp[custom::listStats::PUSH] == push + 1);
+      assertUnit(l.size() == 1);
+   }  // teardown
+
+   // clearing a list of three frees three nodes
+   void test_stats_clear()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::listStats & stats = custom::list<int>::stats();
+      size_t frees = stats.frees;
+      size_t nodesLive = stats.nodesLive;
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(stats.frees == frees + 3);
+      assertUnit(stats.nodesLive == nodesLive - 3);
+      assertEmptyFixture(l);
+   }  // teardown
+#endif // LIST_STATS
+
+#ifdef LIST_CACHE_ALIGNED
+   /***************************************
+    * LAYOUT
+    ***************************************/
+
+   // the front and the back are on different cache lines
+   void test_layout_cacheAligned()
+   {  // setup
+      custom::list<int> l;
+      // exercise
+      const char * pList     = reinterpret_cast<const char *>(&l);
+      const char * pFront    = reinterpret_cast<const char *>(&l.pHead);
+      const char * pFrontEnd = reinterpret_cast<const char *>(&l.fingerIndex + 1);
+      const char * pBack     = reinterpret_cast<const char *>(&l.pTail);
+      const char * pBackEnd  = reinterpret_cast<const char *>(&l.numTail + 1);
+      // verify
+      assertUnit(reinterpret_cast<const char *>(&l.numHead) > pFront);
+      assertUnit(reinterpret_cast<const char *>(&l.numHead) < pFrontEnd);
+      assertUnit(reinterpret_cast<const char *>(&l.pFinger) < pFrontEnd);
+      assertUnit(pFront - pList >= 64);
+      assertUnit(pBack - pFrontEnd >= 64);
+      assertUnit(pBackEnd > pBack);
+      assertUnit(pList + sizeof(l) - pBackEnd >= 64);
+   }  // teardown
+
+   // work at the front never writes the back's count, nor the reverse
+   void test_layout_countHalves()
+   {  // setup
+      custom::list<int> l;
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      size_t numTail = l.numTail;
+      // exercise
+      l.pop_front();
+      l.push_front(99);
+      l.pop_front();
+      // verify
+      assertUnit(l.numTail == numTail);
+      assertUnit(l.size() == 2);
+      size_t numHead = l.numHead;
+      l.push_back(42);
+      assertUnit(l.numHead == numHead);
+      assertUnit(l.size() == 3);
+   }  // teardown
+#endif // LIST_CACHE_ALIGNED
+
+#ifdef LIST_TRACE
+   /***************************************
+    * TRACE
+    ***************************************/
+
+   // each push_back is timed once
+   void test_trace_pushback()
+   {  // setup
+      custom::list<int> l;
+      uint64_t count = custom::listTrace::count(custom::listTrace::PUSH_BACK);
+      // exercise
+      l.push_back(int(11));
+      l.push_back(int(26));
+      // verify
+      assertUnit(custom::listTrace::count(custom::listTrace::PUSH_BACK) == count + 2);
+      assertUnit(l.size() == 2);
+   }  // teardown
+
+   // the erase inside pop_back is charged to pop_back only
+   void test_trace_popback()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      uint64_t popBack = custom::listTrace::count(custom::listTrace::POP_BACK);
+      uint64_t erase = custom::listTrace::count(custom::listTrace::ERASE);
+      // exercise
+      l.pop_back();
+      // verify
+      assertUnit(custom::listTrace::count(custom::listTrace::POP_BACK) == popBack + 1);
+      assertUnit(custom::listTrace::count(custom::listTrace::ERASE) == erase);
+      assertUnit(l.size() == 2);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // a whole-list drain has its own histogram, apart from pop_front_bulk
+   void test_trace_drainTo()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      std::vector<int> v;
+      uint64_t drain = custom::listTrace::count(custom::listTrace::DRAIN);
+      uint64_t popBulk = custom::listTrace::count(custom::listTrace::POP_FRONT_BULK);
+      // exercise
+      l.drain_to(std::back_inserter(v));
+      // verify
+      assertUnit(custom::listTrace::count(custom::listTrace::DRAIN) == drain + 1);
+      assertUnit(custom::listTrace::count(custom::listTrace::POP_FRONT_BULK) == popBulk);
+      assertUnit(v.size() == 3);
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // every bucket starts where the one before it ends
+   void test_trace_buckets()
+   {  // setup
+      int previous = 0;
+      bool ordered = true;
+      bool exact = true;
+      // exercise
+      for (uint64_t value = 1; value < 100000; value++)
+      {
+         int bucket = custom::listTrace::bucket(value);
+         ordered = ordered && (bucket == previous || bucket == previous + 1);
+         exact = exact && (custom::listTrace::bucketValue(bucket) <= value);
+         exact = exact && (custom::listTrace::bucketValue(bucket + 1) > value);
+         previous = bucket;
+      }
+      // verify
+      assertUnit(ordered);
+      assertUnit(exact);
+      assertUnit(custom::listTrace::bucket(~uint64_t(0)) == custom::listTrace::NUM_BUCKETS - 1);
+   }  // teardown
+
+   // a list destroyed after its thread's histograms are folded away
+   // is still counted, and does not touch the freed histograms
+   void test_trace_threadExit()
+   {  // setup
+      uint64_t clear = custom::listTrace::count(custom::listTrace::CLEAR);
+      // exercise
+      std::thread t([]()
+      {
+         // built before the first timed operation, so destroyed after
+         // the thread's histograms
+         static thread_local custom::list<int> l;
+         l.push_back(int(11));
+      });
+      t.join();
+      // verify
+      assertUnit(custom::listTrace::count(custom::listTrace::CLEAR) == clear + 1);
+   }  // teardown
+#endif // LIST_TRACE
+
    /****************************************************************
     * Setup Standard Fixture
     *        pHead             pTail
@@ -2009,7 +3479,7 @@ public:
       // set up the list
       l.pHead = p1;
       l.pTail = p3;
-      l.numElements = 3;
+      l.setCount(3);
    }
 
    /****************************************************************
@@ -2039,7 +3509,7 @@ public:
          }
          delete l.pHead;
          l.pHead = l.pTail = nullptr;
-         l.numElements = 0;
+         l.setCount(0);
       }
    }
 
@@ -2049,7 +3519,7 @@ public:
    void assertEmptyFixtureParameters(const custom::list<int>& l, int line, const char* function)
    {
       // verify the member variables
-      assertIndirect(l.numElements == 0);
+      assertIndirect(l.size() == 0);
       assertIndirect(l.pHead == nullptr);
       assertIndirect(l.pTail == nullptr);
    }
@@ -2064,7 +3534,7 @@ public:
    void assertStandardFixtureParameters(const custom::list<int>& l, int line, const char* function)
    {
       // verify the member variables
-      assertIndirect(l.numElements == 3);
+      assertIndirect(l.size() == 3);
       assertIndirect(l.pHead != nullptr);
       assertIndirect(l.pTail != nullptr);
 
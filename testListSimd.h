@@ -0,0 +1,259 @@
+/***********************************************************************
+ * Header:
+ *    TEST LIST SIMD
+ * Summary:
+ *    Unit tests for the simd scans. The array tests run once at each
+ *    level this processor has, and must give the plain loop's answer.
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "listSimd.h"
+#include "unitTest.h"
+
+#include <climits>
+#include <vector>
+
+class TestListSimd : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Dispatch
+      test_use_limits();
+
+      for (int now = custom::simd::SCALAR; now <= custom::simd::AVX2; now++)
+      {
+         custom::simd::use((custom::simd::level)now);
+
+         // Arrays
+         test_array_find();
+         test_array_count();
+         test_array_minMax();
+         test_array_sumWraps();
+         test_array_float();
+      }
+      custom::simd::use(custom::simd::AVX2);
+
+      // Lists
+      test_list_findLate();
+      test_list_findMissing();
+      test_list_count();
+      test_list_minMaxSum();
+      test_list_empty();
+      test_list_double();
+
+      report("ListSimd");
+   }
+
+   /***************************************
+    * DISPATCH
+    ***************************************/
+
+   // use() caps the level but never raises it past the processor
+   void test_use_limits()
+   {  // setup
+      custom::simd::level best = custom::simd::detect();
+      // exercise
+      custom::simd::use(custom::simd::SCALAR);
+      custom::simd::level capped = custom::simd::active();
+      custom::simd::use(custom::simd::AVX2);
+      custom::simd::level full = custom::simd::active();
+      // verify
+      assertUnit(capped == custom::simd::SCALAR);
+      assertUnit(full == best);
+   }  // teardown
+
+   /***************************************
+    * ARRAYS
+    ***************************************/
+
+   // the first match at every position, including the odd ones at the end
+   void test_array_find()
+   {  // setup
+      std::vector<int> v(37, 0);
+      bool allFound = true;
+      // exercise
+      for (size_t i = 0; i < v.size(); i++)
+      {
+         v[i] = 7;
+         allFound = allFound && custom::simd::find(v.data(), v.size(), 7) == v.data() + i;
+         v[i] = 0;
+      }
+      // verify
+      assertUnit(allFound);
+      assertUnit(custom::simd::find(v.data(), v.size(), 7) == v.data() + v.size());
+      assertUnit(!custom::simd::contains(v.data(), v.size(), 7));
+      assertUnit(custom::simd::contains(v.data(), v.size(), 0));
+   }  // teardown
+
+   // every length from 0 to 40 counts the same as the plain loop
+   void test_array_count()
+   {  // setup
+      std::vector<int> v;
+      for (int i = 0; i < 40; i++)
+         v.push_back(i % 3);
+      bool allSame = true;
+      // exercise
+      for (size_t num = 0; num <= v.size(); num++)
+         allSame = allSame && custom::simd::count(v.data(), num, 1) ==
+                              custom::simd::kernels<int>::count(v.data(), num, 1);
+      // verify
+      assertUnit(allSame);
+   }  // teardown
+
+   // the smallest and largest, wherever they are
+   void test_array_minMax()
+   {  // setup
+      std::vector<int> v;
+      for (int i = 0; i < 29; i++)
+         v.push_back((i * 7919) % 101 - 50);
+      v[27] = INT_MIN;
+      v[3] = INT_MAX;
+      // exercise
+      int m = custom::simd::min(v.data(), v.size());
+      int M = custom::simd::max(v.data(), v.size());
+      // verify
+      assertUnit(m == INT_MIN);
+      assertUnit(M == INT_MAX);
+      assertUnit(custom::simd::min(v.data() + 4, 3) == custom::simd::kernels<int>::min(v.data() + 4, 3));
+      assertUnit(custom::simd::max(v.data() + 4, 20) == custom::simd::kernels<int>::max(v.data() + 4, 20));
+   }  // teardown
+
+   // an int sum that overflows wraps the same way at every level
+   void test_array_sumWraps()
+   {  // setup
+      std::vector<int> v(21, INT_MAX);
+      // exercise
+      int total = custom::simd::sum(v.data(), v.size());
+      // verify
+      unsigned int expected = 0;
+      for (size_t i = 0; i < v.size(); i++)
+         expected += (unsigned int)INT_MAX;
+      assertUnit(total == (int)expected);
+   }  // teardown
+
+   // floats with whole values, so the sum is exact in any order
+   void test_array_float()
+   {  // setup
+      std::vector<float> v;
+      for (int i = 0; i < 36; i++)
+         v.push_back((float)(i % 5) - 2.0f);
+      // exercise
+      float total = custom::simd::sum(v.data(), v.size());
+      // verify
+      assertUnit(total == -2.0f);
+      assertUnit(custom::simd::count(v.data(), v.size(), 2.0f) == 7);
+      assertUnit(custom::simd::find(v.data(), v.size(), 1.0f) == v.data() + 3);
+      assertUnit(custom::simd::min(v.data(), v.size()) == -2.0f);
+      assertUnit(custom::simd::max(v.data(), v.size()) == 2.0f);
+   }  // teardown
+
+   /***************************************
+    * LISTS
+    ***************************************/
+
+   // the iterator points at the match, deep in the list
+   void test_list_findLate()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 3000; i++)
+         l.push_back(i);
+      // exercise
+      auto it = custom::simd::find(l, 2500);
+      // verify
+      assertUnit(it != l.end());
+      assertUnit(*it == 2500);
+      if (it != l.end())
+         assertUnit(*++it == 2501);
+      assertUnit(custom::simd::contains(l, 1023));
+      assertUnit(custom::simd::contains(l, 1024));
+   }  // teardown
+
+   // no match gives end()
+   void test_list_findMissing()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 100; i++)
+         l.push_back(i);
+      // exercise
+      auto it = custom::simd::find(l, 100);
+      // verify
+      assertUnit(it == l.end());
+   }  // teardown
+
+   // every match in the list is counted
+   void test_list_count()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 2500; i++)
+         l.push_back(i % 10);
+      // exercise
+      size_t num = custom::simd::count(l, 3);
+      // verify
+      assertUnit(num == 250);
+   }  // teardown
+
+   // the answers come from the whole list, not just the front
+   void test_list_minMaxSum()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 2100; i++)
+         l.push_back(i % 100);
+      l.push_back(-5);
+      l.push_back(500);
+      // exercise
+      int m = custom::simd::min(l);
+      int M = custom::simd::max(l);
+      int total = custom::simd::sum(l);
+      // verify
+      assertUnit(m == -5);
+      assertUnit(M == 500);
+      assertUnit(total == 21 * 4950 - 5 + 500);
+   }  // teardown
+
+   // nothing to find, count or add up, and no min or max
+   void test_list_empty()
+   {  // setup
+      custom::list<int> l;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::simd::min(l);
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(custom::simd::find(l, 0) == l.end());
+      assertUnit(custom::simd::count(l, 0) == 0);
+      assertUnit(custom::simd::sum(l) == 0);
+   }  // teardown
+
+   // types without a vector kernel use the plain loop
+   void test_list_double()
+   {  // setup
+      custom::list<double> l;
+      l.push_back(1.5);
+      l.push_back(-2.5);
+      l.push_back(4.0);
+      // exercise
+      double total = custom::simd::sum(l);
+      // verify
+      assertUnit(total == 3.0);
+      assertUnit(custom::simd::min(l) == -2.5);
+      assertUnit(custom::simd::max(l) == 4.0);
+      assertUnit(custom::simd::count(l, 4.0) == 1);
+   }  // teardown
+};
+
+#endif // DEBUG
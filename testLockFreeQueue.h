@@ -0,0 +1,328 @@
+/***********************************************************************
+ * Header:
+ *    TEST LOCK FREE QUEUE
+ * Summary:
+ *    Unit tests for lockfree_queue
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "lockFreeQueue.h"
+#include "unitTest.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestLockFreeQueue : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_destruct_items();
+
+      // Insert and Remove
+      test_pushback_standard();
+      test_popfront_empty();
+      test_popfront_standard();
+      test_popfront_last();
+      test_popfront_string();
+      test_popfront_throws();
+
+      // Threads
+      test_threads_pushPop();
+      test_threads_producersConsumers();
+
+      report("LockFreeQueue");
+   }
+
+   /***************************************
+    * CONSTRUCTOR and DESTRUCTOR
+    ***************************************/
+
+   // a new queue is just the dummy
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::lockfree_queue<int> q;
+      // verify
+      assertUnit(q.pHead.load() != nullptr);
+      assertUnit(q.pTail.load() == q.pHead.load());
+      if (q.pHead.load())
+         assertUnit(q.pHead.load()->pNext.load() == nullptr);
+      assertUnit(q.empty());
+   }  // teardown
+
+   // items still in the queue are destroyed with it
+   void test_destruct_items()
+   {  // setup
+      std::string a(100, 'a');
+      std::string b(100, 'b');
+      {
+         custom::lockfree_queue<std::string> q;
+         q.push_back(a);
+         q.push_back(b);
+         // exercise
+      }  // the sanitizers catch a leak or a double free here
+      // verify
+      assertUnit(a == std::string(100, 'a'));
+      assertUnit(b == std::string(100, 'b'));
+   }  // teardown
+
+   /***************************************
+    * PUSH BACK and POP FRONT
+    ***************************************/
+
+   // push_back links after the tail
+   void test_pushback_standard()
+   {  // setup
+      custom::lockfree_queue<int> q;
+      // exercise
+      q.push_back(11);
+      q.push_back(26);
+      q.push_back(31);
+      // verify
+      //    dummy    pHead             pTail
+      //    +----+   +----+   +----+   +----+
+      //    |    | - | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+   +----+
+      assertStandardFixture(q);
+   }  // teardown
+
+   // nothing to pop
+   void test_popfront_empty()
+   {  // setup
+      custom::lockfree_queue<int> q;
+      int data = 99;
+      // exercise
+      bool popped = q.pop_front(data);
+      // verify
+      assertUnit(popped == false);
+      assertUnit(data == 99);
+      assertUnit(q.pTail.load() == q.pHead.load());
+   }  // teardown
+
+   // the first node becomes the dummy
+   void test_popfront_standard()
+   {  // setup
+      custom::lockfree_queue<int> q;
+      q.push_back(99);
+      q.push_back(11);
+      q.push_back(26);
+      q.push_back(31);
+      auto pFirst = q.pHead.load()->pNext.load();
+      int data = 0;
+      // exercise
+      bool popped = q.pop_front(data);
+      // verify
+      assertUnit(popped);
+      assertUnit(data == 99);
+      assertUnit(q.pHead.load() == pFirst);
+      assertStandardFixture(q);
+   }  // teardown
+
+   // popping the last item leaves the tail on the new dummy
+   void test_popfront_last()
+   {  // setup
+      custom::lockfree_queue<int> q;
+      q.push_back(99);
+      int data = 0;
+      // exercise
+      bool popped = q.pop_front(data);
+      // verify
+      assertUnit(popped);
+      assertUnit(data == 99);
+      assertUnit(q.pTail.load() == q.pHead.load());
+      assertUnit(q.empty());
+      // the queue still works
+      q.push_back(11);
+      assertUnit(q.pHead.load()->pNext.load() == q.pTail.load());
+      assertUnit(!q.empty());
+   }  // teardown
+
+   // the item is moved out and nothing is leaked
+   void test_popfront_string()
+   {  // setup
+      custom::lockfree_queue<std::string> q;
+      q.push_back(std::string(100, 'x'));
+      q.push_back(std::string(100, 'y'));
+      std::string data;
+      // exercise
+      bool popped = q.pop_front(data);
+      // verify
+      assertUnit(popped);
+      assertUnit(data == std::string(100, 'x'));
+      assertUnit(q.pop_front(data));
+      assertUnit(data == std::string(100, 'y'));
+      assertUnit(q.empty());
+   }  // teardown
+
+   // an item whose move assignment throws when it holds 42
+   struct Fragile
+   {
+      Fragile(int value = 0) : value(value) { }
+      Fragile(Fragile && rhs) : value(rhs.value) { }
+      Fragile & operator = (Fragile && rhs)
+      {
+         if (rhs.value == 42)
+            throw std::string("42");
+         value = rhs.value;
+         return *this;
+      }
+      std::string padding = std::string(100, 'x');   // so a leak is a real allocation
+      int value;
+   };
+
+   // an assignment which throws still takes the item out of the queue
+   void test_popfront_throws()
+   {  // setup
+      custom::lockfree_queue<Fragile> q;
+      q.push_back(Fragile(42));
+      q.push_back(Fragile(26));
+      auto pFirst = q.pHead.load()->pNext.load();
+      Fragile data;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         q.pop_front(data);
+      }
+      catch (const std::string & what)
+      {
+         thrown = (what == "42");
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(q.pHead.load() == pFirst);
+      bool popped = q.pop_front(data);
+      assertUnit(popped);
+      assertUnit(data.value == 26);
+      assertUnit(q.empty());
+   }  // teardown, the sanitizers catch a leak or a double free here
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // every thread pushes and pops and nothing is lost
+   void test_threads_pushPop()
+   {  // setup
+      custom::lockfree_queue<int> q;
+      const int numThreads = 4;
+      const int numItems = 10000;
+      std::vector<std::thread> threads;
+      std::vector<long long> sums(numThreads, 0);
+      // exercise
+      for (int t = 0; t < numThreads; t++)
+         threads.emplace_back([&q, &sums, t, numItems]()
+         {
+            for (int i = 1; i <= numItems; i++)
+            {
+               q.push_back(i);
+               int data;
+               if (q.pop_front(data))
+                  sums[t] += data;
+            }
+         });
+      for (auto & thread : threads)
+         thread.join();
+      long long total = 0;
+      for (auto sum : sums)
+         total += sum;
+      int data;
+      while (q.pop_front(data))
+         total += data;
+      // verify
+      assertUnit(total == (long long)numThreads * numItems * (numItems + 1) / 2);
+      assertUnit(q.empty());
+      assertUnit(q.pTail.load() == q.pHead.load());
+   }  // teardown
+
+   // each producer's items come out in the order it pushed them
+   void test_threads_producersConsumers()
+   {  // setup
+      custom::lockfree_queue<int> q;
+      const int numProducers = 2;
+      const int numConsumers = 2;
+      const int numItems = 10000;
+      std::vector<std::thread> threads;
+      std::vector<std::vector<int>> seen(numConsumers);
+      // exercise
+      for (int t = 0; t < numProducers; t++)
+         threads.emplace_back([&q, t, numItems]()
+         {
+            for (int i = 0; i < numItems; i++)
+               q.push_back(t * numItems + i);
+         });
+      for (int t = 0; t < numConsumers; t++)
+         threads.emplace_back([&q, &seen, t, numItems]()
+         {
+            int data;
+            for (int tries = 0; tries < numItems * 100 && (int)seen[t].size() < numItems; tries++)
+               if (q.pop_front(data))
+                  seen[t].push_back(data);
+         });
+      for (auto & thread : threads)
+         thread.join();
+      // verify
+      bool inOrder = true;
+      size_t total = 0;
+      for (auto & items : seen)
+      {
+         int last[numProducers] = { -1, -1 };
+         for (int item : items)
+         {
+            int producer = item / numItems;
+            inOrder = inOrder && item > last[producer];
+            last[producer] = item;
+         }
+         total += items.size();
+      }
+      int data;
+      while (q.pop_front(data))
+         total++;
+      assertUnit(inOrder);
+      assertUnit(total == (size_t)numProducers * numItems);
+   }  // teardown
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *        dummy   pHead             pTail
+    *       +----+   +----+   +----+   +----+
+    *       |    | - | 11 | - | 26 | - | 31 |
+    *       +----+   +----+   +----+   +----+
+    ****************************************************************/
+   void assertStandardFixtureParameters(custom::lockfree_queue<int>& q, int line, const char* function)
+   {
+      // verify the member variables
+      assertIndirect(q.pHead.load() != nullptr);
+      assertIndirect(q.pTail.load() != nullptr);
+
+      // verify the linked list
+      if (q.pHead.load())
+      {
+         auto p = q.pHead.load();
+         int expected[] = { 11, 26, 31 };
+         for (int i = 0; i < 3; i++)
+         {
+            p = p->pNext.load();
+            assertIndirect(p != nullptr);
+            if (p == nullptr)
+               return;
+            assertIndirect(p->data() == expected[i]);
+         }
+         assertIndirect(p == q.pTail.load());
+         assertIndirect(p->pNext.load() == nullptr);
+      }
+   }
+};
+
+#endif // DEBUG
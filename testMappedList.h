@@ -0,0 +1,419 @@
+/***********************************************************************
+ * Header:
+ *    TEST MAPPED LIST
+ * Summary:
+ *    Unit tests for mapped_list
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "mappedList.h"
+#include "unitTest.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class TestMappedList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_new();
+      test_construct_reopen();
+      test_construct_wrongType();
+      test_construct_notAList();
+      test_construct_notAListLong();
+
+      // Insert
+      test_pushback_standard();
+      test_pushfront_standard();
+      test_insert_middle();
+      test_insert_grow();
+
+      // Remove
+      test_erase_middle();
+      test_erase_reuse();
+      test_clear_standard();
+
+      // Iterator
+      test_iterator_backward();
+
+      report("MappedList");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // a new file gets a header and no items
+   void test_construct_new()
+   {  // setup
+      std::remove(path);
+      {
+         // exercise
+         custom::mapped_list<int> l(path);
+         // verify
+         assertUnit(l.empty());
+         assertUnit(l.header().head == 0);
+         assertUnit(l.header().tail == 0);
+         assertUnit(l.header().bump == l.firstNode);
+         assertUnit(l.header().itemSize == sizeof(int));
+         assertUnit(l.begin() == l.end());
+      }
+      // teardown
+      std::remove(path);
+   }
+
+   // the items are still there after the file is closed and opened again
+   void test_construct_reopen()
+   {  // setup
+      std::remove(path);
+      {
+         custom::mapped_list<int> l(path);
+         l.push_back(11);
+         l.push_back(26);
+         l.push_back(31);
+         l.sync();
+      }
+      {
+         // exercise
+         custom::mapped_list<int> l(path);
+         // verify
+         assertStandardFixture(l);
+      }
+      // teardown
+      std::remove(path);
+   }
+
+   // a file holding another type is refused
+   void test_construct_wrongType()
+   {  // setup
+      std::remove(path);
+      {
+         custom::mapped_list<double> l(path);
+         l.push_back(1.5);
+      }
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::mapped_list<int> l(path);
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      // teardown
+      std::remove(path);
+   }
+
+   // a file shorter than the header is refused and left alone
+   void test_construct_notAList()
+   {  // setup
+      std::remove(path);
+      std::string text("not a list, just text");
+      writeFile(text);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::mapped_list<int> l(path);
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(readFile() == text);
+      // teardown
+      std::remove(path);
+   }
+
+   // a file longer than the header, without the magic, is also left alone
+   void test_construct_notAListLong()
+   {  // setup
+      std::remove(path);
+      std::string text;
+      for (int i = 0; i < 400; i++)
+         text += "some text ";
+      writeFile(text);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::mapped_list<int> l(path);
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(readFile() == text);
+      // teardown
+      std::remove(path);
+   }
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // push_back links after the tail
+   void test_pushback_standard()
+   {  // setup
+      std::remove(path);
+      {
+         custom::mapped_list<int> l(path);
+         // exercise
+         l.push_back(11);
+         l.push_back(26);
+         l.push_back(31);
+         // verify
+         //    head              tail
+         //    +----+   +----+   +----+
+         //    | 11 | - | 26 | - | 31 |
+         //    +----+   +----+   +----+
+         assertStandardFixture(l);
+      }
+      // teardown
+      std::remove(path);
+   }
+
+   // push_front links before the head
+   void test_pushfront_standard()
+   {  // setup
+      std::remove(path);
+      {
+         custom::mapped_list<int> l(path);
+         // exercise
+         l.push_front(31);
+         l.push_front(26);
+         l.push_front(11);
+         // verify
+         assertStandardFixture(l);
+      }
+      // teardown
+      std::remove(path);
+   }
+
+   // insert goes before the iterator
+   void test_insert_middle()
+   {  // setup
+      std::remove(path);
+      {
+         custom::mapped_list<int> l(path);
+         l.push_back(11);
+         l.push_back(31);
+         auto it = l.begin();
+         ++it;
+         // exercise
+         auto itNew = l.insert(it, 26);
+         // verify
+         assertUnit(*itNew == 26);
+         assertStandardFixture(l);
+      }
+      // teardown
+      std::remove(path);
+   }
+
+   // the file moves as it grows, and iterators still work
+   void test_insert_grow()
+   {  // setup
+      std::remove(path);
+      {
+         custom::mapped_list<int> l(path);
+         l.push_back(0);
+         auto itFirst = l.begin();
+         size_t sizeBefore = l.file.size();
+         // exercise
+         for (int i = 1; i < 20000; i++)
+            l.push_back(i);
+         // verify
+         assertUnit(l.file.size() > sizeBefore);
+         assertUnit(*itFirst == 0);
+         assertUnit(l.size() == 20000);
+         int expected = 0;
+         for (auto it = l.begin(); it != l.end(); ++it, expected++)
+            if (*it != expected)
+               break;
+         assertUnit(expected == 20000);
+      }
+      // teardown
+      std::remove(path);
+   }
+
+   /***************************************
+    * ERASE and CLEAR
+    ***************************************/
+
+   // the neighbors are linked to each other
+   void test_erase_middle()
+   {  // setup
+      std::remove(path);
+      {
+         custom::mapped_list<int> l(path);
+         l.push_back(11);
+         l.push_back(99);
+         l.push_back(26);
+         l.push_back(31);
+         auto it = l.begin();
+         ++it;
+         // exercise
+         auto itNext = l.erase(it);
+         // verify
+         assertUnit(*itNext == 26);
+         assertStandardFixture(l);
+      }
+      // teardown
+      std::remove(path);
+   }
+
+   // an erased node is used again before the file grows
+   void test_erase_reuse()
+   {  // setup
+      std::remove(path);
+      {
+         custom::mapped_list<int> l(path);
+         l.push_back(99);
+         l.push_back(11);
+         uint64_t offset99 = l.header().head;
+         uint64_t bump = l.header().bump;
+         // exercise
+         l.pop_front();
+         l.push_back(26);
+         // verify
+         assertUnit(l.header().tail == offset99);
+         assertUnit(l.header().bump == bump);
+         assertUnit(l.header().freeList == 0);
+         assertUnit(l.front() == 11);
+         assertUnit(l.back() == 26);
+      }
+      // teardown
+      std::remove(path);
+   }
+
+   // clear keeps every node for reuse
+   void test_clear_standard()
+   {  // setup
+      std::remove(path);
+      {
+         custom::mapped_list<int> l(path);
+         l.push_back(11);
+         l.push_back(26);
+         l.push_back(31);
+         uint64_t bump = l.header().bump;
+         // exercise
+         l.clear();
+         // verify
+         assertUnit(l.empty());
+         assertUnit(l.begin() == l.end());
+         l.push_back(11);
+         l.push_back(26);
+         l.push_back(31);
+         assertUnit(l.header().bump == bump);
+         assertStandardFixture(l);
+      }
+      // teardown
+      std::remove(path);
+   }
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // walking from the back
+   void test_iterator_backward()
+   {  // setup
+      std::remove(path);
+      {
+         custom::mapped_list<int> l(path);
+         l.push_back(11);
+         l.push_back(26);
+         l.push_back(31);
+         std::vector<int> visited;
+         // exercise
+         for (auto it = l.rbegin(); it != l.end(); --it)
+            visited.push_back(*it);
+         // verify
+         assertUnit(visited.size() == 3);
+         if (visited.size() == 3)
+         {
+            assertUnit(visited[0] == 31);
+            assertUnit(visited[1] == 26);
+            assertUnit(visited[2] == 11);
+         }
+      }
+      // teardown
+      std::remove(path);
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *        head              tail
+    *       +----+   +----+   +----+
+    *       | 11 | - | 26 | - | 31 |
+    *       +----+   +----+   +----+
+    ****************************************************************/
+   void assertStandardFixtureParameters(custom::mapped_list<int>& l, int line, const char* function)
+   {
+      // verify the header
+      assertIndirect(l.size() == 3);
+      assertIndirect(l.header().head != 0);
+      assertIndirect(l.header().tail != 0);
+
+      // verify the linked list
+      uint64_t offset = l.header().head;
+      uint64_t prev = 0;
+      int expected[] = { 11, 26, 31 };
+      for (int i = 0; i < 3; i++)
+      {
+         assertIndirect(offset != 0);
+         if (offset == 0)
+            return;
+         assertIndirect(l.node(offset).data == expected[i]);
+         assertIndirect(l.node(offset).prev == prev);
+         prev = offset;
+         offset = l.node(offset).next;
+      }
+      assertIndirect(offset == 0);
+      assertIndirect(prev == l.header().tail);
+   }
+
+   // put exactly these bytes in the file
+   void writeFile(const std::string & text)
+   {
+      FILE * f = std::fopen(path, "wb");
+      std::fwrite(text.data(), 1, text.size(), f);
+      std::fclose(f);
+   }
+
+   // every byte of the file
+   std::string readFile()
+   {
+      std::string text;
+      FILE * f = std::fopen(path, "rb");
+      if (f == nullptr)
+         return text;
+      char buffer[256];
+      size_t num;
+      while ((num = std::fread(buffer, 1, sizeof(buffer), f)) > 0)
+         text.append(buffer, num);
+      std::fclose(f);
+      return text;
+   }
+
+   const char * path = "testMappedList.tmp";
+};
+
+#endif // DEBUG
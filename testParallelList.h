@@ -0,0 +1,562 @@
+/***********************************************************************
+ * Header:
+ *    TEST PARALLEL LIST
+ * Summary:
+ *    Unit tests for the parallel list algorithms
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "parallelList.h"
+#include "unitTest.h"
+
+#include <atomic>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class TestParallelList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Thread Pool
+      test_pool_run();
+      test_pool_nested();
+
+      // Chunk Index
+      test_chunkIndex_empty();
+      test_chunkIndex_standard();
+      test_chunkIndex_default();
+
+      // For Each
+      test_forEach_empty();
+      test_forEach_standard();
+      test_forEach_throws();
+
+      // Transform Reduce
+      test_transformReduce_empty();
+      test_transformReduce_sum();
+      test_transformReduce_order();
+
+      // Copy
+      test_copy_empty();
+      test_copy_small();
+      test_copy_standard();
+      test_copy_throws();
+
+      // Sort
+      test_sort_small();
+      test_sort_pieces();
+      test_sort_stable();
+      test_sort_throws();
+
+      // Ingest
+      test_ingest_empty();
+      test_ingest_chunks();
+      test_ingest_stream();
+      test_ingest_throws();
+
+      report("ParallelList");
+   }
+
+   /***************************************
+    * THREAD POOL
+    ***************************************/
+
+   // every worker and the caller run the job once
+   void test_pool_run()
+   {  // setup
+      custom::parallel::threadPool pool(4);
+      std::atomic<int> count(0);
+      // exercise
+      pool.run([&count]() { count++; });
+      pool.run([&count]() { count++; });
+      // verify
+      assertUnit(pool.size() == 4);
+      assertUnit(count == 8);
+   }  // teardown
+
+   // a job started from inside a job runs on that thread alone
+   void test_pool_nested()
+   {  // setup
+      custom::parallel::threadPool pool(2);
+      std::atomic<int> outer(0);
+      std::atomic<int> inner(0);
+      // exercise
+      pool.run([&]()
+      {
+         outer++;
+         pool.run([&inner]() { inner++; });
+      });
+      // verify
+      assertUnit(outer == 2);
+      assertUnit(inner == 2);
+   }  // teardown
+
+   /***************************************
+    * CHUNK INDEX
+    ***************************************/
+
+   // no items, no chunks
+   void test_chunkIndex_empty()
+   {  // setup
+      custom::list<int> l;
+      // exercise
+      custom::parallel::chunk_index<int> index(l, 3);
+      // verify
+      assertUnit(index.size() == 0);
+   }  // teardown
+
+   // every third node starts a chunk
+   void test_chunkIndex_standard()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 10; i++)
+         l.push_back(i);
+      // exercise
+      custom::parallel::chunk_index<int> index(l, 3);
+      // verify
+      //    +---+---+---+   +---+---+---+   +---+---+---+   +---+
+      //    | 0 | 1 | 2 | - | 3 | 4 | 5 | - | 6 | 7 | 8 | - | 9 |
+      //    +---+---+---+   +---+---+---+   +---+---+---+   +---+
+      assertUnit(index.size() == 4);
+      if (index.size() == 4)
+      {
+         assertUnit(*index.begin(0) == 0);
+         assertUnit(*index.begin(1) == 3);
+         assertUnit(*index.begin(2) == 6);
+         assertUnit(*index.begin(3) == 9);
+         assertUnit(index.end(0) == index.begin(1));
+         assertUnit(index.end(3) == l.end());
+      }
+   }  // teardown
+
+   // small lists are not split finer than minChunk
+   void test_chunkIndex_default()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 100; i++)
+         l.push_back(i);
+      // exercise
+      custom::parallel::chunk_index<int> index(l);
+      // verify
+      assertUnit(index.size() == 1);
+      if (index.size() == 1)
+      {
+         assertUnit(index.begin(0) == l.begin());
+         assertUnit(index.end(0) == l.end());
+      }
+   }  // teardown
+
+   /***************************************
+    * FOR EACH
+    ***************************************/
+
+   // f is never called
+   void test_forEach_empty()
+   {  // setup
+      custom::list<int> l;
+      int calls = 0;
+      // exercise
+      custom::parallel::for_each(l, [&calls](int &) { calls++; });
+      // verify
+      assertUnit(calls == 0);
+   }  // teardown
+
+   // every item is visited exactly once
+   void test_forEach_standard()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 10000; i++)
+         l.push_back(i);
+      custom::parallel::chunk_index<int> index(l, 97);
+      std::atomic<long long> sum(0);
+      // exercise
+      custom::parallel::for_each(index, [&sum](int & value) { sum += value; value++; });
+      // verify
+      assertUnit(sum == 9999LL * 10000 / 2);
+      assertUnit(l.front() == 1);
+      assertUnit(l.back() == 10000);
+   }  // teardown
+
+   // the first exception comes back to the caller
+   void test_forEach_throws()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 100; i++)
+         l.push_back(i);
+      custom::parallel::chunk_index<int> index(l, 10);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::parallel::for_each(index, [](int & value)
+         {
+            if (value == 42)
+               throw std::string("42");
+         });
+      }
+      catch (const std::string & what)
+      {
+         thrown = (what == "42");
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   /***************************************
+    * TRANSFORM REDUCE
+    ***************************************/
+
+   // nothing to combine
+   void test_transformReduce_empty()
+   {  // setup
+      custom::list<int> l;
+      // exercise
+      int sum = custom::parallel::transform_reduce(l, 99,
+         [](int a, int b) { return a + b; },
+         [](int & value) { return value; });
+      // verify
+      assertUnit(sum == 99);
+   }  // teardown
+
+   // the sum of squares
+   void test_transformReduce_sum()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 1; i <= 1000; i++)
+         l.push_back(i);
+      custom::parallel::chunk_index<int> index(l, 64);
+      // exercise
+      long long sum = custom::parallel::transform_reduce(index, 0LL,
+         [](long long a, long long b) { return a + b; },
+         [](int & value) { return (long long)value * value; });
+      // verify
+      assertUnit(sum == 1000LL * 1001 * 2001 / 6);
+   }  // teardown
+
+   // the chunks are combined in list order
+   void test_transformReduce_order()
+   {  // setup
+      custom::list<char> l;
+      for (char c = 'a'; c <= 'z'; c++)
+         l.push_back(c);
+      custom::parallel::chunk_index<char> index(l, 4);
+      // exercise
+      std::string word = custom::parallel::transform_reduce(index, std::string(">"),
+         [](const std::string & a, const std::string & b) { return a + b; },
+         [](char & c) { return std::string(1, c); });
+      // verify
+      assertUnit(word == ">abcdefghijklmnopqrstuvwxyz");
+   }  // teardown
+
+   /***************************************
+    * COPY
+    ***************************************/
+
+   // copying nothing empties the destination
+   void test_copy_empty()
+   {  // setup
+      custom::list<int> src;
+      custom::list<int> dst;
+      dst.push_back(99);
+      custom::parallel::chunk_index<int> index(src, 3);
+      // exercise
+      custom::parallel::copy(index, dst);
+      // verify
+      assertUnit(dst.size() == 0);
+      assertUnit(dst.pHead == nullptr);
+      assertUnit(dst.pTail == nullptr);
+   }  // teardown
+
+   // a list too small to split is copied the usual way
+   void test_copy_small()
+   {  // setup
+      custom::list<int> src;
+      for (int i = 0; i < 10; i++)
+         src.push_back(i);
+      custom::list<int> dst;
+      // exercise
+      custom::parallel::copy(src, dst);
+      // verify
+      assertUnit(dst.size() == 10);
+      assertUnit(dst.front() == 0);
+      assertUnit(dst.back() == 9);
+      assertUnit(src.size() == 10);
+   }  // teardown
+
+   // the chunks are copied and stitched back together in order
+   void test_copy_standard()
+   {  // setup
+      custom::list<int> src;
+      for (int i = 0; i < 10; i++)
+         src.push_back(i);
+      custom::list<int> dst;
+      dst.push_back(99);
+      dst.push_back(98);
+      custom::parallel::chunk_index<int> index(src, 3);
+      // exercise
+      custom::parallel::copy(index, dst);
+      // verify
+      //    +---+---+---+   +---+---+---+   +---+---+---+   +---+
+      //    | 0 | 1 | 2 | - | 3 | 4 | 5 | - | 6 | 7 | 8 | - | 9 |
+      //    +---+---+---+   +---+---+---+   +---+---+---+   +---+
+      assertUnit(dst.size() == 10);
+      assertUnit(dst.pHead != nullptr);
+      assertUnit(dst.pTail != nullptr);
+      if (dst.pHead)
+         assertUnit(dst.pHead->pPrev == nullptr);
+      int expected = 0;
+      auto pSrc = src.pHead;
+      for (auto p = dst.pHead; p; p = p->pNext, pSrc = pSrc->pNext, expected++)
+      {
+         assertUnit(p->data == expected);
+         assertUnit(p != pSrc);
+         if (p->pNext)
+            assertUnit(p->pNext->pPrev == p);
+         else
+            assertUnit(p == dst.pTail);
+      }
+      assertUnit(expected == 10);
+      assertUnit(src.size() == 10);
+   }  // teardown
+
+   // an item whose copy throws on one value
+   struct Fragile
+   {
+      Fragile(int value) : value(value) { }
+      Fragile(const Fragile & rhs) : value(rhs.value)
+      {
+         if (value == 42)
+            throw std::string("42");
+      }
+      std::string padding = std::string(100, 'x');   // so a leak is a real allocation
+      int value;
+   };
+
+   // a copy which throws leaves the destination alone
+   void test_copy_throws()
+   {  // setup
+      custom::list<Fragile> src;
+      for (int i = 0; i < 100; i++)
+         src.push_back(Fragile(i < 42 ? i : i + 1));
+      src.pTail->data.value = 42;
+      custom::list<Fragile> dst;
+      dst.push_back(Fragile(7));
+      custom::parallel::chunk_index<Fragile> index(src, 10);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::parallel::copy(index, dst);
+      }
+      catch (const std::string & what)
+      {
+         thrown = (what == "42");
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(dst.size() == 1);
+      assertUnit(dst.front().value == 7);
+   }  // teardown
+
+   /***************************************
+    * SORT
+    ***************************************/
+
+   // a list too small to split is sorted the usual way
+   void test_sort_small()
+   {  // setup
+      custom::list<int> l;
+      l.push_back(31);
+      l.push_back(11);
+      l.push_back(26);
+      // exercise
+      custom::parallel::sort(l);
+      // verify
+      assertUnit(l.front() == 11);
+      assertUnit(l.back() == 31);
+      assertUnit(l.pHead->pNext->data == 26);
+   }  // teardown
+
+   // uneven pieces are sorted and merged, with links fixed both ways
+   void test_sort_pieces()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 1000; i++)
+         l.push_back((i * 7919) % 1000);
+      // exercise
+      custom::parallel::sort(l, std::less<int>(), 7);
+      // verify
+      int expected = 0;
+      decltype(l.pHead) pPrev = nullptr;
+      for (auto p = l.pHead; p; p = p->pNext, expected++)
+      {
+         assertUnit(p->data == expected);
+         assertUnit(p->pPrev == pPrev);
+         pPrev = p;
+      }
+      assertUnit(expected == 1000);
+      assertUnit(l.pTail == pPrev);
+      assertUnit(l.size() == 1000);
+   }  // teardown
+
+   // equal items keep their order across pieces
+   void test_sort_stable()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 500; i++)
+         l.push_back((i % 3) * 1000 + i);
+      // exercise
+      custom::parallel::sort(l, [](int lhs, int rhs) { return lhs / 1000 < rhs / 1000; }, 4);
+      // verify
+      int previous = -1;
+      bool inOrder = true;
+      for (auto it = l.begin(); it != l.end(); ++it)
+      {
+         inOrder = inOrder && *it > previous;
+         previous = *it;
+      }
+      assertUnit(inOrder);
+      assertUnit(l.size() == 500);
+   }  // teardown
+
+   // a comparison which throws on one thread leaves every item in
+   // the list, linked both ways
+   void test_sort_throws()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 1000; i++)
+         l.push_back((i * 7919) % 1000);
+      std::atomic<int> calls(0);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::parallel::sort(l, [&calls](int lhs, int rhs)
+         {
+            if (++calls == 3000)
+               throw "ERROR: unable to compare";
+            return lhs < rhs;
+         }, 4);
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      std::vector<bool> seen(1000, false);
+      bool valid = true;
+      size_t num = 0;
+      decltype(l.pHead) pPrev = nullptr;
+      for (auto p = l.pHead; p && num <= 1000; pPrev = p, p = p->pNext, num++)
+      {
+         valid = valid && p->pPrev == pPrev && !seen[p->data];
+         seen[p->data] = true;
+      }
+      assertUnit(valid);
+      assertUnit(num == 1000);
+      assertUnit(l.pTail == pPrev);
+      assertUnit(l.size() == 1000);
+   }  // teardown
+
+   /***************************************
+    * INGEST
+    ***************************************/
+
+   // nothing to read leaves the list alone
+   void test_ingest_empty()
+   {  // setup
+      custom::list<int> l;
+      l.push_back(99);
+      int calls = 0;
+      // exercise
+      custom::parallel::ingest(l, [&calls](std::vector<int> &, size_t)
+      {
+         calls++;
+         return false;
+      }, 8);
+      // verify
+      assertUnit(calls == 1);
+      assertUnit(l.size() == 1);
+      assertUnit(l.front() == 99);
+   }  // teardown
+
+   // many chunks come out in order, after what was there
+   void test_ingest_chunks()
+   {  // setup
+      custom::list<int> l;
+      l.push_back(-1);
+      std::vector<int> v;
+      for (int i = 0; i < 1000; i++)
+         v.push_back(i);
+      // exercise
+      custom::parallel::ingest(l, v.begin(), v.end(), 7);
+      // verify
+      assertUnit(l.size() == 1001);
+      int expected = -1;
+      decltype(l.pHead) pPrev = nullptr;
+      for (auto p = l.pHead; p; pPrev = p, p = p->pNext, expected++)
+         if (p->data != expected || p->pPrev != pPrev)
+            break;
+      assertUnit(expected == 1000);
+      assertUnit(l.pTail == pPrev);
+   }  // teardown
+
+   // text is parsed on one thread while the nodes are built on another
+   void test_ingest_stream()
+   {  // setup
+      std::stringstream text("11 26 31");
+      custom::list<int> l;
+      // exercise
+      custom::parallel::ingest(l, std::istream_iterator<int>(text),
+                               std::istream_iterator<int>(), 2);
+      // verify
+      assertUnit(l.size() == 3);
+      if (l.size() == 3)
+      {
+         assertUnit(l.pHead->data == 11);
+         assertUnit(l.pHead->pNext->data == 26);
+         assertUnit(l.pTail->data == 31);
+      }
+   }  // teardown
+
+   // a source which throws leaves the list alone
+   void test_ingest_throws()
+   {  // setup
+      custom::list<std::string> l;
+      l.push_back("ninety nine");
+      int calls = 0;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::parallel::ingest(l, [&calls](std::vector<std::string> & chunk, size_t max)
+         {
+            if (++calls == 5)
+               throw std::string("5");
+            chunk.assign(max, std::string(100, 'x'));
+            return true;
+         }, 3);
+      }
+      catch (const std::string & what)
+      {
+         thrown = (what == "5");
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(l.size() == 1);
+      assertUnit(l.front() == "ninety nine");
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,335 @@
+/***********************************************************************
+ * Header:
+ *    TEST RCU LIST
+ * Summary:
+ *    Unit tests for rcu_list
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "rcuList.h"
+#include "unitTest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+class TestRcuList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Write
+      test_pushback_standard();
+      test_pushfront_standard();
+      test_remove_middle();
+      test_remove_ends();
+      test_clear_standard();
+
+      // Reclaim
+      test_reclaim_noReaders();
+      test_reclaim_reader();
+
+      // Read
+      test_forEach_standard();
+      test_contains_standard();
+
+      // Threads
+      test_threads_readWrite();
+
+      report("RcuList");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // a new list is empty
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::rcu_list<int> l;
+      // verify
+      assertUnit(l.pHead.load() == nullptr);
+      assertUnit(l.pTail == nullptr);
+      assertUnit(l.retired.empty());
+      assertUnit(l.size() == 0);
+      assertUnit(l.empty());
+   }  // teardown
+
+   /***************************************
+    * PUSH BACK and PUSH FRONT
+    ***************************************/
+
+   // push_back links after the tail
+   void test_pushback_standard()
+   {  // setup
+      custom::rcu_list<int> l;
+      // exercise
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      // verify
+      //    pHead             pTail
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      assertStandardFixture(l);
+   }  // teardown
+
+   // push_front links before the head
+   void test_pushfront_standard()
+   {  // setup
+      custom::rcu_list<int> l;
+      // exercise
+      l.push_front(31);
+      l.push_front(26);
+      l.push_front(11);
+      // verify
+      assertStandardFixture(l);
+   }  // teardown
+
+   /***************************************
+    * REMOVE and CLEAR
+    ***************************************/
+
+   // the removed node keeps its pNext for readers standing on it
+   void test_remove_middle()
+   {  // setup
+      custom::rcu_list<int> l;
+      l.push_back(11);
+      l.push_back(99);
+      l.push_back(26);
+      l.push_back(31);
+      auto p99 = l.pHead.load()->pNext.load();
+      size_t removed;
+      // exercise
+      {
+         custom::rcu::ReadScope scope;
+         removed = l.remove(99);
+         // verify
+         assertUnit(l.retired.size() == 1);
+         if (l.retired.size() == 1)
+            assertUnit(l.retired[0].p == p99);
+         assertUnit(p99->pNext.load() == l.pHead.load()->pNext.load());
+      }
+      assertUnit(removed == 1);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // removing the first and last moves the head and tail
+   void test_remove_ends()
+   {  // setup
+      custom::rcu_list<int> l;
+      l.push_back(99);
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      l.push_back(99);
+      // exercise
+      size_t removed = l.remove(99);
+      // verify
+      assertUnit(removed == 2);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // clear leaves an empty list
+   void test_clear_standard()
+   {  // setup
+      custom::rcu_list<int> l;
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(l.pHead.load() == nullptr);
+      assertUnit(l.pTail == nullptr);
+      assertUnit(l.empty());
+      // the list still works
+      l.push_back(11);
+      assertUnit(l.pHead.load() == l.pTail);
+   }  // teardown
+
+   /***************************************
+    * RECLAIM
+    ***************************************/
+
+   // with nobody reading, removed nodes are freed right away
+   void test_reclaim_noReaders()
+   {  // setup
+      custom::rcu_list<int> l;
+      l.push_back(11);
+      l.push_back(26);
+      // exercise
+      l.remove(11);
+      // verify
+      assertUnit(l.retired.empty());
+      assertUnit(l.size() == 1);
+   }  // teardown
+
+   // a reader holds off reclaim until it is done
+   void test_reclaim_reader()
+   {  // setup
+      custom::rcu_list<int> l;
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      std::atomic<int> stage(0);
+      std::thread reader([&stage]()
+      {
+         custom::rcu::ReadScope scope;
+         stage = 1;
+         while (stage != 2)
+            std::this_thread::yield();
+      });
+      while (stage != 1)
+         std::this_thread::yield();
+      // exercise
+      l.remove(11);
+      size_t retiredDuring = l.retired.size();
+      stage = 2;
+      reader.join();
+      l.synchronize();
+      // verify
+      assertUnit(retiredDuring == 1);
+      assertUnit(l.retired.empty());
+      assertUnit(l.size() == 2);
+   }  // teardown
+
+   /***************************************
+    * TRAVERSE
+    ***************************************/
+
+   // for_each sees every item in order
+   void test_forEach_standard()
+   {  // setup
+      custom::rcu_list<int> l;
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      std::vector<int> visited;
+      // exercise
+      l.for_each([&visited](const int & value) { visited.push_back(value); });
+      // verify
+      assertUnit(visited.size() == 3);
+      if (visited.size() == 3)
+      {
+         assertUnit(visited[0] == 11);
+         assertUnit(visited[1] == 26);
+         assertUnit(visited[2] == 31);
+      }
+      assertStandardFixture(l);
+   }  // teardown
+
+   // contains and find_if
+   void test_contains_standard()
+   {  // setup
+      custom::rcu_list<int> l;
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      int found = 0;
+      // exercise
+      bool found26 = l.contains(26);
+      bool found99 = l.contains(99);
+      bool foundOver20 = l.find_if([](const int & value) { return value > 20; }, found);
+      // verify
+      assertUnit(found26);
+      assertUnit(!found99);
+      assertUnit(foundOver20);
+      assertUnit(found == 26);
+      assertStandardFixture(l);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // readers always see a well-formed list while a writer churns
+   void test_threads_readWrite()
+   {  // setup
+      custom::rcu_list<int> l;
+      for (int i = 0; i < 100; i++)
+         l.push_back(i);
+      std::atomic<bool> done(false);
+      std::atomic<int> bad(0);
+      std::vector<std::thread> readers;
+      // exercise
+      for (int t = 0; t < 3; t++)
+         readers.emplace_back([&l, &done, &bad]()
+         {
+            while (!done)
+            {
+               // the items 0..99 never move, so they stay in order
+               int last = -1;
+               l.for_each([&last, &bad](const int & value)
+               {
+                  if (value < 100)
+                  {
+                     if (value <= last)
+                        bad++;
+                     last = value;
+                  }
+               });
+            }
+         });
+      for (int i = 0; i < 2000; i++)
+      {
+         l.push_back(1000 + i);
+         l.push_front(1000 + i);
+         l.remove(1000 + i);
+      }
+      done = true;
+      for (auto & reader : readers)
+         reader.join();
+      l.synchronize();
+      // verify
+      assertUnit(bad == 0);
+      assertUnit(l.size() == 100);
+      assertUnit(l.retired.empty());
+   }  // teardown
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *        pHead             pTail
+    *       +----+   +----+   +----+
+    *       | 11 | - | 26 | - | 31 |
+    *       +----+   +----+   +----+
+    ****************************************************************/
+   void assertStandardFixtureParameters(custom::rcu_list<int>& l, int line, const char* function)
+   {
+      // verify the member variables
+      assertIndirect(l.size() == 3);
+      assertIndirect(l.pHead.load() != nullptr);
+      assertIndirect(l.pTail != nullptr);
+
+      // verify the linked list
+      auto p = l.pHead.load();
+      decltype(p) pPrev = nullptr;
+      int expected[] = { 11, 26, 31 };
+      for (int i = 0; i < 3; i++)
+      {
+         assertIndirect(p != nullptr);
+         if (p == nullptr)
+            return;
+         assertIndirect(p->data == expected[i]);
+         assertIndirect(p->pPrev == pPrev);
+         pPrev = p;
+         p = p->pNext.load();
+      }
+      assertIndirect(p == nullptr);
+      assertIndirect(pPrev == l.pTail);
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,271 @@
+/***********************************************************************
+ * Header:
+ *    TEST SHARDED LIST
+ * Summary:
+ *    Unit tests for sharded_list
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "shardedList.h"
+#include "unitTest.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestShardedList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_shards();
+
+      // Insert
+      test_pushback_sameThread();
+      test_pushback_string();
+
+      // Remove
+      test_drain_empty();
+      test_drain_standard();
+      test_drain_append();
+      test_clear_standard();
+
+      // Traverse
+      test_forEach_standard();
+
+      // Threads
+      test_threads_push();
+
+      report("ShardedList");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // at least one shard, and all of them empty
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::sharded_list<int> l;
+      // verify
+      assertUnit(l.shards() >= 1);
+      assertUnit(l.vShards.size() == l.shards());
+      assertUnit(l.empty());
+   }  // teardown
+
+   // the shards sit on separate cache lines
+   void test_construct_shards()
+   {  // setup
+      // exercise
+      custom::sharded_list<int> l(4);
+      // verify
+      assertUnit(l.shards() == 4);
+      if (l.shards() == 4)
+      {
+         const char * p0 = reinterpret_cast<const char *>(&l.vShards[0]);
+         const char * p1 = reinterpret_cast<const char *>(&l.vShards[1]);
+         assertUnit(p1 - p0 >= 128);
+      }
+      for (auto & shard : l.vShards)
+         assertUnit(shard.items.empty());
+   }  // teardown
+
+   /***************************************
+    * PUSH BACK
+    ***************************************/
+
+   // one thread always pushes to the same shard, in order
+   void test_pushback_sameThread()
+   {  // setup
+      custom::sharded_list<int> l(4);
+      // exercise
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+      // verify
+      int numUsed = 0;
+      for (auto & shard : l.vShards)
+         if (!shard.items.empty())
+         {
+            numUsed++;
+            assertUnit(shard.items.size() == 3);
+            assertUnit(shard.items.front() == 11);
+            assertUnit(shard.items.back() == 31);
+         }
+      assertUnit(numUsed == 1);
+      assertUnit(l.size() == 3);
+   }  // teardown
+
+   // the item is moved in
+   void test_pushback_string()
+   {  // setup
+      custom::sharded_list<std::string> l(2);
+      std::string s(100, 'x');
+      // exercise
+      l.push_back(std::move(s));
+      l.push_back(std::string(100, 'y'));
+      // verify
+      custom::list<std::string> all = l.drain();
+      assertUnit(all.size() == 2);
+      if (all.size() == 2)
+      {
+         assertUnit(all.front() == std::string(100, 'x'));
+         assertUnit(all.back() == std::string(100, 'y'));
+      }
+   }  // teardown
+
+   /***************************************
+    * DRAIN and CLEAR
+    ***************************************/
+
+   // nothing to drain
+   void test_drain_empty()
+   {  // setup
+      custom::sharded_list<int> l(3);
+      // exercise
+      custom::list<int> all = l.drain();
+      // verify
+      assertUnit(all.empty());
+      assertUnit(all.pHead == nullptr);
+      assertUnit(all.pTail == nullptr);
+   }  // teardown
+
+   // every shard ends up in one list, shard by shard, and the nodes are not copied
+   void test_drain_standard()
+   {  // setup
+      custom::sharded_list<int> l(3);
+      l.vShards[0].items.push_back(11);
+      l.vShards[2].items.push_back(26);
+      l.vShards[2].items.push_back(31);
+      auto p11 = l.vShards[0].items.pHead;
+      auto p31 = l.vShards[2].items.pTail;
+      // exercise
+      custom::list<int> all = l.drain();
+      // verify
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      assertUnit(all.size() == 3);
+      assertUnit(all.pHead == p11);
+      assertUnit(all.pTail == p31);
+      assertUnit(all.front() == 11);
+      assertUnit(all.back() == 31);
+      if (all.pHead)
+         assertUnit(all.pHead->pNext->pNext == all.pTail);
+      if (all.pTail)
+         assertUnit(all.pTail->pPrev->pPrev == all.pHead);
+      for (auto & shard : l.vShards)
+      {
+         assertUnit(shard.items.pHead == nullptr);
+         assertUnit(shard.items.size() == 0);
+      }
+      assertUnit(l.empty());
+   }  // teardown
+
+   // drain adds onto what is already there
+   void test_drain_append()
+   {  // setup
+      custom::sharded_list<int> l(2);
+      l.vShards[1].items.push_back(26);
+      l.vShards[1].items.push_back(31);
+      custom::list<int> all;
+      all.push_back(11);
+      // exercise
+      l.drain(all);
+      // verify
+      assertUnit(all.size() == 3);
+      assertUnit(all.front() == 11);
+      assertUnit(all.back() == 31);
+      assertUnit(l.empty());
+   }  // teardown
+
+   // clear throws everything away
+   void test_clear_standard()
+   {  // setup
+      custom::sharded_list<std::string> l(2);
+      l.vShards[0].items.push_back(std::string(100, 'a'));
+      l.vShards[1].items.push_back(std::string(100, 'b'));
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(l.empty());
+      // the list still works
+      l.push_back(std::string("c"));
+      assertUnit(l.size() == 1);
+   }  // teardown
+
+   /***************************************
+    * FOR EACH
+    ***************************************/
+
+   // every item in every shard is visited
+   void test_forEach_standard()
+   {  // setup
+      custom::sharded_list<int> l(3);
+      l.vShards[0].items.push_back(11);
+      l.vShards[1].items.push_back(26);
+      l.vShards[2].items.push_back(31);
+      std::vector<int> visited;
+      // exercise
+      l.for_each([&visited](int & value) { visited.push_back(value); });
+      // verify
+      assertUnit(visited.size() == 3);
+      if (visited.size() == 3)
+      {
+         assertUnit(visited[0] == 11);
+         assertUnit(visited[1] == 26);
+         assertUnit(visited[2] == 31);
+      }
+      assertUnit(l.size() == 3);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // many threads push while another drains, and nothing is lost or reordered
+   void test_threads_push()
+   {  // setup
+      custom::sharded_list<int> l(3);
+      const int numThreads = 4;
+      const int numItems = 10000;
+      std::vector<std::thread> threads;
+      custom::list<int> all;
+      // exercise
+      for (int t = 0; t < numThreads; t++)
+         threads.emplace_back([&l, t, numItems]()
+         {
+            for (int i = 0; i < numItems; i++)
+               l.push_back(t * numItems + i);
+         });
+      for (int i = 0; i < 100; i++)
+         l.drain(all);
+      for (auto & thread : threads)
+         thread.join();
+      l.drain(all);
+      // verify
+      std::vector<int> last(numThreads, -1);
+      bool inOrder = true;
+      for (auto it = all.begin(); it != all.end(); ++it)
+      {
+         int producer = *it / numItems;
+         inOrder = inOrder && *it > last[producer];
+         last[producer] = *it;
+      }
+      assertUnit(inOrder);
+      assertUnit(all.size() == (size_t)numThreads * numItems);
+      assertUnit(l.empty());
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,391 @@
+/***********************************************************************
+ * Header:
+ *    TEST SORTED LIST
+ * Summary:
+ *    Unit tests for sorted_list
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "sortedList.h"
+#include "unitTest.h"
+
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+class TestSortedList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+
+      // Insert
+      test_insert_order();
+      test_insert_duplicates();
+      test_insert_compare();
+
+      // Search
+      test_find_standard();
+      test_find_missing();
+      test_lowerBound_standard();
+      test_upperBound_standard();
+
+      // Remove
+      test_erase_iterator();
+      test_erase_key();
+      test_clear_standard();
+
+      // Iterator
+      test_iterator_backward();
+
+      // Against std::multiset
+      test_random_model();
+
+      report("SortedList");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // nothing on any level
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::sorted_list<int> l;
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.size() == 0);
+      assertUnit(l.numLevels == 1);
+      assertUnit(l.pTail == nullptr);
+      bool allEmpty = true;
+      for (int level = 0; level < l.maxLevels; level++)
+         allEmpty = allEmpty && l.pHeads[level] == nullptr;
+      assertUnit(allEmpty);
+      assertUnit(l.begin() == l.end());
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // the items come out in order whatever order they went in
+   void test_insert_order()
+   {  // setup
+      custom::sorted_list<int> l;
+      // exercise
+      l.insert(26);
+      l.insert(31);
+      l.insert(11);
+      // verify
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      assertStandardFixture(l);
+   }  // teardown
+
+   // equal keys stay in the order they were inserted
+   void test_insert_duplicates()
+   {  // setup
+      custom::sorted_list<std::string, ShortFirst> l;
+      // exercise
+      l.insert(std::string("bb"));
+      l.insert(std::string("a"));
+      l.insert(std::string("cc"));
+      l.insert(std::string("dd"));
+      // verify
+      std::vector<std::string> items = toVector(l);
+      assertUnit(items.size() == 4);
+      if (items.size() == 4)
+      {
+         assertUnit(items[0] == "a");
+         assertUnit(items[1] == "bb");
+         assertUnit(items[2] == "cc");
+         assertUnit(items[3] == "dd");
+      }
+      assertLevelsParameters(l, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // the comparison decides the order
+   void test_insert_compare()
+   {  // setup
+      custom::sorted_list<int, std::greater<int>> l;
+      // exercise
+      l.insert(11);
+      l.insert(31);
+      l.insert(26);
+      // verify
+      assertUnit(l.front() == 31);
+      assertUnit(l.back() == 11);
+      assertUnit(l.find(26) != l.end());
+   }  // teardown
+
+   /***************************************
+    * FIND, LOWER BOUND and UPPER BOUND
+    ***************************************/
+
+   // every key is found, and the iterator points at it
+   void test_find_standard()
+   {  // setup
+      custom::sorted_list<int> l;
+      for (int i = 0; i < 2000; i++)
+         l.insert((i * 7919) % 2000);
+      // exercise
+      bool allFound = true;
+      for (int key = 0; key < 2000; key++)
+      {
+         auto it = l.find(key);
+         allFound = allFound && it != l.end() && *it == key;
+      }
+      // verify
+      assertUnit(allFound);
+      assertUnit(l.numLevels > 1);
+      assertLevelsParameters(l, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // a missing key gives end()
+   void test_find_missing()
+   {  // setup
+      custom::sorted_list<int> l;
+      l.insert(11);
+      l.insert(31);
+      // exercise
+      auto it = l.find(26);
+      // verify
+      assertUnit(it == l.end());
+      assertUnit(!l.contains(26));
+      assertUnit(l.contains(31));
+      assertUnit(custom::sorted_list<int>().find(26) == l.end());
+   }  // teardown
+
+   // the first item not before the key
+   void test_lowerBound_standard()
+   {  // setup
+      custom::sorted_list<int> l;
+      l.insert(11);
+      l.insert(26);
+      l.insert(26);
+      l.insert(31);
+      // exercise
+      auto itBetween = l.lower_bound(20);
+      auto itEqual = l.lower_bound(26);
+      auto itPast = l.lower_bound(32);
+      // verify
+      assertUnit(*itBetween == 26);
+      assertUnit(itEqual == itBetween);
+      assertUnit(itPast == l.end());
+      assertUnit(l.lower_bound(0) == l.begin());
+   }  // teardown
+
+   // the first item after the key
+   void test_upperBound_standard()
+   {  // setup
+      custom::sorted_list<int> l;
+      l.insert(11);
+      l.insert(26);
+      l.insert(26);
+      l.insert(31);
+      // exercise
+      auto it = l.upper_bound(26);
+      // verify
+      assertUnit(*it == 31);
+      assertUnit(l.upper_bound(31) == l.end());
+   }  // teardown
+
+   /***************************************
+    * ERASE and CLEAR
+    ***************************************/
+
+   // the neighbors are linked to each other on every level
+   void test_erase_iterator()
+   {  // setup
+      custom::sorted_list<int> l;
+      l.insert(11);
+      l.insert(26);
+      l.insert(99);
+      l.insert(31);
+      // exercise
+      auto it = l.erase(l.find(99));
+      // verify
+      assertUnit(it == l.end());
+      it = l.erase(l.find(26));
+      assertUnit(*it == 31);
+      l.insert(26);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // every equal item goes, and nothing else
+   void test_erase_key()
+   {  // setup
+      custom::sorted_list<int> l;
+      l.insert(11);
+      l.insert(26);
+      l.insert(99);
+      l.insert(99);
+      l.insert(31);
+      l.insert(99);
+      // exercise
+      size_t num = l.erase(99);
+      // verify
+      assertUnit(num == 3);
+      assertUnit(l.erase(50) == 0);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // clear leaves every level empty
+   void test_clear_standard()
+   {  // setup
+      custom::sorted_list<std::string> l;
+      for (int i = 0; i < 100; i++)
+         l.insert(std::string(40, (char)('a' + i % 26)));
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.numLevels == 1);
+      assertUnit(l.pHeads[1] == nullptr);
+      assertUnit(l.begin() == l.end());
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // walking from the back
+   void test_iterator_backward()
+   {  // setup
+      custom::sorted_list<int> l;
+      l.insert(31);
+      l.insert(11);
+      l.insert(26);
+      std::vector<int> visited;
+      // exercise
+      for (auto it = l.rbegin(); it != l.end(); --it)
+         visited.push_back(*it);
+      // verify
+      assertUnit(visited.size() == 3);
+      if (visited.size() == 3)
+      {
+         assertUnit(visited[0] == 31);
+         assertUnit(visited[1] == 26);
+         assertUnit(visited[2] == 11);
+      }
+   }  // teardown
+
+   /***************************************
+    * RANDOM
+    ***************************************/
+
+   // a long run of inserts and erases matches a multiset doing the same
+   void test_random_model()
+   {  // setup
+      custom::sorted_list<int> l;
+      std::multiset<int> model;
+      unsigned int seed = 12345;
+      // exercise
+      for (int i = 0; i < 5000; i++)
+      {
+         seed = seed * 1103515245 + 12345;
+         int key = (int)((seed >> 8) % 500);
+         if ((seed >> 4) % 3 != 0)
+         {
+            l.insert(key);
+            model.insert(key);
+         }
+         else
+            assertUnit(l.erase(key) == model.erase(key));
+      }
+      // verify
+      assertUnit(l.size() == model.size());
+      assertUnit(toVector(l) == std::vector<int>(model.begin(), model.end()));
+      assertLevelsParameters(l, __LINE__, __FUNCTION__);
+   }  // teardown
+
+   // orders strings by length only, so some are equal
+   struct ShortFirst
+   {
+      bool operator () (const std::string & lhs, const std::string & rhs) const
+      {
+         return lhs.size() < rhs.size();
+      }
+   };
+
+   // the items in level 0 order
+   template <typename T, class Compare>
+   std::vector<T> toVector(const custom::sorted_list<T, Compare> & l)
+   {
+      std::vector<T> items;
+      for (auto it = l.begin(); it != l.end(); ++it)
+         items.push_back(*it);
+      return items;
+   }
+
+   /****************************************************************
+    * Verify the levels
+    * Level 0 is linked both ways, every higher level visits the
+    * nodes tall enough for it in level 0 order, and no level above
+    * numLevels is in use
+    ****************************************************************/
+   template <typename T, class Compare>
+   void assertLevelsParameters(custom::sorted_list<T, Compare>& l, int line, const char* function)
+   {
+      typedef typename custom::sorted_list<T, Compare>::Node Node;
+      size_t num = 0;
+      Node * pPrev = nullptr;
+      for (Node * p = l.pHeads[0]; p; pPrev = p, p = p->pNext, num++)
+         if (p->pPrev != pPrev)
+            break;
+      assertIndirect(num == l.size());
+      assertIndirect(pPrev == l.pTail);
+
+      bool valid = true;
+      for (int level = 1; level < l.maxLevels; level++)
+      {
+         Node * pLevel = l.pHeads[level];
+         valid = valid && (level < l.numLevels || pLevel == nullptr);
+         for (Node * p = l.pHeads[0]; p; p = p->pNext)
+            if (p->height > level)
+            {
+               valid = valid && p == pLevel;
+               if (pLevel)
+                  pLevel = pLevel->next(level);
+            }
+         valid = valid && pLevel == nullptr;
+      }
+      assertIndirect(valid);
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *       +----+   +----+   +----+
+    *       | 11 | - | 26 | - | 31 |
+    *       +----+   +----+   +----+
+    ****************************************************************/
+   void assertStandardFixtureParameters(custom::sorted_list<int>& l, int line, const char* function)
+   {
+      assertIndirect(l.size() == 3);
+      std::vector<int> items = toVector(l);
+      assertIndirect(items.size() == 3);
+      if (items.size() == 3)
+      {
+         assertIndirect(items[0] == 11);
+         assertIndirect(items[1] == 26);
+         assertIndirect(items[2] == 31);
+      }
+      assertIndirect(l.front() == 11);
+      assertIndirect(l.back() == 31);
+      assertLevelsParameters(l, line, function);
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,327 @@
+/***********************************************************************
+ * Header:
+ *    TEST SPLIT LIST
+ * Summary:
+ *    Unit tests for split_list
+ * Author
+ *    Joel Jossie, Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "splitList.h"
+#include "unitTest.h"
+
+#include <string>
+#include <vector>
+
+class TestSplitList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_copy();
+
+      // Insert
+      test_pushBack_standard();
+      test_pushFront_standard();
+      test_insert_middle();
+      test_pushBack_move();
+
+      // Remove
+      test_erase_middle();
+      test_pop_ends();
+      test_clear_standard();
+
+      // Links only
+      test_reverse_standard();
+      test_reverse_empty();
+      test_splice_middle();
+      test_iteratorAt_standard();
+
+      // Access
+      test_front_empty();
+
+      report("SplitList");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // no nodes
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::split_list<int> l;
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.size() == 0);
+      assertUnit(l.pHead == nullptr);
+      assertUnit(l.pTail == nullptr);
+      assertUnit(l.begin() == l.end());
+   }  // teardown
+
+   // the copy has its own nodes and its own items
+   void test_construct_copy()
+   {  // setup
+      custom::split_list<int> lhs;
+      setupStandardFixture(lhs);
+      // exercise
+      custom::split_list<int> l(lhs);
+      // verify
+      assertStandardFixture(l);
+      assertStandardFixture(lhs);
+      assertUnit(l.pHead != lhs.pHead);
+      assertUnit(l.pHead->pData != lhs.pHead->pData);
+   }  // teardown
+
+   /***************************************
+    * PUSH BACK, PUSH FRONT and INSERT
+    ***************************************/
+
+   // each node points at its own item
+   void test_pushBack_standard()
+   {  // setup
+      custom::split_list<int> l;
+      // exercise
+      l.push_back(26);
+      l.push_back(49);
+      l.push_back(67);
+      // verify
+      //    +----+   +----+   +----+
+      //    | 26 | - | 49 | - | 67 |
+      //    +----+   +----+   +----+
+      assertStandardFixture(l);
+   }  // teardown
+
+   // pushed in the other order
+   void test_pushFront_standard()
+   {  // setup
+      custom::split_list<int> l;
+      // exercise
+      l.push_front(67);
+      l.push_front(49);
+      l.push_front(26);
+      // verify
+      assertStandardFixture(l);
+   }  // teardown
+
+   // inserted before the iterator
+   void test_insert_middle()
+   {  // setup
+      custom::split_list<int> l;
+      l.push_back(26);
+      l.push_back(67);
+      // exercise
+      auto it = l.insert(l.rbegin(), 49);
+      // verify
+      assertUnit(*it == 49);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // a moved string leaves its source behind
+   void test_pushBack_move()
+   {  // setup
+      custom::split_list<std::string> l;
+      std::string s(100, 'x');
+      // exercise
+      l.push_back(std::move(s));
+      // verify
+      assertUnit(l.size() == 1);
+      assertUnit(l.front() == std::string(100, 'x'));
+      assertUnit(s.empty());
+   }  // teardown
+
+   /***************************************
+    * ERASE, POP and CLEAR
+    ***************************************/
+
+   // the neighbors are linked to each other
+   void test_erase_middle()
+   {  // setup
+      custom::split_list<int> l;
+      l.push_back(26);
+      l.push_back(99);
+      l.push_back(49);
+      l.push_back(67);
+      // exercise
+      auto it = l.erase(++l.begin());
+      // verify
+      assertUnit(*it == 49);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // from either end
+   void test_pop_ends()
+   {  // setup
+      custom::split_list<int> l;
+      l.push_back(11);
+      setupStandardFixture(l);
+      l.push_back(99);
+      // exercise
+      l.pop_front();
+      l.pop_back();
+      // verify
+      assertStandardFixture(l);
+   }  // teardown
+
+   // strings are destroyed with their nodes
+   void test_clear_standard()
+   {  // setup
+      custom::split_list<std::string> l;
+      for (int i = 0; i < 1000; i++)
+         l.push_back(std::string(40, (char)('a' + i % 26)));
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.pHead == nullptr);
+      assertUnit(l.pTail == nullptr);
+      l.push_back(std::string("again"));
+      assertUnit(l.front() == "again");
+   }  // teardown
+
+   /***************************************
+    * REVERSE, SPLICE and ITERATOR AT
+    ***************************************/
+
+   // the items stay where they are; only the links turn around
+   void test_reverse_standard()
+   {  // setup
+      custom::split_list<int> l;
+      l.push_back(67);
+      l.push_back(49);
+      l.push_back(26);
+      int * pFirst = &l.front();
+      // exercise
+      l.reverse();
+      // verify
+      assertStandardFixture(l);
+      assertUnit(&l.back() == pFirst);
+   }  // teardown
+
+   // nothing to turn around
+   void test_reverse_empty()
+   {  // setup
+      custom::split_list<int> l;
+      // exercise
+      l.reverse();
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.pHead == nullptr);
+      assertUnit(l.pTail == nullptr);
+   }  // teardown
+
+   // rhs is taken whole and left empty
+   void test_splice_middle()
+   {  // setup
+      custom::split_list<int> l;
+      custom::split_list<int> rhs;
+      l.push_back(26);
+      l.push_back(67);
+      rhs.push_back(49);
+      // exercise
+      l.splice(l.rbegin(), rhs);
+      // verify
+      assertStandardFixture(l);
+      assertUnit(rhs.empty());
+      assertUnit(rhs.pHead == nullptr);
+      l.splice(l.end(), rhs);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // from either end, and end() past it
+   void test_iteratorAt_standard()
+   {  // setup
+      custom::split_list<int> l;
+      for (int i = 0; i < 101; i++)
+         l.push_back(i);
+      // exercise
+      bool allSame = true;
+      for (size_t i = 0; i < l.size(); i++)
+         allSame = allSame && *l.iterator_at(i) == (int)i;
+      // verify
+      assertUnit(allSame);
+      assertUnit(l.iterator_at(101) == l.end());
+      assertUnit(l.recount() == 101);
+   }  // teardown
+
+   /***************************************
+    * FRONT
+    ***************************************/
+
+   // an empty list has no front
+   void test_front_empty()
+   {  // setup
+      custom::split_list<int> l;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.front();
+      }
+      catch (const char * error)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   /****************************************************************
+    * Setup Standard Fixture
+    *       +----+   +----+   +----+
+    *       | 26 | - | 49 | - | 67 |
+    *       +----+   +----+   +----+
+    ****************************************************************/
+   void setupStandardFixture(custom::split_list<int>& l)
+   {
+      l.push_back(26);
+      l.push_back(49);
+      l.push_back(67);
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *       +----+   +----+   +----+
+    *       | 26 | - | 49 | - | 67 |
+    *       +----+   +----+   +----+
+    * Linked both ways, every node with an item of its own
+    ****************************************************************/
+   void assertStandardFixtureParameters(custom::split_list<int>& l, int line, const char* function)
+   {
+      typedef custom::split_list<int>::Node Node;
+      assertIndirect(l.size() == 3);
+      assertIndirect(l.recount() == 3);
+
+      std::vector<int> items;
+      Node * pPrev = nullptr;
+      bool linked = true;
+      for (Node * p = l.pHead; p; pPrev = p, p = p->pNext)
+      {
+         linked = linked && p->pPrev == pPrev && p->pData != nullptr;
+         if (p->pData)
+            items.push_back(*p->pData);
+      }
+      assertIndirect(linked);
+      assertIndirect(pPrev == l.pTail);
+      assertIndirect(items.size() == 3);
+      if (items.size() == 3)
+      {
+         assertIndirect(items[0] == 26);
+         assertIndirect(items[1] == 49);
+         assertIndirect(items[2] == 67);
+      }
+      assertIndirect(l.front() == 26);
+      assertIndirect(l.back() == 67);
+   }
+};
+
+#endif // DEBUG